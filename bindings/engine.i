@@ -288,6 +288,7 @@ SplitList * qof_query_run_subquery (QofQuery *q, const QofQuery *q);
 %ignore qof_query_run;
 %ignore qof_query_last_run;
 %ignore qof_query_run_subquery;
+%ignore qof_query_update_results;
 %include <qofquery.h>
 %include <qofquerycore.h>
 %include <qofbookslots.h>
@@ -300,6 +301,8 @@ SplitList * qof_query_run_subquery (QofQuery *q, const QofQuery *q);
 %ignore GNC_ERROR_OVERFLOW;
 %ignore GNC_ERROR_DENOM_DIFF;
 %ignore GNC_ERROR_REMAINDER;
+%ignore gnc_numeric_sum;
+%ignore gnc_numeric_to_common_denom;
 %include <gnc-numeric.h>
 
 time64 time64CanonicalDayTime(time64 t);
@@ -115,6 +115,8 @@
 
 //Ignored because it is unimplemented
 %ignore gnc_numeric_convert_with_error;
+%ignore gnc_numeric_sum;
+%ignore gnc_numeric_to_common_denom;
 %include <gnc-numeric.h>
 
 %include <gnc-commodity.h>
@@ -253,29 +253,33 @@ add_event_type (ComponentEventInfo *cei, QofIdTypeConst entity_type,
 }
 
 static void
-gnc_cm_event_handler (QofInstance *entity,
-                      QofEventId event_type,
-                      gpointer user_data,
-                      gpointer event_data)
+gnc_cm_event_handler (const QofEventChange *event_changes,
+                      guint n_changes,
+                      gpointer user_data)
 {
-    const GncGUID *guid = qof_entity_get_guid(entity);
+    for (guint i = 0; i < n_changes; i++)
+    {
+        QofInstance *entity = event_changes[i].entity;
+        QofEventId event_type = event_changes[i].event_type;
+        const GncGUID *guid = qof_entity_get_guid(entity);
 #if CM_DEBUG
-    gchar guidstr[GUID_ENCODING_LENGTH+1];
-    guid_to_string_buff (guid, guidstr);
-    fprintf (stderr, "event_handler: event %d, entity %p, guid %s\n", event_type,
-             entity, guidstr);
+        gchar guidstr[GUID_ENCODING_LENGTH+1];
+        guid_to_string_buff (guid, guidstr);
+        fprintf (stderr, "event_handler: event %d, entity %p, guid %s\n", event_type,
+                 entity, guidstr);
 #endif
-    add_event (&changes, guid, event_type, TRUE);
+        add_event (&changes, guid, event_type, TRUE);
 
-    if (QOF_CHECK_TYPE(entity, GNC_ID_SPLIT))
-    {
-        /* split events are never generated by the engine, but might
-         * be generated by a backend (viz. the postgres backend.)
-         * Handle them like a transaction modify event. */
-        add_event_type (&changes, GNC_ID_TRANS, QOF_EVENT_MODIFY, TRUE);
+        if (QOF_CHECK_TYPE(entity, GNC_ID_SPLIT))
+        {
+            /* split events are never generated by the engine, but might
+             * be generated by a backend (viz. the postgres backend.)
+             * Handle them like a transaction modify event. */
+            add_event_type (&changes, GNC_ID_TRANS, QOF_EVENT_MODIFY, TRUE);
+        }
+        else
+            add_event_type (&changes, entity->e_type, event_type, TRUE);
     }
-    else
-        add_event_type (&changes, entity->e_type, event_type, TRUE);
 
     got_events = TRUE;
 
@@ -300,7 +304,7 @@ gnc_component_manager_init (void)
     changes_backup.event_masks = g_hash_table_new (g_str_hash, g_str_equal);
     changes_backup.entity_events = guid_hash_table_new ();
 
-    handler_id = qof_event_register_handler (gnc_cm_event_handler, NULL);
+    handler_id = qof_event_register_batch_handler (gnc_cm_event_handler, NULL);
 }
 
 void
@@ -579,6 +583,9 @@ gnc_suspend_gui_refresh (void)
     {
         PERR ("suspend counter overflow");
     }
+
+    /* Let the engine coalesce the events until the refresh resumes. */
+    qof_event_begin_batch ();
 }
 
 void
@@ -592,6 +599,8 @@ gnc_resume_gui_refresh (void)
 
     suspend_counter--;
 
+    qof_event_end_batch ();
+
     if (suspend_counter == 0)
         gnc_gui_refresh_internal (FALSE);
 }
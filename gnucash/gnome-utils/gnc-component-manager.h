@@ -231,6 +231,8 @@ void gnc_unregister_gui_component_by_data (const char *component_class,
  *   Suspend refresh handlers by the component manager.
  *   This routine may be called multiple times. Each call
  *   increases the suspend counter (starts at zero).
+ *   It also opens an engine event batch, so batch event
+ *   handlers see the changes once when the refresh resumes.
  */
 void gnc_suspend_gui_refresh (void);
 
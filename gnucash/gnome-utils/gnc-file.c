@@ -545,6 +545,15 @@ show_session_error (GtkWindow *parent,
         uh_oh = FALSE;
         break;
 
+    case ERR_FILEIO_JOURNAL_REJECTED:
+        fmt = _("The changes last saved to %s could not be applied because "
+                "they don't match the file, which was opened without them. "
+                "They have been kept in a file ending in .journal.rejected "
+                "next to it.");
+        gnc_warning_dialog (parent, fmt, displayname);
+        uh_oh = FALSE;
+        break;
+
     default:
         PERR("FIXME: Unhandled error %d", io_error);
         fmt = _("An unknown I/O error (%d) occurred.");
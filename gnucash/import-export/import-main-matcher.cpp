@@ -177,6 +177,7 @@ update_all_balances (GNCImportMainMatcher *info)
     for (GSList* iter = info->edited_accounts; iter; iter=iter->next)
     {
         auto acct = static_cast<Account*>(iter->data);
+        gnc_account_set_defer_sort (acct, false);
         gnc_account_set_defer_bal_computation (acct, false);
         xaccAccountRecomputeBalance (acct);
     }
@@ -508,6 +509,10 @@ gnc_gen_trans_list_show_all (GNCImportMainMatcher *info)
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON (info->append_text),
                                  xaccAccountGetAppendText(account));
 
+    // All of the transactions are in, so their accounts can be sorted now.
+    for (GSList* iter = info->edited_accounts; iter; iter=iter->next)
+        gnc_account_set_defer_sort (static_cast<Account*>(iter->data), false);
+
     gnc_gen_trans_list_create_matches (info);
     load_hash_tables (info);
     resolve_conflicts (info);
@@ -2242,6 +2247,8 @@ gnc_gen_trans_list_add_trans_internal (GNCImportMainMatcher *gui, Transaction *t
     Split *split = xaccTransGetSplit (trans, 0);
     Account *acc = xaccSplitGetAccount (split);
     defer_bal_computation (gui, acc);
+    /* Sort once all of the transactions are in, see gnc_gen_trans_list_show_all. */
+    gnc_account_set_defer_sort (acc, true);
 
     if (gnc_import_exists_online_id (trans, gui->acct_id_hash))
     {
@@ -80,8 +80,21 @@ struct gnc_ledger_display
     gint number_of_subaccounts;
 
     gint component_id;
+
+    /* The splits that engine events reported changed since the queries
+     * last ran, so that a refresh can update their results instead of
+     * running them again. */
+    gint event_handler_id;
+    GHashTable *changed_splits;
+    gboolean changes_unknown;
+    guint dropped_events;
+    gboolean pre_filter_current;
 };
 
+/* Past this many changed splits, running the queries again is cheaper than
+ * updating their results one split at a time. */
+#define MAX_INCREMENTAL_CHANGES 1000
+
 
 /** GLOBALS *********************************************************/
 static QofLogModule log_module = GNC_MOD_LEDGER;
@@ -581,6 +594,40 @@ gnc_ledger_display_set_watches (GNCLedgerDisplay* ld, GList* splits)
     }
 }
 
+static void
+ledger_event_handler (QofInstance* entity, QofEventId event_type,
+                      gpointer user_data, gpointer event_data)
+{
+    GNCLedgerDisplay* ld = user_data;
+
+    if (ld->changes_unknown)
+        return;
+
+    if (GNC_IS_SPLIT (entity) || GNC_IS_TRANSACTION (entity))
+    {
+        /* The results can't be searched for a split once it's freed. */
+        if (event_type & QOF_EVENT_DESTROY)
+            ld->changes_unknown = TRUE;
+        else if (GNC_IS_SPLIT (entity))
+            g_hash_table_add (ld->changed_splits, entity);
+        else
+            for (GList* node = xaccTransGetSplitList (GNC_TRANSACTION (entity));
+                 node; node = node->next)
+                g_hash_table_add (ld->changed_splits, node->data);
+    }
+    else if (GNC_IS_ACCOUNT (entity) && (event_type & GNC_EVENT_ITEM_CHANGED) &&
+             GNC_IS_SPLIT (event_data))
+    {
+        /* A split was added to or removed from the account. */
+        g_hash_table_add (ld->changed_splits, event_data);
+    }
+
+    if (g_hash_table_size (ld->changed_splits) > MAX_INCREMENTAL_CHANGES)
+        ld->changes_unknown = TRUE;
+    if (ld->changes_unknown)
+        g_hash_table_remove_all (ld->changed_splits);
+}
+
 static void
 refresh_handler (GHashTable* changes, gpointer user_data)
 {
@@ -643,6 +690,9 @@ close_handler (gpointer user_data)
     gnc_unregister_gui_component (ld->component_id);
     ld->component_id = NO_COMPONENT;
 
+    qof_event_unregister_handler (ld->event_handler_id);
+    g_hash_table_destroy (ld->changed_splits);
+
     if (ld->destroy)
         ld->destroy (ld);
 
@@ -844,6 +894,12 @@ gnc_ledger_display_internal (Account* lead_account, Query* q,
                                                    refresh_handler,
                                                    close_handler, ld);
 
+    ld->changed_splits = g_hash_table_new (g_direct_hash, g_direct_equal);
+    ld->changes_unknown = TRUE;
+    ld->dropped_events = qof_event_get_dropped_count ();
+    ld->pre_filter_current = FALSE;
+    ld->event_handler_id = qof_event_register_handler (ledger_event_handler, ld);
+
     /******************************************************************\
      * The main register window itself                                *
     \******************************************************************/
@@ -890,24 +946,61 @@ gnc_ledger_display_find_by_query (Query* q)
  * refresh only the indicated register window                       *
 \********************************************************************/
 
+/* Update the results of q for the changed splits if incremental is set
+ * and that's possible, or else run it again. */
+static GList*
+update_query_results (Query* q, GList* changed, gboolean incremental)
+{
+    if (incremental && xaccQueryIsSplitLocal (q) &&
+        qof_query_update_results (q, changed))
+        return qof_query_last_run (q);
+
+    return qof_query_run (q);
+}
+
 static void
 gnc_ledger_display_refresh_internal (GNCLedgerDisplay* ld)
 {
     GList* splits;
     GList* pre_filter_splits = NULL;
+    GList* changed;
+    gboolean incremental;
 
     if (ld->loading)
         return;
 
-    /* It's not clear if we should re-run the query, or if we should
-     * just use qof_query_last_run().  It's possible that the dates
-     * changed, requiring a full new query.  Similar considerations
-     * needed for multi-user mode.
+    /* If the queries haven't changed and events reported every split
+     * that changed since they last ran, just update their results.
+     * Otherwise, or if the dates changed, say, run them again.
      */
-    splits = qof_query_run (ld->query);
+    if (ld->changes_unknown ||
+        ld->dropped_events != qof_event_get_dropped_count ())
+    {
+        changed = NULL;
+        incremental = FALSE;
+    }
+    else
+    {
+        changed = g_hash_table_get_keys (ld->changed_splits);
+        incremental = TRUE;
+    }
+
+    splits = update_query_results (ld->query, changed, incremental);
 
     if (!qof_query_equal (ld->query, ld->pre_filter_query))
-        pre_filter_splits = qof_query_run (ld->pre_filter_query);
+    {
+        pre_filter_splits = update_query_results (ld->pre_filter_query, changed,
+                                                  incremental &&
+                                                  ld->pre_filter_current);
+        ld->pre_filter_current = TRUE;
+    }
+    else
+        ld->pre_filter_current = FALSE;
+
+    g_list_free (changed);
+    g_hash_table_remove_all (ld->changed_splits);
+    ld->changes_unknown = FALSE;
+    ld->dropped_events = qof_event_get_dropped_count ();
 
     gnc_ledger_display_set_watches (ld, splits);
 
@@ -986,8 +1079,12 @@ gnc_ledger_display_refresh (GNCLedgerDisplay* ld)
     {
         exclude_template_accounts (ld->query, ld->excluded_template_acc_hash);
 
-        qof_query_destroy (ld->pre_filter_query);
-        ld->pre_filter_query = qof_query_copy (ld->query);
+        /* Keep the pre-filter query, and its results, if it's the same */
+        if (!qof_query_equal (ld->query, ld->pre_filter_query))
+        {
+            qof_query_destroy (ld->pre_filter_query);
+            ld->pre_filter_query = qof_query_copy (ld->query);
+        }
     }
     gnc_ledger_display_refresh_internal (ld);
     LEAVE (" ");
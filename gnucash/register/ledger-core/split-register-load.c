@@ -139,7 +139,10 @@ gnc_split_register_load_desc_cells (SplitRegister* reg)
  *
  *  Each of these cells will remember the GncGUID of the ::Split to which it
  *  is associated. The leading virtual cell will be assigned the GncGUID of
- *  the "anchoring split" specified by @a split.
+ *  the "anchoring split" specified by @a split. If @a defer_splits is set,
+ *  the cells that follow are left for the model's loader to fill in from the
+ *  leading cell once they are looked at, so that a long register doesn't
+ *  keep a GncGUID for every split row it never shows.
  *
  *  Optionally an extra, empty virtual cell will be assigned to no split.
  *  This should not be confused with the "blank split", because this cell is
@@ -179,6 +182,9 @@ gnc_split_register_load_desc_cells (SplitRegister* reg)
  *  @param add_empty @c TRUE if an empty row should be added, @c FALSE
  *  otherwise
  *
+ *  @param defer_splits @c TRUE to defer the data of the rows after the
+ *  leading one, @c FALSE to set it now
+ *
  *  @param find_trans the transaction parameter for row searching
  *
  *  @param find_split the split parameter for row searching
@@ -199,6 +205,7 @@ gnc_split_register_add_transaction (SplitRegister* reg,
                                     gboolean visible_splits,
                                     gboolean start_primary_color,
                                     gboolean add_empty,
+                                    gboolean defer_splits,
                                     Transaction* find_trans,
                                     Split* find_split,
                                     CursorClass find_class,
@@ -228,9 +235,13 @@ gnc_split_register_add_transaction (SplitRegister* reg,
         if (secondary == find_split && find_class == CURSOR_CLASS_SPLIT)
             *new_split_row = vcell_loc->virt_row;
 
-        gnc_table_set_vcell (reg->table, split_cursor,
-                             xaccSplitGetGUID (secondary),
-                             visible_splits, TRUE, *vcell_loc);
+        if (defer_splits)
+            gnc_table_set_vcell_deferred (reg->table, split_cursor,
+                                          visible_splits, TRUE, *vcell_loc);
+        else
+            gnc_table_set_vcell (reg->table, split_cursor,
+                                 xaccSplitGetGUID (secondary),
+                                 visible_splits, TRUE, *vcell_loc);
         vcell_loc->virt_row++;
     }
 
@@ -241,8 +252,13 @@ gnc_split_register_add_transaction (SplitRegister* reg,
             find_class == CURSOR_CLASS_SPLIT)
             *new_split_row = vcell_loc->virt_row;
 
-        gnc_table_set_vcell (reg->table, split_cursor, xaccSplitGetGUID (NULL),
-                             FALSE, TRUE, *vcell_loc);
+        if (defer_splits)
+            gnc_table_set_vcell_deferred (reg->table, split_cursor,
+                                          FALSE, TRUE, *vcell_loc);
+        else
+            gnc_table_set_vcell (reg->table, split_cursor,
+                                 xaccSplitGetGUID (NULL),
+                                 FALSE, TRUE, *vcell_loc);
         vcell_loc->virt_row++;
     }
 }
@@ -639,7 +655,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
                                             blank_trans, blank_split,
                                             lead_cursor, split_cursor,
                                             multi_line, start_primary_color,
-                                            info->blank_split_edited,
+                                            info->blank_split_edited, FALSE,
                                             find_trans, find_split,
                                             find_class, &new_split_row,
                                             &vcell_loc);
@@ -763,7 +779,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
                                                     blank_trans, blank_split,
                                                     lead_cursor, split_cursor,
                                                     multi_line, start_primary_color,
-                                                    info->blank_split_edited,
+                                                    info->blank_split_edited, FALSE,
                                                     find_trans, find_split,
                                                     find_class, &new_split_row,
                                                     &vcell_loc);
@@ -797,10 +813,14 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
         if (split == find_trans_split)
             new_trans_split_row = vcell_loc.virt_row;
 
+        /* The rows of the transactions being edited or sought keep their
+         * data, the rest load it as they come into view. */
         gnc_split_register_add_transaction (reg, trans, split,
                                             lead_cursor, split_cursor,
                                             multi_line, start_primary_color,
                                             TRUE,
+                                            trans != pending_trans &&
+                                            trans != find_trans,
                                             find_trans, find_split, find_class,
                                             &new_split_row, &vcell_loc);
 
@@ -858,7 +878,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
         gnc_split_register_add_transaction (reg, blank_trans, blank_split,
                                             lead_cursor, split_cursor,
                                             multi_line, start_primary_color,
-                                            info->blank_split_edited,
+                                            info->blank_split_edited, FALSE,
                                             find_trans, find_split,
                                             find_class, &new_split_row,
                                             &vcell_loc);
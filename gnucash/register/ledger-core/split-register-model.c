@@ -2457,6 +2457,35 @@ gnc_split_register_guid_copy (gpointer p_to, gconstpointer p_from)
     *to = from ? *from : *guid_null();
 }
 
+/* Rows below a transaction's leading row hold its splits in order, then
+ * the empty split row. */
+static void
+gnc_split_register_guid_load (gpointer p_to, gconstpointer p_anchor,
+                              int offset, gpointer user_data)
+{
+    GncGUID* to = p_to;
+    Split* anchor = xaccSplitLookup (p_anchor, gnc_get_current_book ());
+    Transaction* trans = xaccSplitGetParent (anchor);
+
+    *to = *guid_null();
+    if (!trans)
+        return;
+
+    for (GList* node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split* split = node->data;
+
+        if (!xaccTransStillHasSplit (trans, split))
+            continue;
+
+        if (--offset == 0)
+        {
+            *to = *xaccSplitGetGUID (split);
+            return;
+        }
+    }
+}
+
 
 static void
 gnc_split_register_colorize_negative (gpointer gsettings, gchar* key,
@@ -2875,6 +2904,7 @@ gnc_split_register_model_new (void)
     model->cell_data_allocator   = gnc_split_register_guid_malloc;
     model->cell_data_deallocator = gnc_split_register_guid_free;
     model->cell_data_copy        = gnc_split_register_guid_copy;
+    model->cell_data_loader      = gnc_split_register_guid_load;
 
     gnc_split_register_model_add_save_handlers (model);
 
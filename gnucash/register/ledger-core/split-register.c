@@ -363,7 +363,8 @@ gnc_split_register_get_split_virt_loc (SplitRegister* reg, Split* split,
             if (!vcell || !vcell->visible)
                 continue;
 
-            s = xaccSplitLookup (vcell->vcell_data, gnc_get_current_book ());
+            s = xaccSplitLookup (gnc_table_get_vcell_data (table, vc_loc),
+                                 gnc_get_current_book ());
 
             if (s == split)
             {
@@ -95,6 +95,9 @@ gnc_table_new (TableLayout *layout, TableModel *model, TableControl *control)
                                      gnc_virtual_cell_construct,
                                      gnc_virtual_cell_destroy, table);
 
+    table->loaded_cells = g_array_new (FALSE, FALSE,
+                                       sizeof (VirtualCellLocation));
+
     return table;
 }
 
@@ -111,6 +114,7 @@ gnc_table_init (Table * table)
     /* initialize private data */
 
     table->virt_cells = NULL;
+    table->loaded_cells = NULL;
     table->ui_data = NULL;
 }
 
@@ -126,6 +130,7 @@ gnc_table_destroy (Table * table)
 
     /* free the cell tables */
     g_table_destroy (table->virt_cells);
+    g_array_free (table->loaded_cells, TRUE);
 
     gnc_table_layout_destroy (table->layout);
     table->layout = NULL;
@@ -629,12 +634,16 @@ gnc_virtual_cell_construct (gpointer _vcell, gpointer user_data)
 
     vcell->cellblock = NULL;
 
-    if (table && table->model->cell_data_allocator)
+    /* With a loader, data is only allocated for cells that get some. */
+    if (table && table->model->cell_data_allocator &&
+        !table->model->cell_data_loader)
         vcell->vcell_data = table->model->cell_data_allocator ();
     else
         vcell->vcell_data = NULL;
 
     vcell->visible = 1;
+    vcell->deferred = 0;
+    vcell->loaded = 0;
 }
 
 static void
@@ -649,6 +658,32 @@ gnc_virtual_cell_destroy (gpointer _vcell, gpointer user_data)
     vcell->vcell_data = NULL;
 }
 
+static void
+gnc_virtual_cell_set_data (Table *table, VirtualCell *vcell,
+                           gconstpointer vcell_data)
+{
+    if (table->model->cell_data_copy)
+    {
+        if (!vcell->vcell_data && table->model->cell_data_allocator)
+            vcell->vcell_data = table->model->cell_data_allocator ();
+        table->model->cell_data_copy (vcell->vcell_data, vcell_data);
+    }
+    else
+        vcell->vcell_data = (gpointer) vcell_data;
+
+    vcell->loaded = 0;
+}
+
+static void
+gnc_virtual_cell_unload (Table *table, VirtualCell *vcell)
+{
+    if (vcell->vcell_data && table->model->cell_data_deallocator)
+        table->model->cell_data_deallocator (vcell->vcell_data);
+
+    vcell->vcell_data = NULL;
+    vcell->loaded = 0;
+}
+
 static void
 gnc_table_resize (Table * table, int new_virt_rows, int new_virt_cols)
 {
@@ -687,15 +722,143 @@ gnc_table_set_vcell (Table *table,
     vcell->cellblock = cursor;
 
     /* copy the vcell user data */
-    if (table->model->cell_data_copy)
-        table->model->cell_data_copy (vcell->vcell_data, vcell_data);
-    else
-        vcell->vcell_data = (gpointer) vcell_data;
+    gnc_virtual_cell_set_data (table, vcell, vcell_data);
+    vcell->deferred = 0;
+
+    vcell->visible = visible ? 1 : 0;
+    vcell->start_primary_color = start_primary_color ? 1 : 0;
+}
+
+void
+gnc_table_set_vcell_deferred (Table *table,
+                              CellBlock *cursor,
+                              gboolean visible,
+                              gboolean start_primary_color,
+                              VirtualCellLocation vcell_loc)
+{
+    VirtualCell *vcell;
+
+    if ((table == NULL) || (cursor == NULL))
+        return;
+
+    if (!table->model->cell_data_loader || !table->model->cell_data_allocator)
+    {
+        gnc_table_set_vcell (table, cursor, NULL, visible,
+                             start_primary_color, vcell_loc);
+        return;
+    }
+
+    if ((vcell_loc.virt_row >= table->num_virt_rows) ||
+            (vcell_loc.virt_col >= table->num_virt_cols))
+        gnc_table_resize (table,
+                          MAX (table->num_virt_rows, vcell_loc.virt_row + 1),
+                          MAX (table->num_virt_cols, vcell_loc.virt_col + 1));
+
+    vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+    if (vcell == NULL)
+        return;
+
+    vcell->cellblock = cursor;
+
+    /* Whatever was loaded may no longer be what the loader would give. */
+    gnc_virtual_cell_unload (table, vcell);
+    vcell->deferred = 1;
 
     vcell->visible = visible ? 1 : 0;
     vcell->start_primary_color = start_primary_color ? 1 : 0;
 }
 
+/* Returns the row of the nearest cell above vcell_loc that isn't deferred,
+ * or -1 if there is none. */
+static int
+gnc_table_find_anchor_row (Table *table, VirtualCellLocation vcell_loc)
+{
+    VirtualCell *vcell;
+
+    do
+    {
+        vcell_loc.virt_row--;
+        vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+    }
+    while (vcell && vcell->deferred);
+
+    return vcell ? vcell_loc.virt_row : -1;
+}
+
+static void
+gnc_table_load_vcell_data (Table *table, VirtualCell *vcell,
+                           VirtualCellLocation vcell_loc)
+{
+    VirtualCellLocation anchor_loc = vcell_loc;
+    gconstpointer anchor_data = NULL;
+
+    anchor_loc.virt_row = gnc_table_find_anchor_row (table, vcell_loc);
+    if (anchor_loc.virt_row >= 0)
+        anchor_data = gnc_table_get_virtual_cell (table, anchor_loc)->vcell_data;
+
+    vcell->vcell_data = table->model->cell_data_allocator ();
+    table->model->cell_data_loader (vcell->vcell_data, anchor_data,
+                                    vcell_loc.virt_row - anchor_loc.virt_row,
+                                    table->model->handler_user_data);
+    vcell->loaded = 1;
+
+    g_array_append_val (table->loaded_cells, vcell_loc);
+}
+
+void
+gnc_table_set_data_window (Table *table, int first_row, int last_row)
+{
+    VirtualCellLocation cursor_loc;
+    int margin;
+    int cursor_anchor = -1;
+    guint kept = 0;
+    guint i;
+
+    if (table == NULL)
+        return;
+
+    margin = MAX (last_row - first_row, 0) + 1;
+    first_row -= margin;
+    last_row += margin;
+
+    /* The cursor's rows stay loaded even when scrolled away, so that
+     * they don't change under an edit in progress. */
+    cursor_loc = table->current_cursor_loc.vcell_loc;
+    if (!gnc_table_virtual_cell_out_of_bounds (table, cursor_loc))
+    {
+        VirtualCell *vcell = gnc_table_get_virtual_cell (table, cursor_loc);
+
+        cursor_anchor = vcell->deferred ?
+                        gnc_table_find_anchor_row (table, cursor_loc) :
+                        cursor_loc.virt_row;
+    }
+
+    for (i = 0; i < table->loaded_cells->len; i++)
+    {
+        VirtualCellLocation vcell_loc =
+            g_array_index (table->loaded_cells, VirtualCellLocation, i);
+        VirtualCell *vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+
+        /* Cells that were since resized away, given data or unloaded. */
+        if (!vcell || !vcell->loaded)
+            continue;
+
+        if ((vcell_loc.virt_row < first_row ||
+             vcell_loc.virt_row > last_row) &&
+            (cursor_anchor < 0 ||
+             gnc_table_find_anchor_row (table, vcell_loc) != cursor_anchor))
+        {
+            gnc_virtual_cell_unload (table, vcell);
+            continue;
+        }
+
+        g_array_index (table->loaded_cells, VirtualCellLocation, kept++) =
+            vcell_loc;
+    }
+
+    g_array_set_size (table->loaded_cells, kept);
+}
+
 void
 gnc_table_set_virt_cell_data (Table *table,
                               VirtualCellLocation vcell_loc,
@@ -710,10 +873,7 @@ gnc_table_set_virt_cell_data (Table *table,
     if (vcell == NULL)
         return;
 
-    if (table->model->cell_data_copy)
-        table->model->cell_data_copy (vcell->vcell_data, vcell_data);
-    else
-        vcell->vcell_data = (gpointer) vcell_data;
+    gnc_virtual_cell_set_data (table, vcell, vcell_data);
 }
 
 void
@@ -939,6 +1099,9 @@ gnc_table_get_vcell_data (Table *table, VirtualCellLocation vcell_loc)
     if (vcell == NULL)
         return NULL;
 
+    if (vcell->deferred && !vcell->vcell_data)
+        gnc_table_load_vcell_data (table, vcell, vcell_loc);
+
     return vcell->vcell_data;
 }
 
@@ -137,6 +137,8 @@ typedef struct
     /* flags */
     unsigned int visible : 1;             /** visible in the GUI */
     unsigned int start_primary_color : 1; /** color usage flag */
+    unsigned int deferred : 1;            /** data comes from the loader */
+    unsigned int loaded : 1;              /** data came from the loader */
 } VirtualCell;
 
 typedef struct table Table;
@@ -174,6 +176,9 @@ struct table
     /* The virtual cell table */
     GTable *virt_cells;
 
+    /* Deferred cells whose data has been loaded */
+    GArray *loaded_cells;
+
     TableGUIHandlers gui_handlers;
     gpointer ui_data;
 };
@@ -284,6 +289,22 @@ void        gnc_table_set_vcell (Table *table, CellBlock *cursor,
                                  gboolean start_primary_color,
                                  VirtualCellLocation vcell_loc);
 
+/** Like gnc_table_set_vcell, but leave the data to the model's
+ *  cell_data_loader, which derives it from the nearest virtual cell above
+ *  that isn't deferred once something asks for it. Tables whose model has
+ *  no loader get the cell set without data. */
+void        gnc_table_set_vcell_deferred (Table *table, CellBlock *cursor,
+                                          gboolean visible,
+                                          gboolean start_primary_color,
+                                          VirtualCellLocation vcell_loc);
+
+/** Free the data loaded into deferred virtual cells outside the rows from
+ *  first_row to last_row, give or take as many rows again on each side,
+ *  unless they share the current cursor's anchor. The GUI calls this with
+ *  the rows it shows. */
+void        gnc_table_set_data_window (Table *table, int first_row,
+                                       int last_row);
+
 /** Set the virtual cell data for a particular location. */
 void        gnc_table_set_virt_cell_data (Table *table,
         VirtualCellLocation vcell_loc,
@@ -317,7 +338,8 @@ gboolean    gnc_table_verify_cursor_position (Table *table,
         VirtualLocation virt_loc);
 
 /** returns the virtual cell data associated with a cursor located at the given
- * virtual coords, or NULL if the coords are out of bounds. */
+ * virtual coords, or NULL if the coords are out of bounds. The data of a
+ * deferred cell is loaded first if it isn't yet. */
 gpointer    gnc_table_get_vcell_data (Table *table,
                                       VirtualCellLocation vcell_loc);
 
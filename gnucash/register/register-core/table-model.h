@@ -100,6 +100,12 @@ typedef void (*TableSaveHandler) (gpointer save_data,
 typedef gpointer (*VirtCellDataAllocator)   (void);
 typedef void     (*VirtCellDataDeallocator) (gpointer cell_data);
 typedef void     (*VirtCellDataCopy)        (gpointer to, gconstpointer from);
+/* Fill in the data of a deferred virtual cell that is offset rows below
+ * anchor_data's cell, the nearest one above it that was set with data. */
+typedef void     (*VirtCellDataLoader)      (gpointer cell_data,
+                                             gconstpointer anchor_data,
+                                             int offset,
+                                             gpointer user_data);
 
 typedef struct
 {
@@ -142,6 +148,10 @@ typedef struct
     VirtCellDataAllocator cell_data_allocator;
     VirtCellDataDeallocator cell_data_deallocator;
     VirtCellDataCopy cell_data_copy;
+    /* If set, cells are allocated their data only once they are given
+     * some, and cells set with gnc_table_set_vcell_deferred get theirs
+     * from this when it is first asked for. */
+    VirtCellDataLoader cell_data_loader;
 } TableModel;
 
 
@@ -0,0 +1,243 @@
+/********************************************************************
+ * test-table-allgui.c: Tests for the register table's cell data.   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ \********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+
+#include "table-allgui.h"
+
+/* Each "transaction" is a leading row holding its number, followed by
+ * SPLIT_ROWS deferred rows that load number * 100 + offset. */
+#define NUM_TRANS 100
+#define SPLIT_ROWS 2
+#define TRANS_ROWS (1 + SPLIT_ROWS)
+
+typedef struct
+{
+    Table *table;
+    CellBlock *cursor;
+    int loads;
+} Fixture;
+
+static int live_data = 0;
+
+static gpointer
+data_malloc (void)
+{
+    live_data++;
+    return g_new0 (int, 1);
+}
+
+static void
+data_free (gpointer data)
+{
+    live_data--;
+    g_free (data);
+}
+
+static void
+data_copy (gpointer to, gconstpointer from)
+{
+    *(int*)to = from ? *(const int*)from : 0;
+}
+
+static void
+data_load (gpointer data, gconstpointer anchor_data, int offset,
+           gpointer user_data)
+{
+    Fixture *fixture = user_data;
+
+    fixture->loads++;
+    *(int*)data = (anchor_data ? *(const int*)anchor_data : 0) * 100 + offset;
+}
+
+static int
+lead_row (int trans)
+{
+    return 1 + (trans - 1) * TRANS_ROWS;
+}
+
+static int
+row_data (Fixture *fixture, int row)
+{
+    VirtualCellLocation vcell_loc = { row, 0 };
+    int *data = gnc_table_get_vcell_data (fixture->table, vcell_loc);
+
+    g_assert_nonnull (data);
+    return *data;
+}
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    TableModel *model = gnc_table_model_new ();
+    VirtualCellLocation vcell_loc = { 0, 0 };
+    int trans, i;
+
+    model->cell_data_allocator = data_malloc;
+    model->cell_data_deallocator = data_free;
+    model->cell_data_copy = data_copy;
+    if (!pData)
+        model->cell_data_loader = data_load;
+    model->handler_user_data = fixture;
+
+    fixture->table = gnc_table_new (gnc_table_layout_new (), model,
+                                    gnc_table_control_new ());
+    fixture->cursor = gnc_cellblock_new (1, 1, "cursor");
+    fixture->loads = 0;
+
+    gnc_table_set_vcell (fixture->table, fixture->cursor, NULL, TRUE, TRUE,
+                         vcell_loc);
+    for (trans = 1; trans <= NUM_TRANS; trans++)
+    {
+        vcell_loc.virt_row = lead_row (trans);
+        gnc_table_set_vcell (fixture->table, fixture->cursor, &trans,
+                             TRUE, TRUE, vcell_loc);
+        for (i = 1; i <= SPLIT_ROWS; i++)
+        {
+            vcell_loc.virt_row++;
+            gnc_table_set_vcell_deferred (fixture->table, fixture->cursor,
+                                          FALSE, TRUE, vcell_loc);
+        }
+    }
+    gnc_table_set_size (fixture->table, 1 + NUM_TRANS * TRANS_ROWS, 1);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    gnc_table_destroy (fixture->table);
+    gnc_cellblock_destroy (fixture->cursor);
+    g_assert_cmpint (live_data, ==, 0);
+}
+
+static void
+test_deferred_cells_load_on_demand (Fixture *fixture, gconstpointer pData)
+{
+    /* Only the header and the leading rows have data. */
+    g_assert_cmpint (live_data, ==, 1 + NUM_TRANS);
+
+    g_assert_cmpint (row_data (fixture, lead_row (7)), ==, 7);
+    g_assert_cmpint (row_data (fixture, lead_row (7) + 1), ==, 701);
+    g_assert_cmpint (row_data (fixture, lead_row (7) + 2), ==, 702);
+    g_assert_cmpint (fixture->loads, ==, 2);
+
+    /* Loaded once, then kept. */
+    g_assert_cmpint (row_data (fixture, lead_row (7) + 2), ==, 702);
+    g_assert_cmpint (fixture->loads, ==, 2);
+    g_assert_cmpint (live_data, ==, 1 + NUM_TRANS + 2);
+}
+
+static void
+test_data_window_unloads_outside (Fixture *fixture, gconstpointer pData)
+{
+    int trans;
+
+    for (trans = 1; trans <= NUM_TRANS; trans++)
+        row_data (fixture, lead_row (trans) + 1);
+    g_assert_cmpint (live_data, ==, 1 + 2 * NUM_TRANS);
+
+    /* Rows 100 to 109 are shown, so rows 90 to 119 stay loaded. */
+    gnc_table_set_data_window (fixture->table, 100, 109);
+    for (trans = 1; trans <= NUM_TRANS; trans++)
+    {
+        VirtualCellLocation vcell_loc = { lead_row (trans) + 1, 0 };
+        VirtualCell *vcell = gnc_table_get_virtual_cell (fixture->table,
+                                                         vcell_loc);
+        gboolean inside = vcell_loc.virt_row >= 90 && vcell_loc.virt_row <= 119;
+
+        g_assert_true (vcell->deferred);
+        g_assert_true ((vcell->vcell_data != NULL) == inside);
+    }
+    g_assert_cmpint (live_data, ==, 1 + NUM_TRANS + 10);
+
+    /* Unloaded rows load the same data again. */
+    g_assert_cmpint (row_data (fixture, lead_row (NUM_TRANS) + 1), ==,
+                     NUM_TRANS * 100 + 1);
+}
+
+static void
+test_data_window_keeps_cursor (Fixture *fixture, gconstpointer pData)
+{
+    VirtualCellLocation vcell_loc = { lead_row (3) + 2, 0 };
+
+    row_data (fixture, lead_row (3) + 1);
+    row_data (fixture, lead_row (3) + 2);
+    row_data (fixture, lead_row (4) + 1);
+    fixture->table->current_cursor_loc.vcell_loc = vcell_loc;
+
+    gnc_table_set_data_window (fixture->table, 200, 209);
+    g_assert_cmpint (live_data, ==, 1 + NUM_TRANS + 2);
+    g_assert_cmpint (row_data (fixture, lead_row (3) + 1), ==, 301);
+    g_assert_cmpint (fixture->loads, ==, 3);
+}
+
+static void
+test_set_data_on_deferred_cell (Fixture *fixture, gconstpointer pData)
+{
+    VirtualCellLocation vcell_loc = { lead_row (5) + 2, 0 };
+    int data = 42;
+
+    gnc_table_set_virt_cell_data (fixture->table, vcell_loc, &data);
+    g_assert_cmpint (row_data (fixture, vcell_loc.virt_row), ==, 42);
+
+    /* Given data is neither unloaded nor used as an anchor. */
+    gnc_table_set_data_window (fixture->table, 200, 209);
+    g_assert_cmpint (row_data (fixture, vcell_loc.virt_row), ==, 42);
+    g_assert_cmpint (row_data (fixture, lead_row (5) + 1), ==, 501);
+    g_assert_cmpint (fixture->loads, ==, 1);
+}
+
+static void
+test_deferred_without_loader (Fixture *fixture, gconstpointer pData)
+{
+    VirtualCellLocation vcell_loc = { lead_row (2) + 1, 0 };
+    VirtualCell *vcell = gnc_table_get_virtual_cell (fixture->table,
+                                                     vcell_loc);
+
+    g_assert_false (vcell->deferred);
+    g_assert_cmpint (row_data (fixture, vcell_loc.virt_row), ==, 0);
+    g_assert_cmpint (live_data, ==, 1 + NUM_TRANS * TRANS_ROWS);
+}
+
+int
+main (int argc, char *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/register/core/table/deferred cells load on demand",
+                Fixture, NULL, setup, test_deferred_cells_load_on_demand,
+                teardown);
+    g_test_add ("/register/core/table/data window unloads outside",
+                Fixture, NULL, setup, test_data_window_unloads_outside,
+                teardown);
+    g_test_add ("/register/core/table/data window keeps cursor",
+                Fixture, NULL, setup, test_data_window_keeps_cursor,
+                teardown);
+    g_test_add ("/register/core/table/set data on deferred cell",
+                Fixture, NULL, setup, test_set_data_on_deferred_cell,
+                teardown);
+    g_test_add ("/register/core/table/deferred without loader",
+                Fixture, GINT_TO_POINTER (1), setup,
+                test_deferred_without_loader, teardown);
+
+    return g_test_run ();
+}
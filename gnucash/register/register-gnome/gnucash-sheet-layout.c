@@ -0,0 +1,106 @@
+/********************************************************************\
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gnucash-sheet-layout.h"
+
+
+gint
+gnc_sheet_layout_row_at_y (gint num_rows, gint y,
+                           SheetLayoutBlockFunc get_block,
+                           gpointer user_data)
+{
+    gint low = 1;
+    gint high = num_rows;
+
+    g_return_val_if_fail (get_block != NULL, num_rows);
+
+    while (low < high)
+    {
+        gint row = low + (high - low) / 2;
+        SheetLayoutBlock block;
+
+        if (!get_block (user_data, row, 0, &block))
+        {
+            low = row + 1;
+            continue;
+        }
+
+        if (*block.origin_y + block.height > y)
+            high = row;
+        else
+            low = row + 1;
+    }
+    return low;
+}
+
+gboolean
+gnc_sheet_layout_update (gint num_rows, gint num_cols, gint start_row,
+                         gboolean stop_when_unchanged,
+                         SheetLayoutBlockFunc get_block,
+                         gpointer user_data, gint *height)
+{
+    SheetLayoutBlock block;
+    gint y = 0;
+    gint i = 0;
+
+    g_return_val_if_fail (get_block != NULL, FALSE);
+
+    /* The rows above start_row keep their offsets. */
+    if (start_row > 0 && start_row < num_rows &&
+        get_block (user_data, start_row, 0, &block))
+    {
+        y = *block.origin_y;
+        i = start_row;
+    }
+
+    for (; i < num_rows; i++)
+    {
+        gboolean have_block = FALSE;
+        gint x = 0;
+        gint j;
+
+        for (j = 0; j < num_cols; j++)
+        {
+            if (!get_block (user_data, i, j, &block))
+                continue;
+
+            /* Past the changed row, a block already at its offset means
+             * all the ones after it are too. */
+            if (stop_when_unchanged && i > start_row && j == 0 &&
+                *block.origin_x == x && *block.origin_y == y)
+                return FALSE;
+
+            *block.origin_x = x;
+            *block.origin_y = y;
+            x += block.width;
+            have_block = TRUE;
+        }
+
+        if (i > 0 && have_block)
+            y += block.height;
+    }
+
+    if (height)
+        *height = y;
+    return TRUE;
+}
@@ -0,0 +1,75 @@
+/********************************************************************\
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#ifndef GNUCASH_SHEET_LAYOUT_H
+#define GNUCASH_SHEET_LAYOUT_H
+
+#include <glib.h>
+
+/** @ingroup Register
+ * @addtogroup Gnome
+ * @{
+ */
+/** @file gnucash-sheet-layout.h
+ * @brief Vertical placement of the blocks of a register sheet.
+ *
+ * These functions know nothing about widgets or styles. They see a
+ * block only through a SheetLayoutBlock, which the sheet fills in from
+ * its own block table.
+ */
+
+/** The placement of one block, as seen by the layout functions. */
+typedef struct
+{
+    gint *origin_x; /** where to read and store the x origin */
+    gint *origin_y; /** where to read and store the y origin */
+    gint width;     /** width taken by the block, 0 if hidden */
+    gint height;    /** height taken by the block, 0 if hidden */
+} SheetLayoutBlock;
+
+/** Fill in @a block for the block at @a row, @a col and return TRUE, or
+ *  return FALSE if there is no block there. */
+typedef gboolean (*SheetLayoutBlockFunc) (gpointer user_data,
+                                          gint row, gint col,
+                                          SheetLayoutBlock *block);
+
+/** Return the first row from 1 up whose bottom edge is below @a y, or
+ *  @a num_rows if there is none. Row 0 is the header and is skipped.
+ *  The bottom edges never decrease down the sheet, so this bisects. */
+gint gnc_sheet_layout_row_at_y (gint num_rows, gint y,
+                                SheetLayoutBlockFunc get_block,
+                                gpointer user_data);
+
+/** Set the origins of the blocks from @a start_row down. The rows above
+ *  @a start_row keep theirs. If @a stop_when_unchanged is TRUE, stop at
+ *  the first row after @a start_row that is already in place, as every
+ *  row after it is too.
+ *
+ *  @return TRUE and set @a height to the height of the sheet if the
+ *  last row was reached, FALSE if the walk stopped early. In that case
+ *  the height is unchanged. */
+gboolean gnc_sheet_layout_update (gint num_rows, gint num_cols,
+                                  gint start_row,
+                                  gboolean stop_when_unchanged,
+                                  SheetLayoutBlockFunc get_block,
+                                  gpointer user_data, gint *height);
+
+/** @} */
+#endif
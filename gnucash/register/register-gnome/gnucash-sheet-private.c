@@ -63,27 +63,17 @@ find_block_by_pixel (GnucashSheet *sheet,
     g_return_val_if_fail (y >= 0, NULL);
     g_return_val_if_fail (x >= 0, NULL);
 
-    do
-    {
-        block = gnucash_sheet_get_block (sheet, vc_loc);
-        if (!block)
-            return NULL;
-
-        if (block->visible &&
-                y >= block->origin_y &&
-                y < block->origin_y + block->style->dimensions->height)
-        {
-            if (vcell_loc)
-                vcell_loc->virt_row = vc_loc.virt_row;
-            break;
-        }
-        vc_loc.virt_row++;
-    }
-    while (vc_loc.virt_row < sheet->num_virt_rows);
+    vc_loc.virt_row = gnucash_sheet_y_pixel_to_block (sheet, y);
+    if (vc_loc.virt_row >= sheet->num_virt_rows)
+        return NULL;
 
-    if (vc_loc.virt_row == sheet->num_virt_rows)
+    block = gnucash_sheet_get_block (sheet, vc_loc);
+    if (!block || !block->visible || y < block->origin_y)
         return NULL;
 
+    if (vcell_loc)
+        vcell_loc->virt_row = vc_loc.virt_row;
+
     do
     {
         block = gnucash_sheet_get_block (sheet, vc_loc);
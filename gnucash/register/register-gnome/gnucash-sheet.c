@@ -34,6 +34,7 @@
 
 #include "gnucash-sheet.h"
 #include "gnucash-sheetP.h"
+#include "gnucash-sheet-layout.h"
 
 #include "dialog-utils.h"
 #include "gnc-gtk-utils.h"
@@ -489,25 +490,40 @@ gnucash_sheet_cursor_move (GnucashSheet *sheet, VirtualLocation virt_loc)
 }
 
 
-static gint
-gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y)
+/* Shows a sheet block to the layout functions. */
+static gboolean
+gnucash_sheet_layout_block (gpointer user_data, gint row, gint col,
+                            SheetLayoutBlock *layout)
 {
-    VirtualCellLocation vcell_loc = { 1, 0 };
+    GnucashSheet *sheet = user_data;
+    VirtualCellLocation vcell_loc = { row, col };
+    SheetBlock *block;
 
-    for (;
-            vcell_loc.virt_row < sheet->num_virt_rows;
-            vcell_loc.virt_row++)
-    {
-        SheetBlock *block;
+    block = gnucash_sheet_get_block (sheet, vcell_loc);
+    if (!block)
+        return FALSE;
 
-        block = gnucash_sheet_get_block (sheet, vcell_loc);
-        if (!block || !block->visible)
-            continue;
+    layout->origin_x = &block->origin_x;
+    layout->origin_y = &block->origin_y;
+    layout->width = 0;
+    layout->height = 0;
 
-        if (block->origin_y + block->style->dimensions->height > y)
-            break;
+    if (block->visible)
+    {
+        layout->width = block->style->dimensions->width;
+        layout->height = block->style->dimensions->height;
     }
-    return vcell_loc.virt_row;
+    return TRUE;
+}
+
+
+/* Returns the first row below the header whose block reaches past
+ * pixel y, or num_virt_rows if there is none. */
+gint
+gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y)
+{
+    return gnc_sheet_layout_row_at_y (sheet->num_virt_rows, y,
+                                      gnucash_sheet_layout_block, sheet);
 }
 
 
@@ -552,6 +568,8 @@ gnucash_sheet_compute_visible_range (GnucashSheet *sheet)
                 >= height)
             break;
     }
+
+    gnc_table_set_data_window (sheet->table, top_block, vcell_loc.virt_row);
 }
 
 
@@ -2142,47 +2160,37 @@ gnucash_sheet_resize (GnucashSheet *sheet)
     sheet->num_virt_rows = sheet->table->num_virt_rows;
 }
 
+static void
+recompute_block_offsets (GnucashSheet *sheet, gint start_row,
+                         gboolean stop_when_unchanged)
+{
+    Table *table = sheet->table;
+
+    gnc_sheet_layout_update (table->num_virt_rows, table->num_virt_cols,
+                             start_row, stop_when_unchanged,
+                             gnucash_sheet_layout_block, sheet,
+                             &sheet->height);
+}
+
 void
 gnucash_sheet_recompute_block_offsets (GnucashSheet *sheet)
 {
-    Table *table;
-    SheetBlock *block;
-    gint i, j;
-    gint height;
-    gint width;
-
     g_return_if_fail (sheet != NULL);
     g_return_if_fail (GNUCASH_IS_SHEET(sheet));
     g_return_if_fail (sheet->table != NULL);
 
-    table = sheet->table;
-
-    height = 0;
-    block = NULL;
-    for (i = 0; i < table->num_virt_rows; i++)
-    {
-        width = 0;
-
-        for (j = 0; j < table->num_virt_cols; j++)
-        {
-            VirtualCellLocation vcell_loc = { i, j };
-
-            block = gnucash_sheet_get_block (sheet, vcell_loc);
-
-            if (!block)
-                continue;
-
-            block->origin_x = width;
-            block->origin_y = height;
+    recompute_block_offsets (sheet, 0, FALSE);
+}
 
-            if (block->visible)
-                width += block->style->dimensions->width;
-        }
+void
+gnucash_sheet_update_block_offsets (GnucashSheet *sheet,
+                                    VirtualCellLocation vcell_loc)
+{
+    g_return_if_fail (sheet != NULL);
+    g_return_if_fail (GNUCASH_IS_SHEET(sheet));
+    g_return_if_fail (sheet->table != NULL);
 
-        if (i > 0 && block && block->visible)
-            height += block->style->dimensions->height;
-    }
-    sheet->height = height;
+    recompute_block_offsets (sheet, vcell_loc.virt_row, TRUE);
 }
 
 void
@@ -67,6 +67,12 @@ void gnucash_sheet_table_load (GnucashSheet *sheet, gboolean do_scroll);
 
 void gnucash_sheet_recompute_block_offsets (GnucashSheet *sheet);
 
+/** Update the block offsets after the block at vcell_loc changed size or
+ *  visibility. Only the rows from vcell_loc down to the first block that
+ *  is already in place are visited. */
+void gnucash_sheet_update_block_offsets (GnucashSheet *sheet,
+                                         VirtualCellLocation vcell_loc);
+
 SheetBlock *gnucash_sheet_get_block (GnucashSheet *sheet,
                                      VirtualCellLocation vcell_loc);
 
@@ -202,7 +202,7 @@ gnc_table_refresh_cursor_gnome (Table * table,
 
     if (gnucash_sheet_block_set_from_table (sheet, vcell_loc))
     {
-        gnucash_sheet_recompute_block_offsets (sheet);
+        gnucash_sheet_update_block_offsets (sheet, vcell_loc);
         gnucash_sheet_set_scroll_region (sheet);
         gnucash_sheet_compute_visible_range (sheet);
         gnucash_sheet_redraw_all (sheet);
@@ -0,0 +1,228 @@
+/********************************************************************
+ * test-sheet-layout.c: Tests for the register sheet block layout.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ \********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gnucash-sheet-layout.h"
+
+#define NUM_ROWS 1000
+
+typedef struct
+{
+    gint origin_x;
+    gint origin_y;
+    gint height;
+    gboolean visible;
+} TestBlock;
+
+typedef struct
+{
+    TestBlock blocks[NUM_ROWS];
+    gint num_rows;
+    gint visits;
+} Fixture;
+
+static gboolean
+get_block (gpointer user_data, gint row, gint col, SheetLayoutBlock *layout)
+{
+    Fixture *fixture = user_data;
+    TestBlock *block;
+
+    g_assert_cmpint (col, ==, 0);
+    g_assert_cmpint (row, >=, 0);
+    g_assert_cmpint (row, <, fixture->num_rows);
+
+    fixture->visits++;
+    block = &fixture->blocks[row];
+    layout->origin_x = &block->origin_x;
+    layout->origin_y = &block->origin_y;
+    layout->width = block->visible ? 100 : 0;
+    layout->height = block->visible ? block->height : 0;
+    return TRUE;
+}
+
+/* Rows of height 10 or 20, with every seventh row hidden. */
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    gint i, height;
+
+    fixture->num_rows = NUM_ROWS;
+    for (i = 0; i < NUM_ROWS; i++)
+    {
+        fixture->blocks[i].origin_x = -1;
+        fixture->blocks[i].origin_y = -1;
+        fixture->blocks[i].height = (i % 3 == 0) ? 20 : 10;
+        fixture->blocks[i].visible = (i % 7 != 6);
+    }
+    g_assert_true (gnc_sheet_layout_update (NUM_ROWS, 1, 0, FALSE,
+                                            get_block, fixture, &height));
+    fixture->visits = 0;
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+}
+
+/* The row the old top-down scan returned. */
+static gint
+scan_row_at_y (Fixture *fixture, gint y)
+{
+    gint row;
+
+    for (row = 1; row < fixture->num_rows; row++)
+    {
+        TestBlock *block = &fixture->blocks[row];
+        gint bottom = block->origin_y + (block->visible ? block->height : 0);
+
+        if (bottom > y)
+            break;
+    }
+    return row;
+}
+
+static void
+test_layout_update_full (Fixture *fixture, gconstpointer pData)
+{
+    gint i, y = 0, height = -1;
+
+    g_assert_true (gnc_sheet_layout_update (NUM_ROWS, 1, 0, FALSE,
+                                            get_block, fixture, &height));
+    g_assert_cmpint (fixture->visits, ==, NUM_ROWS);
+
+    for (i = 0; i < NUM_ROWS; i++)
+    {
+        TestBlock *block = &fixture->blocks[i];
+
+        g_assert_cmpint (block->origin_x, ==, 0);
+        g_assert_cmpint (block->origin_y, ==, y);
+        /* The header shares its origin with the first row. */
+        if (i > 0 && block->visible)
+            y += block->height;
+    }
+    g_assert_cmpint (height, ==, y);
+}
+
+static void
+test_layout_update_stops_when_unchanged (Fixture *fixture,
+                                         gconstpointer pData)
+{
+    gint height = -1;
+
+    /* A change that keeps the height moves nothing below it. */
+    fixture->blocks[500].visible = TRUE;
+    fixture->blocks[500].height = 10;
+    g_assert_false (gnc_sheet_layout_update (NUM_ROWS, 1, 500, TRUE,
+                                             get_block, fixture, &height));
+    g_assert_cmpint (height, ==, -1);
+    /* The start row is looked up twice, then the row after it. */
+    g_assert_cmpint (fixture->visits, ==, 3);
+}
+
+static void
+test_layout_update_moves_rows_below (Fixture *fixture, gconstpointer pData)
+{
+    Fixture expected;
+    gint i, height = -1, expected_height = -1;
+
+    /* Hiding a row moves every row below it up. */
+    fixture->blocks[500].visible = FALSE;
+    g_assert_true (gnc_sheet_layout_update (NUM_ROWS, 1, 500, TRUE,
+                                            get_block, fixture, &height));
+    g_assert_cmpint (fixture->visits, ==, NUM_ROWS - 500 + 1);
+
+    expected = *fixture;
+    for (i = 0; i < NUM_ROWS; i++)
+        expected.blocks[i].origin_y = -1;
+    g_assert_true (gnc_sheet_layout_update (NUM_ROWS, 1, 0, FALSE,
+                                            get_block, &expected,
+                                            &expected_height));
+    for (i = 0; i < NUM_ROWS; i++)
+        g_assert_cmpint (fixture->blocks[i].origin_y, ==,
+                         expected.blocks[i].origin_y);
+    g_assert_cmpint (height, ==, expected_height);
+}
+
+static void
+test_layout_row_at_y (Fixture *fixture, gconstpointer pData)
+{
+    TestBlock *last = &fixture->blocks[NUM_ROWS - 1];
+    gint bottom = last->origin_y + last->height;
+    gint y;
+
+    for (y = -5; y < bottom + 5; y++)
+        g_assert_cmpint (gnc_sheet_layout_row_at_y (NUM_ROWS, y,
+                                                    get_block, fixture),
+                         ==, scan_row_at_y (fixture, y));
+}
+
+static void
+test_layout_row_at_y_is_logarithmic (Fixture *fixture, gconstpointer pData)
+{
+    TestBlock *block = &fixture->blocks[NUM_ROWS - 2];
+
+    g_assert_cmpint (gnc_sheet_layout_row_at_y (NUM_ROWS, block->origin_y,
+                                                get_block, fixture),
+                     ==, NUM_ROWS - 2);
+    g_assert_cmpint (fixture->visits, <=, 10);
+}
+
+static void
+test_layout_row_at_y_edges (Fixture *fixture, gconstpointer pData)
+{
+    /* Only the header: there is no row to find. */
+    g_assert_cmpint (gnc_sheet_layout_row_at_y (1, 0, get_block, fixture),
+                     ==, 1);
+    g_assert_cmpint (gnc_sheet_layout_row_at_y (0, 0, get_block, fixture),
+                     ==, 1);
+    g_assert_cmpint (fixture->visits, ==, 0);
+
+    /* Below the last row. */
+    g_assert_cmpint (gnc_sheet_layout_row_at_y (NUM_ROWS, G_MAXINT / 2,
+                                                get_block, fixture),
+                     ==, NUM_ROWS);
+}
+
+int
+main (int argc, char *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/register/gnome/sheet-layout/update full", Fixture, NULL,
+                setup, test_layout_update_full, teardown);
+    g_test_add ("/register/gnome/sheet-layout/update stops when unchanged",
+                Fixture, NULL, setup,
+                test_layout_update_stops_when_unchanged, teardown);
+    g_test_add ("/register/gnome/sheet-layout/update moves rows below",
+                Fixture, NULL, setup, test_layout_update_moves_rows_below,
+                teardown);
+    g_test_add ("/register/gnome/sheet-layout/row at y", Fixture, NULL,
+                setup, test_layout_row_at_y, teardown);
+    g_test_add ("/register/gnome/sheet-layout/row at y is logarithmic",
+                Fixture, NULL, setup, test_layout_row_at_y_is_logarithmic,
+                teardown);
+    g_test_add ("/register/gnome/sheet-layout/row at y edges", Fixture,
+                NULL, setup, test_layout_row_at_y_edges, teardown);
+
+    return g_test_run ();
+}
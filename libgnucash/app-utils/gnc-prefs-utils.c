@@ -36,6 +36,10 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define GNC_PREF_RETAIN_TYPE_DAYS    "retain-type-days"
 #define GNC_PREF_RETAIN_TYPE_FOREVER "retain-type-forever"
 #define GNC_PREF_RETAIN_DAYS         "retain-days"
+#define GNC_PREF_FILE_LOAD_THREADS   "file-load-threads"
+#define GNC_PREF_FILE_COMPRESSION_THREADS "file-compression-threads"
+#define GNC_PREF_FILE_JOURNAL_SAVES  "file-journal-saves"
+#define GNC_PREF_SQL_LAZY_LOAD       "sql-lazy-load"
 
 /***************************************************************
  * Initialization                                              *
@@ -78,6 +82,46 @@ file_compression_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
     }
 }
 
+static void
+file_load_threads_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gint threads = gnc_prefs_get_int(GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_LOAD_THREADS);
+        gnc_prefs_set_file_load_threads (threads);
+    }
+}
+
+static void
+file_compression_threads_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gint threads = gnc_prefs_get_int(GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION_THREADS);
+        gnc_prefs_set_file_compression_threads (threads);
+    }
+}
+
+static void
+file_journal_saves_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gint saves = gnc_prefs_get_int(GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_JOURNAL_SAVES);
+        gnc_prefs_set_file_journal_saves (saves);
+    }
+}
+
+static void
+sql_lazy_load_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gboolean lazy = gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LAZY_LOAD);
+        gnc_prefs_set_sql_lazy_load (lazy);
+    }
+}
+
 
 void gnc_prefs_init (void)
 {
@@ -89,6 +133,10 @@ void gnc_prefs_init (void)
     file_retain_changed_cb (NULL, NULL, NULL);
     file_retain_type_changed_cb (NULL, NULL, NULL);
     file_compression_changed_cb (NULL, NULL, NULL);
+    file_load_threads_changed_cb (NULL, NULL, NULL);
+    file_compression_threads_changed_cb (NULL, NULL, NULL);
+    file_journal_saves_changed_cb (NULL, NULL, NULL);
+    sql_lazy_load_changed_cb (NULL, NULL, NULL);
 
     /* Check for invalid retain_type (days)/retain_days (0) combo.
      * This can happen either because a user changed the preferences
@@ -122,6 +170,14 @@ void gnc_prefs_init (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_LOAD_THREADS,
+                           file_load_threads_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION_THREADS,
+                           file_compression_threads_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_JOURNAL_SAVES,
+                           file_journal_saves_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LAZY_LOAD,
+                           sql_lazy_load_changed_cb, NULL);
 
 }
 
@@ -139,5 +195,13 @@ gnc_prefs_remove_registered (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_LOAD_THREADS,
+                           file_load_threads_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION_THREADS,
+                           file_compression_threads_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_JOURNAL_SAVES,
+                           file_journal_saves_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LAZY_LOAD,
+                           sql_lazy_load_changed_cb, NULL);
     gnc_gsettings_shutdown ();
 }
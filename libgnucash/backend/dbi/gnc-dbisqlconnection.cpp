@@ -37,6 +37,8 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #include "gnc-dbiproviderimpl.hpp"
 
 static const unsigned int DBI_MAX_CONN_ATTEMPTS = 5;
+/* Statement shapes beyond this many aren't cached. */
+static const size_t DBI_MAX_CACHED_STATEMENTS = 512;
 const std::string lock_table = "gnclock";
 
 /* --------------------------------------------------------- */
@@ -45,12 +47,18 @@ class GncDbiSqlStatement : public GncSqlStatement
 public:
     GncDbiSqlStatement(const std::string& sql) :
         m_sql {sql} {}
+    GncDbiSqlStatement(const std::string& sql, const std::string& plain_sql) :
+        m_sql {sql}, m_plain_sql {plain_sql} {}
     ~GncDbiSqlStatement() {}
     const char* to_sql() const override;
+    /** The statement without reference to anything prepared on the server,
+     * for resending after a reconnect. */
+    const char* to_plain_sql() const;
     void add_where_cond(QofIdTypeConst, const PairVec&) override;
 
 private:
     std::string m_sql;
+    std::string m_plain_sql;
 };
 
 
@@ -60,6 +68,12 @@ GncDbiSqlStatement::to_sql() const
     return m_sql.c_str();
 }
 
+const char*
+GncDbiSqlStatement::to_plain_sql() const
+{
+    return m_plain_sql.empty() ? m_sql.c_str() : m_plain_sql.c_str();
+}
+
 void
 GncDbiSqlStatement::add_where_cond(QofIdTypeConst type_name,
                                    const PairVec& col_values)
@@ -78,7 +92,7 @@ GncDbiSqlStatement::add_where_cond(QofIdTypeConst type_name,
 
 GncDbiSqlConnection::GncDbiSqlConnection (DbType type, QofBackend* qbe,
                                           dbi_conn conn, SessionOpenMode mode) :
-    m_qbe{qbe}, m_conn{conn},
+    m_qbe{qbe}, m_type{type}, m_conn{conn},
     m_provider{type == DbType::DBI_SQLITE ?
             make_dbi_provider<DbType::DBI_SQLITE>() :
             type == DbType::DBI_MYSQL ?
@@ -253,6 +267,19 @@ GncDbiSqlConnection::~GncDbiSqlConnection()
     }
 }
 
+/* What to send again when a query is retried.  A reconnect forgets the
+ * statements prepared on the server, so an EXECUTE can't simply be resent.
+ */
+const char*
+GncDbiSqlConnection::retry_sql (const GncSqlStatementPtr& stmt,
+                                const char* sql) const noexcept
+{
+    if (!m_retry)
+        return sql;
+    auto dbi_stmt = dynamic_cast<const GncDbiSqlStatement*> (stmt.get());
+    return dbi_stmt ? dbi_stmt->to_plain_sql() : sql;
+}
+
 GncSqlResultPtr
 GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
     noexcept
@@ -261,10 +288,12 @@ GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
 
     DEBUG ("SQL: %s\n", stmt->to_sql());
     auto locale = gnc_push_locale (LC_NUMERIC, "C");
+    auto sql = stmt->to_sql();
     do
     {
         init_error ();
-        result = dbi_conn_query (m_conn, stmt->to_sql());
+        result = dbi_conn_query (m_conn, sql);
+        sql = retry_sql (stmt, sql);
     }
     while (m_retry);
     if (result == nullptr)
@@ -286,10 +315,12 @@ GncDbiSqlConnection::execute_nonselect_statement (const GncSqlStatementPtr& stmt
     dbi_result result;
 
     DEBUG ("SQL: %s\n", stmt->to_sql());
+    auto sql = stmt->to_sql();
     do
     {
         init_error ();
-        result = dbi_conn_query (m_conn, stmt->to_sql());
+        result = dbi_conn_query (m_conn, sql);
+        sql = retry_sql (stmt, sql);
     }
     while (m_retry);
     if (result == nullptr && m_last_error)
@@ -323,6 +354,120 @@ GncDbiSqlConnection::create_statement_from_sql (const std::string& sql)
     return std::unique_ptr<GncSqlStatement>{new GncDbiSqlStatement (sql)};
 }
 
+static StrVec
+split_template (const std::string& sql)
+{
+    StrVec parts;
+    std::string::size_type start = 0, pos;
+    while ((pos = sql.find ('?', start)) != std::string::npos)
+    {
+        parts.push_back (sql.substr (start, pos - start));
+        start = pos + 1;
+    }
+    parts.push_back (sql.substr (start));
+    return parts;
+}
+
+GncSqlStatementPtr
+GncDbiSqlConnection::create_statement_from_template (const std::string& sql,
+                                                     const StrVec& params)
+    noexcept
+{
+    CachedStatement uncached;
+    const CachedStatement* cached;
+    auto iter = m_statement_cache.find (sql);
+    if (iter != m_statement_cache.end())
+    {
+        ++m_cache_stats.hits;
+        if (m_type == DbType::DBI_PGSQL && iter->second.m_name.empty() &&
+            !iter->second.m_unpreparable)
+            iter->second.m_unpreparable = !prepare_statement (iter->second);
+        cached = &iter->second;
+    }
+    else
+    {
+        ++m_cache_stats.misses;
+        if (m_statement_cache.size() < DBI_MAX_CACHED_STATEMENTS)
+            cached = &m_statement_cache.emplace (sql,
+                CachedStatement{split_template (sql)}).first->second;
+        else
+        {
+            uncached.m_parts = split_template (sql);
+            cached = &uncached;
+        }
+    }
+
+    if (cached->m_parts.size() != params.size() + 1)
+    {
+        PERR ("Statement %s needs %" G_GSIZE_FORMAT " parameters, got %"
+              G_GSIZE_FORMAT, sql.c_str(), cached->m_parts.size() - 1,
+              params.size());
+        return nullptr;
+    }
+
+    std::string bound = cached->m_parts[0];
+    for (size_t i = 0; i < params.size(); ++i)
+        bound += params[i] + cached->m_parts[i + 1];
+    if (cached->m_name.empty())
+        return create_statement_from_sql (bound);
+
+    auto execute = "EXECUTE " + cached->m_name;
+    for (auto param = params.begin(); param != params.end(); ++param)
+        execute += (param == params.begin() ? "(" : ",") + *param;
+    if (!params.empty())
+        execute += ")";
+    return GncSqlStatementPtr{new GncDbiSqlStatement (execute, bound)};
+}
+
+/* PREPARE the template on the server, inside a savepoint if a transaction is
+ * open so that a failure doesn't abort it.
+ */
+bool
+GncDbiSqlConnection::prepare_statement (CachedStatement& cached) noexcept
+{
+    auto name = "gnc_stmt_" + std::to_string (++m_prepared_count);
+    auto sql = "PREPARE " + name + " AS " + cached.m_parts[0];
+    for (size_t i = 1; i < cached.m_parts.size(); ++i)
+        sql += "$" + std::to_string (i) + cached.m_parts[i];
+
+    auto run = [this](const char* query)
+    {
+        init_error ();
+        auto result = dbi_conn_query (m_conn, query);
+        if (result)
+            dbi_result_free (result);
+        return result != nullptr;
+    };
+
+    bool in_transaction = m_sql_savepoint > 0;
+    if (in_transaction && !run ("SAVEPOINT gnc_prepare"))
+        return false;
+    DEBUG ("SQL: %s\n", sql.c_str());
+    auto ok = run (sql.c_str());
+    if (!ok)
+    {
+        PWARN ("Failed to prepare %s", sql.c_str());
+        if (in_transaction)
+            run ("ROLLBACK TO SAVEPOINT gnc_prepare");
+    }
+    if (in_transaction)
+        run ("RELEASE SAVEPOINT gnc_prepare");
+    init_error ();
+    if (ok)
+        cached.m_name = name;
+    return ok;
+}
+
+void
+GncDbiSqlConnection::forget_prepared_statements () noexcept
+{
+    for (auto& entry : m_statement_cache)
+    {
+        entry.second.m_name.clear();
+        entry.second.m_unpreparable = false;
+    }
+}
+
 bool
 GncDbiSqlConnection::does_table_exist (const std::string& table_name)
     const noexcept
@@ -405,6 +550,14 @@ GncDbiSqlConnection::rollback_transaction () noexcept
     }
 
     --m_sql_savepoint;
+    /* Don't rely on statements prepared in the rolled back work. */
+    if (m_type == DbType::DBI_PGSQL && m_prepared_count > 0)
+    {
+        result = dbi_conn_query (m_conn, "DEALLOCATE ALL");
+        if (result)
+            dbi_result_free (result);
+        forget_prepared_statements ();
+    }
     return true;
 }
 
@@ -566,6 +719,7 @@ GncDbiSqlConnection::verify () noexcept
      */
     init_error ();
     m_conn_ok = true;
+    forget_prepared_statements ();
     (void)dbi_conn_connect (m_conn);
 
     return m_conn_ok;
@@ -581,6 +735,7 @@ GncDbiSqlConnection::retry_connection(const char* msg)
         if (dbi_conn_connect(m_conn) == 0)
         {
             init_error();
+            forget_prepared_statements ();
             m_conn_ok = true;
             return true;
         }
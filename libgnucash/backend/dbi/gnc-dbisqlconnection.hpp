@@ -24,6 +24,7 @@
 #define _GNC_DBISQLCONNECTION_HPP_
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <gnc-sql-connection.hpp>
@@ -50,6 +51,13 @@ public:
         noexcept override;
     GncSqlStatementPtr create_statement_from_sql (const std::string&)
         const noexcept override;
+    GncSqlStatementPtr create_statement_from_template (const std::string&,
+                                                       const StrVec&)
+        noexcept override;
+    GncSqlStatementCacheStats statement_cache_stats () const noexcept override
+    {
+        return m_cache_stats;
+    }
     bool does_table_exist (const std::string&) const noexcept override;
     bool begin_transaction () noexcept override;
     bool rollback_transaction () noexcept override;
@@ -60,6 +68,8 @@ public:
     bool add_columns_to_table (const std::string&, const ColVec&)
         const noexcept override;
     std::string quote_string (const std::string&) const noexcept override;
+    /* SQLite before 3.8.8 refuses more than 500 rows in a VALUES list. */
+    unsigned int max_insert_rows () const noexcept override { return 250; }
     int dberror() const noexcept override {
         return dbi_conn_error(m_conn, nullptr); }
     QofBackend* qbe () const noexcept { return m_qbe; }
@@ -86,7 +96,17 @@ public:
                                 const ColVec& info_vec) const noexcept;
     bool drop_indexes() noexcept;
 private:
+    /** A statement template split at its parameters. On PostgreSQL a template
+     * used more than once is prepared on the server under m_name.
+     */
+    struct CachedStatement
+    {
+        StrVec m_parts;
+        std::string m_name;
+        bool m_unpreparable = false;
+    };
     QofBackend* m_qbe = nullptr;
+    DbType m_type;
     dbi_conn m_conn;
     std::unique_ptr<GncDbiProvider> m_provider;
     /** Used by the error handler routines to flag if the connection is ok to
@@ -109,6 +129,12 @@ private:
     bool m_retry;
     unsigned int m_sql_savepoint;
     bool m_readonly; 
+    std::unordered_map<std::string, CachedStatement> m_statement_cache;
+    GncSqlStatementCacheStats m_cache_stats;
+    unsigned int m_prepared_count = 0;
+    bool prepare_statement (CachedStatement&) noexcept;
+    const char* retry_sql (const GncSqlStatementPtr&, const char*) const noexcept;
+    void forget_prepared_statements () noexcept;
     bool lock_database(bool break_lock);
     void unlock_database();
     bool rename_table(const std::string& old_name, const std::string& new_name);
@@ -39,9 +39,11 @@
 #include <gnc-uri-utils.h>
     /* For setup_business */
 #include "Account.h"
+#include "Account.hpp"
 #include <TransLog.h>
 #include "Transaction.h"
 #include "Split.h"
+#include "Query.h"
 #include "gnc-commodity.h"
 #include "gncAddress.h"
 #include "gncCustomer.h"
@@ -419,6 +421,190 @@ test_dbi_store_and_reload (Fixture* fixture, gconstpointer pData)
     qof_session_destroy (session_3);
 }
 
+static void
+compare_account_balances (QofBook* book_1, QofBook* book_2)
+{
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book_1));
+    for (auto node = accounts; node; node = g_list_next (node))
+    {
+        auto acct_1 = GNC_ACCOUNT (node->data);
+        auto acct_2 = xaccAccountLookup (qof_instance_get_guid (acct_1), book_2);
+        g_assert_nonnull (acct_2);
+        g_assert_true (gnc_numeric_equal (xaccAccountGetBalance (acct_1),
+                                          xaccAccountGetBalance (acct_2)));
+        g_assert_true (gnc_numeric_equal (xaccAccountGetClearedBalance (acct_1),
+                                          xaccAccountGetClearedBalance (acct_2)));
+        g_assert_true (gnc_numeric_equal (xaccAccountGetReconciledBalance (acct_1),
+                                          xaccAccountGetReconciledBalance (acct_2)));
+    }
+    g_list_free (accounts);
+}
+
+/* Reload with sql-lazy-load set: the balances must be right before any
+ * transaction is loaded and stay right while queries load them. */
+static void
+test_dbi_lazy_load (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto book2{qof_book_new()};
+    auto session_2 = qof_session_new (book2);
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    book2 = qof_session_get_book (session_2);
+
+    gnc_prefs_set_sql_lazy_load (TRUE);
+    auto book3{qof_book_new()};
+    auto session_3 = qof_session_new (book3);
+    qof_session_begin (session_3, url, SESSION_READ_ONLY);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    gnc_prefs_set_sql_lazy_load (FALSE);
+    book3 = qof_session_get_book (session_3);
+
+    auto trans_2 = qof_book_get_collection (book2, GNC_ID_TRANS);
+    auto trans_3 = qof_book_get_collection (book3, GNC_ID_TRANS);
+    g_assert_cmpuint (qof_collection_count (trans_3), <,
+                      qof_collection_count (trans_2));
+    compare_account_balances (book2, book3);
+
+    /* A query limited to recent splits fetches only those.  Balances as of
+     * earlier dates and split lists must fetch the rest themselves. */
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book2));
+    auto index = 0;
+    for (auto node = accounts; node; node = g_list_next (node), ++index)
+    {
+        auto acct_2 = GNC_ACCOUNT (node->data);
+        auto acct_3 = xaccAccountLookup (qof_instance_get_guid (acct_2), book3);
+        auto splits_2 = xaccAccountGetSplits (acct_2);
+        if (splits_2.empty ())
+            continue;
+
+        auto split_date = [](Split* split)
+        { return xaccTransGetDate (xaccSplitGetParent (split)); };
+        auto first = split_date (splits_2.front ());
+        auto mid = split_date (splits_2[splits_2.size () / 2]);
+        auto query = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (query, book3);
+        xaccQueryAddSingleAccountMatch (query, acct_3, QOF_QUERY_AND);
+        xaccQueryAddDateMatchTT (query, TRUE, mid, FALSE, 0, QOF_QUERY_AND);
+        auto splits = qof_query_run (query);
+        g_assert_cmpuint (g_list_length (splits), ==,
+                          std::count_if (splits_2.begin (), splits_2.end (),
+                                         [mid, split_date](Split* split)
+                                         { return split_date (split) >= mid; }));
+        qof_query_destroy (query);
+        g_assert_true (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct_3, mid),
+                                          xaccAccountGetBalanceAsOfDate (acct_2, mid)));
+
+        if (index % 2)
+        {
+            g_assert_true (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct_3, first),
+                                              xaccAccountGetBalanceAsOfDate (acct_2, first)));
+            g_assert_true (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct_3, first + 1),
+                                              xaccAccountGetBalanceAsOfDate (acct_2, first + 1)));
+        }
+        else
+        {
+            auto list = xaccAccountGetSplitList (acct_3);
+            g_assert_cmpuint (g_list_length (list), ==, splits_2.size ());
+            g_list_free (list);
+        }
+        compare_account_balances (book2, book3);
+    }
+
+    for (auto node = accounts; node; node = g_list_next (node))
+    {
+        auto acct_2 = GNC_ACCOUNT (node->data);
+        auto acct_3 = xaccAccountLookup (qof_instance_get_guid (acct_2), book3);
+        auto query = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (query, book3);
+        xaccQueryAddSingleAccountMatch (query, acct_3, QOF_QUERY_AND);
+        auto splits = qof_query_run (query);
+        g_assert_cmpuint (g_list_length (splits), ==,
+                          xaccAccountGetSplitsSize (acct_2));
+        qof_query_destroy (query);
+        compare_account_balances (book2, book3);
+    }
+    g_list_free (accounts);
+
+    qof_session_ensure_all_data_loaded (session_3);
+    compare_books (book2, book3);
+    compare_account_balances (book2, book3);
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
+/* Committing the same kind of object again must reuse cached statements. */
+static void
+test_dbi_statement_cache (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto book2{qof_book_new()};
+    auto session_2 = qof_session_new (book2);
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    GncSqlBackend* sql_be = nullptr;
+    sql_be = reinterpret_cast<decltype(sql_be)>(qof_session_get_backend (session_2));
+    auto before = sql_be->statement_cache_stats ();
+    auto root = gnc_book_get_root_account (qof_session_get_book (session_2));
+    auto acct = gnc_account_nth_child (root, 0);
+    for (auto name : {"Bank 2", "Bank 3", "Bank 4"})
+    {
+        xaccAccountBeginEdit (acct);
+        xaccAccountSetName (acct, name);
+        xaccAccountCommitEdit (acct);
+    }
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    auto after = sql_be->statement_cache_stats ();
+    g_assert_cmpuint (after.hits, >, before.hits);
+
+    auto book3{qof_book_new()};
+    auto session_3 = qof_session_new (book3);
+    qof_session_begin (session_3, url, SESSION_READ_ONLY);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    compare_books (qof_session_get_book (session_2),
+                   qof_session_get_book (session_3));
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
 /** Test the safe_save mechanism.  Beware that this test used on its
  * own doesn't ensure that the resave is done safely, only that the
  * database is intact and unchanged after the save. To observe the
@@ -640,6 +826,10 @@ create_dbi_test_suite (const char* dbm_name, const char* url)
     auto subsuite = g_strdup_printf ("%s/%s", suitename, dbm_name);
     GNC_TEST_ADD (subsuite, "store_and_reload", Fixture, url, setup,
                   test_dbi_store_and_reload, teardown);
+    GNC_TEST_ADD (subsuite, "lazy_load", Fixture, url, setup,
+                  test_dbi_lazy_load, teardown);
+    GNC_TEST_ADD (subsuite, "statement_cache", Fixture, url, setup_memory,
+                  test_dbi_statement_cache, teardown);
     GNC_TEST_ADD (subsuite, "safe_save", Fixture, url, setup_memory,
                   test_dbi_safe_save, teardown);
     GNC_TEST_ADD (subsuite, "version_control", Fixture, url, setup_memory,
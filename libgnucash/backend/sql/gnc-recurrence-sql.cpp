@@ -311,9 +311,9 @@ gnc_sql_set_recurrences_from_db (GncSqlBackend* sql_be, const GncGUID* guid)
     g_return_val_if_fail (guid != NULL, NULL);
 
     (void)guid_to_string_buff (guid, guid_buf);
-    buf = g_strdup_printf ("SELECT * FROM %s WHERE obj_guid='%s'", TABLE_NAME,
-                           guid_buf);
-    auto stmt = sql_be->create_statement_from_sql (buf);
+    buf = g_strdup_printf ("SELECT * FROM %s WHERE obj_guid=?", TABLE_NAME);
+    StrVec params{std::string{"'"} + guid_buf + "'"};
+    auto stmt = sql_be->create_statement_from_template (buf, params);
     g_free (buf);
     auto result = sql_be->execute_select_statement(stmt);
     return result;
@@ -667,9 +667,10 @@ gnc_sql_slots_delete (GncSqlBackend* sql_be, const GncGUID* guid)
 
     (void)guid_to_string_buff (guid, guid_buf);
 
-    buf = g_strdup_printf ("SELECT * FROM %s WHERE obj_guid='%s' and slot_type in ('%d', '%d') and not guid_val is null",
-                           TABLE_NAME, guid_buf, KvpValue::Type::FRAME, KvpValue::Type::GLIST);
-    auto stmt = sql_be->create_statement_from_sql(buf);
+    buf = g_strdup_printf ("SELECT * FROM %s WHERE obj_guid=? and slot_type in ('%d', '%d') and not guid_val is null",
+                           TABLE_NAME, KvpValue::Type::FRAME, KvpValue::Type::GLIST);
+    StrVec params{std::string{"'"} + guid_buf + "'"};
+    auto stmt = sql_be->create_statement_from_template(buf, params);
     g_free (buf);
     if (stmt != nullptr)
     {
@@ -747,9 +748,9 @@ slots_load_info (slot_info_t* pInfo)
     g_return_if_fail (pInfo->pKvpFrame != NULL);
 
     gnc::GUID guid(*pInfo->guid);
-    std::string sql("SELECT * FROM " TABLE_NAME " WHERE obj_guid='");
-    sql += guid.to_string() + "'";
-    auto stmt = pInfo->be->create_statement_from_sql(sql);
+    std::string sql("SELECT * FROM " TABLE_NAME " WHERE obj_guid=?");
+    StrVec params{"'" + guid.to_string() + "'"};
+    auto stmt = pInfo->be->create_statement_from_template(sql, params);
     if (stmt != nullptr)
     {
         auto result = pInfo->be->execute_select_statement (stmt);
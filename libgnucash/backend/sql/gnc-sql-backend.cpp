@@ -111,9 +111,31 @@ GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
     return stmt;
 }
 
+GncSqlStatementPtr
+GncSqlBackend::create_statement_from_template(const std::string& str,
+                                              const StrVec& params) const noexcept
+{
+    auto stmt = m_conn ? m_conn->create_statement_from_template(str, params) :
+        nullptr;
+    if (stmt == nullptr)
+    {
+        PERR ("SQL error: %s\n", str.c_str());
+        qof_backend_set_error ((QofBackend*)this, ERR_BACKEND_SERVER_ERR);
+    }
+    return stmt;
+}
+
+GncSqlStatementCacheStats
+GncSqlBackend::statement_cache_stats() const noexcept
+{
+    return m_conn ? m_conn->statement_cache_stats() : GncSqlStatementCacheStats{};
+}
+
 GncSqlResultPtr
 GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    if (!flush_insert_batches())
+        return nullptr;
     auto result = m_conn ? m_conn->execute_select_statement(stmt) : nullptr;
     if (result == nullptr)
     {
@@ -126,6 +148,8 @@ GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const no
 int
 GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    if (!flush_insert_batches())
+        return -1;
     int result = m_conn ? m_conn->execute_nonselect_statement(stmt) : -1;
     if (result == -1)
     {
@@ -248,6 +272,8 @@ GncSqlBackend::ObjectBackendRegistry::load_remaining(GncSqlBackend* sql_be)
                       type) != business_fixed_load_order.end()) continue;
 
         num_done++;
+        /* A lazy load fetches transactions when they're queried. */
+        if (type == GNC_ID_TRANS && sql_be->m_lazy_load) continue;
         sql_be->update_progress(num_done * 100 / num_types);
         obe->load_all (sql_be);
     }
@@ -294,6 +320,8 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     {
         assert (m_book == nullptr);
         m_book = book;
+        m_lazy_load = gnc_prefs_get_sql_lazy_load ();
+        m_loaded_since.clear();
 
         auto num_types = m_backend_registry.size();
         auto num_done = 0;
@@ -328,12 +356,25 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
         gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                        nullptr);
+
+        if (m_lazy_load)
+            gnc_sql_transaction_load_account_balances (this);
+        m_all_loaded = !m_lazy_load;
     }
-    else if (loadType == LOAD_TYPE_LOAD_ALL)
+    else if (loadType == LOAD_TYPE_LOAD_ALL && !m_all_loaded)
     {
         // Load all transactions
-        auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
-        obe->load_all (this);
+        if (m_lazy_load)
+        {
+            m_all_loaded = gnc_sql_transaction_load_tx_for_accounts (this, {},
+                                                                     INT64_MIN);
+        }
+        else
+        {
+            auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
+            obe->load_all (this);
+            m_all_loaded = true;
+        }
     }
 
     m_loading = FALSE;
@@ -356,9 +397,93 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     qof_book_mark_session_saved (book);
     finish_progress();
 
+    auto stats = statement_cache_stats();
+    LEAVE ("statement cache hits=%lu, misses=%lu", stats.hits, stats.misses);
+}
+
+/* Fetches the transactions of the accounts posted on or after since, or every
+ * transaction if accounts is empty, and records what was fetched once the
+ * database has been read successfully. */
+void
+GncSqlBackend::fetch_transactions (const std::vector<Account*>& accounts,
+                                   time64 since)
+{
+    std::vector<Account*> fetch;
+    for (auto acc : accounts)
+    {
+        auto iter = m_loaded_since.find (acc);
+        if (iter == m_loaded_since.end() || iter->second > since)
+            fetch.push_back (acc);
+    }
+    if (!accounts.empty() && fetch.empty())
+        return;
+
+    m_in_query = true;
+    m_loading = true;
+    qof_book_begin_bulk_load (m_book);
+    auto loaded = gnc_sql_transaction_load_tx_for_accounts (this, fetch, since);
+    qof_book_end_bulk_load (m_book);
+    m_loading = false;
+    m_in_query = false;
+
+    if (!loaded)
+        return;
+    if (accounts.empty())
+        m_all_loaded = true;
+    for (auto acc : fetch)
+        m_loaded_since[acc] = since;
+}
+
+bool
+GncSqlBackend::can_fetch () const noexcept
+{
+    return m_lazy_load && !m_all_loaded && !m_loading && !m_in_query &&
+        m_book != nullptr;
+}
+
+void
+GncSqlBackend::run_query (QofQuery* query)
+{
+    g_return_if_fail (query != nullptr);
+
+    if (!can_fetch())
+        return;
+
+    auto search_for = qof_query_get_search_for (query);
+    if (g_strcmp0 (search_for, GNC_ID_SPLIT) != 0 &&
+        g_strcmp0 (search_for, GNC_ID_TRANS) != 0)
+        return;
+
+    ENTER ("query=%p", query);
+    std::vector<Account*> accounts;
+    time64 since;
+    if (gnc_sql_transaction_query_scope (query, m_book, accounts, since))
+        fetch_transactions (accounts, since);
+    else
+        fetch_transactions ({}, INT64_MIN);
+    LEAVE ("");
+}
+
+void
+GncSqlBackend::fetch_account_splits (QofInstance* inst, time64 since)
+{
+    g_return_if_fail (GNC_IS_ACCOUNT (inst));
+
+    if (!can_fetch())
+        return;
+
+    ENTER ("account=%p", inst);
+    fetch_transactions ({GNC_ACCOUNT (inst)}, since);
     LEAVE ("");
 }
 
+void
+GncSqlBackend::ensure_all_loaded () noexcept
+{
+    if (m_lazy_load && !m_all_loaded && m_book != nullptr)
+        load (m_book, LOAD_TYPE_LOAD_ALL);
+}
+
 /* ================================================================= */
 
 bool
@@ -417,7 +542,10 @@ write_tx (Transaction* tx, gpointer data)
     {
         s->is_ok = splitbe->commit(s->be, QOF_INSTANCE(split_node->data));
     }
-    s->be->update_progress (101.0);
+    if (s->total)
+        s->be->update_progress (100.0 * ++s->done / s->total);
+    else
+        s->be->update_progress (101.0);
     return (s->is_ok ? 0 : 1);
 }
 
@@ -426,6 +554,7 @@ GncSqlBackend::write_transactions()
 {
     auto obe = m_backend_registry.get_object_backend(GNC_ID_TRANS);
     write_objects_t data{this, TRUE, obe.get()};
+    data.total = gnc_book_count_transactions (m_book);
 
     (void)xaccAccountTreeForEachTransaction (
         gnc_book_get_root_account (m_book), write_tx, &data);
@@ -485,6 +614,8 @@ GncSqlBackend::sync(QofBook* book)
     /* Save all contents */
     m_book = book;
     auto is_ok = m_conn->begin_transaction();
+    if (is_ok)
+        begin_insert_batch();
 
     // FIXME: should write the set of commodities that are used
     // write_commodities(sql_be, book);
@@ -514,6 +645,8 @@ GncSqlBackend::sync(QofBook* book)
         for (auto entry : m_backend_registry)
             std::get<1>(entry)->write (this);
     }
+    if (!end_insert_batch (is_ok))
+        is_ok = false;
     if (is_ok)
     {
         is_ok = m_conn->commit_transaction();
@@ -632,7 +765,12 @@ GncSqlBackend::commit (QofInstance* inst)
 
     auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
     if (obe != nullptr)
+    {
+        begin_insert_batch();
         is_ok = obe->commit(this, inst);
+        if (!end_insert_batch (is_ok))
+            is_ok = false;
+    }
     else
     {
         PERR ("Unknown object type '%s'\n", inst->e_type);
@@ -828,6 +966,25 @@ get_object_values (QofIdTypeConst obj_name,
     return vec;
 }
 
+/* Append a WHERE condition on the first of the values, the object's key, to
+ * a statement template.
+ */
+static void
+add_key_to_template (std::ostringstream& sql, StrVec& params,
+                     const PairVec& values)
+{
+    const auto& key = values.front();
+    if (key.second == "NULL")
+    {
+        sql << " WHERE " << key.first << " IS NULL";
+    }
+    else
+    {
+        sql << " WHERE " << key.first << " = ?";
+        params.push_back (key.second);
+    }
+}
+
 bool
 GncSqlBackend::object_in_db (const char* table_name, QofIdTypeConst obj_name,
                              const gpointer pObject, const EntryVec& table) const noexcept
@@ -837,15 +994,17 @@ GncSqlBackend::object_in_db (const char* table_name, QofIdTypeConst obj_name,
     g_return_val_if_fail (pObject != nullptr, false);
 
     /* SELECT * FROM */
-    auto sql = std::string{"SELECT "} + table[0]->name() + " FROM " + table_name;
-    auto stmt = create_statement_from_sql(sql.c_str());
-    assert (stmt != nullptr);
+    std::ostringstream sql;
+    sql << "SELECT " << table[0]->name() << " FROM " << table_name;
 
     /* WHERE */
     PairVec values{get_object_values(obj_name, pObject, table)};
     /* We want only the first item in the table, which should be the PK. */
-    values.resize(1);
-    stmt->add_where_cond(obj_name, values);
+    StrVec params;
+    add_key_to_template (sql, params, values);
+    auto stmt = create_statement_from_template(sql.str(), params);
+    if (stmt == nullptr)
+        return false;
     auto result = execute_select_statement (stmt);
     return (result != nullptr && result->size() > 0);
 }
@@ -861,6 +1020,9 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     g_return_val_if_fail (obj_name != nullptr, false);
     g_return_val_if_fail (pObject != nullptr, false);
 
+    if (op == OP_DB_INSERT && m_batch_inserts)
+        return add_to_insert_batch (table_name, obj_name, pObject, table);
+
     switch(op)
     {
         case  OP_DB_INSERT:
@@ -882,13 +1044,109 @@ bool
 GncSqlBackend::save_commodity(gnc_commodity* comm) noexcept
 {
     if (comm == nullptr) return false;
+    /* While batching, every transaction would otherwise look its currency up
+     * and so flush the pending rows. */
+    if (m_batch_inserts && m_saved_commodities.count(comm))
+        return true;
     QofInstance* inst = QOF_INSTANCE(comm);
     auto obe = m_backend_registry.get_object_backend(std::string(inst->e_type));
-    if (obe && !obe->instance_in_db(this, inst))
-        return obe->commit(this, inst);
+    if (obe && !obe->instance_in_db(this, inst) && !obe->commit(this, inst))
+        return false;
+    if (m_batch_inserts)
+        m_saved_commodities.insert(comm);
     return true;
 }
 
+void
+GncSqlBackend::begin_insert_batch() noexcept
+{
+    m_batch_inserts = m_conn && m_conn->max_insert_rows() > 1;
+}
+
+bool
+GncSqlBackend::end_insert_batch(bool commit) noexcept
+{
+    auto is_ok = true;
+    if (commit)
+        is_ok = flush_insert_batches();
+    m_insert_batches.clear();
+    m_saved_commodities.clear();
+    m_batch_inserts = false;
+    return is_ok;
+}
+
+bool
+GncSqlBackend::add_to_insert_batch (const char* table_name,
+                                    QofIdTypeConst obj_name, gpointer pObject,
+                                    const EntryVec& table) const noexcept
+{
+    PairVec values{get_object_values(obj_name, pObject, table)};
+    std::ostringstream sql;
+
+    sql << "INSERT INTO " << table_name << "(";
+    for (auto const& col_value : values)
+    {
+        if (col_value != *values.begin())
+            sql << ",";
+        sql << col_value.first;
+    }
+    sql << ") VALUES";
+
+    auto& batch = m_insert_batches[sql.str()];
+    if (batch.rows == 0)
+        batch.sql = sql.str();
+    else
+        batch.sql += ",";
+
+    batch.sql += "(";
+    for (const auto& col_value : values)
+    {
+        if (col_value != *values.begin())
+            batch.sql += ",";
+        batch.sql += col_value.second;
+    }
+    batch.sql += ")";
+
+    /* Stay well below the statement length limits of the databases. */
+    constexpr size_t max_sql_length{512 * 1024};
+    if (++batch.rows >= m_conn->max_insert_rows() ||
+        batch.sql.size() >= max_sql_length)
+        return flush_insert_batch (batch);
+    return true;
+}
+
+bool
+GncSqlBackend::flush_insert_batch (InsertBatch& batch) const noexcept
+{
+    if (batch.rows == 0)
+        return true;
+
+    auto stmt = create_statement_from_sql(batch.sql);
+    auto rows = batch.rows;
+    batch.sql.clear();
+    batch.rows = 0;
+
+    if (stmt == nullptr)
+        return false;
+    if (m_conn->execute_nonselect_statement(stmt) == -1)
+    {
+        PERR ("SQL error inserting %u rows: %.200s\n", rows, stmt->to_sql());
+        qof_backend_set_error ((QofBackend*)this, ERR_BACKEND_SERVER_ERR);
+        return false;
+    }
+    return true;
+}
+
+bool
+GncSqlBackend::flush_insert_batches () const noexcept
+{
+    auto is_ok = true;
+    for (auto& entry : m_insert_batches)
+        if (!flush_insert_batch (entry.second))
+            is_ok = false;
+    return is_ok;
+}
+
 GncSqlStatementPtr
 GncSqlBackend::build_insert_statement (const char* table_name,
                                        QofIdTypeConst obj_name,
@@ -913,15 +1171,17 @@ GncSqlBackend::build_insert_statement (const char* table_name,
     }
 
     sql << ") VALUES(";
+    StrVec params;
     for (const auto& col_value : values)
     {
         if (col_value != *values.begin())
             sql << ",";
-        sql << col_value.second;
+        sql << "?";
+        params.push_back(col_value.second);
     }
     sql << ")";
 
-    stmt = create_statement_from_sql(sql.str());
+    stmt = create_statement_from_template(sql.str(), params);
     return stmt;
 }
 
@@ -943,20 +1203,20 @@ GncSqlBackend::build_update_statement(const gchar* table_name,
     // Create the SQL statement
     sql <<  "UPDATE " << table_name << " SET ";
 
+    StrVec params;
     for (auto const& col_value : values)
     {
         if (col_value != *values.begin())
             sql << ",";
-        sql << col_value.first << "=" <<
-            col_value.second;
+        sql << col_value.first << "=?";
+        params.push_back(col_value.second);
     }
 
-    stmt = create_statement_from_sql(sql.str());
     /* We want our where condition to be just the first column and
      * value, i.e. the guid of the object.
      */
-    values.erase(values.begin() + 1, values.end());
-    stmt->add_where_cond(obj_name, values);
+    add_key_to_template (sql, params, values);
+    stmt = create_statement_from_template(sql.str(), params);
     return stmt;
 }
 
@@ -973,15 +1233,14 @@ GncSqlBackend::build_delete_statement(const gchar* table_name,
     g_return_val_if_fail (pObject != nullptr, nullptr);
 
     sql << "DELETE FROM " << table_name;
-    auto stmt = create_statement_from_sql (sql.str());
 
     /* WHERE */
     PairVec values;
     table[0]->add_to_query (obj_name, pObject, values);
-    PairVec col_values{values[0]};
-    stmt->add_where_cond (obj_name, col_values);
+    StrVec params;
+    add_key_to_template (sql, params, values);
 
-    return stmt;
+    return create_statement_from_template (sql.str(), params);
 }
 
 GncSqlBackend::ObjectBackendRegistry::ObjectBackendRegistry()
@@ -27,9 +27,12 @@
 #include <qof.h>
 #include <Account.h>
 
+#include <map>
 #include <memory>
 #include <exception>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <qof-backend.hpp>
 
@@ -95,6 +98,26 @@ public:
      * @param inst Object being edited
      */
     void rollback(QofInstance*) override;
+    /**
+     * In lazy-load mode, fetch the transactions that a split query might
+     * match from the database.
+     *
+     * @param query The query about to be run
+     */
+    void run_query(QofQuery*) override;
+    /**
+     * In lazy-load mode, fetch the transactions with splits in an account
+     * posted on or after a date from the database.
+     *
+     * @param inst The account
+     * @param since The earliest post date needed
+     */
+    void fetch_account_splits(QofInstance* inst, time64 since) override;
+    /**
+     * In lazy-load mode, fetch every transaction not yet loaded.  Must be
+     * called before the whole book is written back to the database.
+     */
+    void ensure_all_loaded() noexcept;
     /** Connect the backend to a GncSqlConnection.
      * Sets up version info. Calling with nullptr clears the connection and
      * destroys the version info.
@@ -111,6 +134,22 @@ public:
     void finalize_version_info() noexcept;
     /* FIXME: These are just pass-throughs of m_conn functions. */
     GncSqlStatementPtr create_statement_from_sql(const std::string& str) const noexcept;
+    /**
+     * Creates a statement from SQL in which each '?' is a placeholder for the
+     * SQL literal at the same position in params.  The connection caches
+     * statements by their SQL, so use a template for statements that are run
+     * over and over with different values.
+     *
+     * @param str SQL with placeholders
+     * @param params Quoted values for the placeholders
+     * @return The statement, or nullptr if an error has occurred
+     */
+    GncSqlStatementPtr create_statement_from_template(const std::string& str,
+                                                      const StrVec& params) const noexcept;
+    /**
+     * Returns the hit and miss counts of the connection's statement cache.
+     */
+    GncSqlStatementCacheStats statement_cache_stats() const noexcept;
     /** Executes an SQL SELECT statement and returns the result rows.  If an
      * error occurs, an entry is added to the log, an error status is returned
      * to qof and nullptr is returned.
@@ -224,6 +263,20 @@ public:
     bool do_db_operation (E_DB_OPERATION op, const char* table_name,
                           QofIdTypeConst obj_name, gpointer pObject,
                           const EntryVec& table) const noexcept;
+    /**
+     * Start collecting the rows of OP_DB_INSERT operations into multi-row
+     * INSERT statements, one per table. The pending rows are sent when a
+     * statement fills up, before any other statement is executed and by
+     * end_insert_batch().
+     */
+    void begin_insert_batch() noexcept;
+    /**
+     * Send the pending rows and stop collecting them.
+     *
+     * @param commit false to discard the pending rows instead
+     * @return true if all the rows were written
+     */
+    bool end_insert_batch(bool commit = true) noexcept;
     /**
      * Ensure that a commodity referenced in another object is in fact saved
      * in the database.
@@ -247,11 +300,23 @@ protected:
     const char* m_time_format = nullptr; /**< Server-specific date-time string format */
     VersionVec m_versions;    /**< Version number for each table */
 private:
+    struct InsertBatch
+    {
+        std::string sql;
+        unsigned int rows = 0;
+    };
+    bool add_to_insert_batch (const char* table_name, QofIdTypeConst obj_name,
+                              gpointer pObject,
+                              const EntryVec& table) const noexcept;
+    bool flush_insert_batch (InsertBatch& batch) const noexcept;
+    bool flush_insert_batches () const noexcept;
     bool write_account_tree(Account*);
     bool write_accounts();
     bool write_transactions();
     bool write_template_transactions();
     bool write_schedXactions();
+    bool can_fetch() const noexcept;
+    void fetch_transactions(const std::vector<Account*>& accounts, time64 since);
     GncSqlStatementPtr build_insert_statement (const char* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
@@ -286,6 +351,17 @@ private:
     };
     ObjectBackendRegistry m_backend_registry;
     std::vector<gnc_commodity*> m_postload_commodities;
+    bool m_batch_inserts = false;
+    /** Transactions are fetched by run_query() instead of by load() */
+    bool m_lazy_load = false;
+    /** Every transaction in the database is in the book */
+    bool m_all_loaded = false;
+    /** The earliest post date fetched for each account in lazy-load mode */
+    std::unordered_map<Account*, time64> m_loaded_since;
+    /** Pending multi-row INSERTs, keyed by their "INSERT INTO t(cols)" */
+    mutable std::map<std::string, InsertBatch> m_insert_batches;
+    /** Commodities known to be in the database while batching */
+    std::unordered_set<gnc_commodity*> m_saved_commodities;
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
@@ -37,6 +37,7 @@ using EntryVec = std::vector<GncSqlColumnTableEntryPtr>;
 using PairVec = std::vector<std::pair<std::string, std::string>>;
 struct GncSqlColumnInfo;
 using ColVec = std::vector<GncSqlColumnInfo>;
+using StrVec = std::vector<std::string>;
 
 /**
  * SQL statement provider.
@@ -51,6 +52,15 @@ public:
 
 using GncSqlStatementPtr = std::unique_ptr<GncSqlStatement>;
 
+/**
+ * Usage counts of a connection's statement cache.
+ */
+struct GncSqlStatementCacheStats
+{
+    unsigned long hits = 0;   /**< Statements whose shape was already cached */
+    unsigned long misses = 0; /**< Statements with a new shape */
+};
+
 /**
  * Encapsulate the connection to the database. This is an abstract class; the
  * implementation is database-specific.
@@ -67,6 +77,15 @@ public:
         noexcept = 0;
     virtual GncSqlStatementPtr create_statement_from_sql (const std::string&)
         const noexcept = 0;
+    /** Create a statement from SQL in which each '?' stands for the SQL
+     * literal at the same position in the parameters.  Statements with the
+     * same SQL share a cache entry, which the server may prepare once.
+     * Returns nullptr if the number of parameters doesn't match.
+     */
+    virtual GncSqlStatementPtr create_statement_from_template (const std::string&,
+                                                               const StrVec&)
+        noexcept = 0;
+    virtual GncSqlStatementCacheStats statement_cache_stats () const noexcept = 0;
     /** Returns true if successful */
     virtual bool does_table_exist (const std::string&) const noexcept = 0;
     /** Returns TRUE if successful, false if error */
@@ -86,6 +105,10 @@ public:
         const noexcept = 0;
     virtual std::string quote_string (const std::string&)
         const noexcept = 0;
+    /** The most rows to send in one multi-row INSERT; 1 sends each row in a
+     * statement of its own.
+     */
+    virtual unsigned int max_insert_rows () const noexcept = 0;
     /** Get the connection error value.
      * If not 0 will normally be meaningless outside of implementation code.
      */
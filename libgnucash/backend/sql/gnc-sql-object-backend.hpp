@@ -132,6 +132,8 @@ struct write_objects_t
     GncSqlBackend* be = nullptr;
     bool is_ok = false;
     GncSqlObjectBackend* obe = nullptr;
+    unsigned int done = 0;
+    unsigned int total = 0;
 };
 
 
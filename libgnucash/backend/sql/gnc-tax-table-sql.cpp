@@ -232,9 +232,10 @@ load_taxtable_entries (GncSqlBackend* sql_be, GncTaxTable* tt)
     memset (&value, 0, sizeof (GValue));
     g_value_init (&value, G_TYPE_STRING);
     g_value_set_string (&value, guid_buf);
-    buf = g_strdup_printf ("SELECT * FROM %s WHERE taxtable='%s'",
-                           TTENTRIES_TABLE_NAME, guid_buf);
-    auto stmt = sql_be->create_statement_from_sql (buf);
+    buf = g_strdup_printf ("SELECT * FROM %s WHERE taxtable=?",
+                           TTENTRIES_TABLE_NAME);
+    StrVec params{std::string{"'"} + guid_buf + "'"};
+    auto stmt = sql_be->create_statement_from_template (buf, params);
     g_free (buf);
     auto result = sql_be->execute_select_statement(stmt);
     for (auto row : *result)
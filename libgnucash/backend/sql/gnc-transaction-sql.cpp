@@ -47,8 +47,11 @@
 #include "splint-defs.h"
 #endif
 
+#include <algorithm>
+#include <map>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "escape.h"
 
@@ -244,10 +247,10 @@ load_single_split (GncSqlBackend* sql_be, GncSqlRow& row)
     }
     return pSplit;
 }
-static void
+static bool
 load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
 {
-    g_return_if_fail (sql_be != NULL);
+    g_return_val_if_fail (sql_be != NULL, false);
 
     const std::string spkey(split_col_table[0]->name());
     const std::string sskey(tx_guid_col_table[0]->name());
@@ -267,6 +270,8 @@ load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
     // Execute the query and load the splits
     auto stmt = sql_be->create_statement_from_sql(sql);
     auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return false;
 
     for (auto row : *result)
         load_single_split (sql_be, row);
@@ -274,6 +279,7 @@ load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
     sql += spkey + " FROM " SPLIT_TABLE " WHERE " + sskey + " IN " + selector;
     gnc_sql_slots_load_for_sql_subquery(sql_be, sql,
                                         (BookLookupFn)xaccSplitLookup);
+    return true;
 }
 
 static  Transaction*
@@ -332,11 +338,12 @@ typedef struct
  *
  * @param sql_be SQL backend
  * @param stmt SQL statement
+ * @return false if the database couldn't be read
  */
-static void
+static bool
 query_transactions (GncSqlBackend* sql_be, std::string selector)
 {
-    g_return_if_fail (sql_be != NULL);
+    g_return_val_if_fail (sql_be != NULL, false);
 
     const std::string tpkey(tx_col_table[0]->name());
     std::string sql("SELECT * FROM " TRANSACTION_TABLE);
@@ -347,10 +354,12 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
         sql += " WHERE " + selector;
     auto stmt = sql_be->create_statement_from_sql(sql);
     auto result = sql_be->execute_select_statement(stmt);
+    if (result == nullptr)
+        return false;
     if (result->begin() == result->end())
     {
         PINFO("Query %s returned no results", sql.c_str());
-        return;
+        return true;
     }
 
     Transaction* tx;
@@ -369,6 +378,7 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     }
 
     // Load all splits and slots for the transactions
+    auto ok = true;
     if (!instances.empty())
     {
         const std::string tpkey(tx_col_table[0]->name());
@@ -379,7 +389,7 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
             selector = tselector;
         }
 
-        load_splits_for_transactions (sql_be, selector);
+        ok = load_splits_for_transactions (sql_be, selector);
 
         if (selector.empty())
         {
@@ -396,6 +406,7 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     for (auto instance : instances)
          xaccTransCommitEdit(GNC_TRANSACTION(instance));
     xaccEnableDataScrubbing();
+    return ok;
 }
 
 
@@ -707,6 +718,178 @@ void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
     query_transactions (sql_be, sql);
 }
 
+static full_acct_balances_t
+get_account_balances (Account* acc)
+{
+    gnc_numeric* start;
+    gnc_numeric* start_cleared;
+    gnc_numeric* start_reconciled;
+
+    g_object_get (acc, "start-balance", &start,
+                  "start-cleared-balance", &start_cleared,
+                  "start-reconciled-balance", &start_reconciled, NULL);
+    full_acct_balances_t bal{acc,
+                             *start, xaccAccountGetBalance (acc),
+                             *start_cleared, xaccAccountGetClearedBalance (acc),
+                             *start_reconciled,
+                             xaccAccountGetReconciledBalance (acc)};
+    g_free (start);
+    g_free (start_cleared);
+    g_free (start_reconciled);
+    return bal;
+}
+
+/* Take whatever the newly loaded splits added to the ending balances back out
+ * of the starting balances.
+ */
+static void
+restore_account_balances (const full_acct_balances_t& bal)
+{
+    auto acc = bal.acc;
+    xaccAccountRecomputeBalance (acc);
+    auto end = xaccAccountGetBalance (acc);
+    auto end_cleared = xaccAccountGetClearedBalance (acc);
+    auto end_reconciled = xaccAccountGetReconciledBalance (acc);
+    if (gnc_numeric_equal (end, bal.end_bal) &&
+        gnc_numeric_equal (end_cleared, bal.end_cleared_bal) &&
+        gnc_numeric_equal (end_reconciled, bal.end_reconciled_bal))
+        return;
+
+    auto adjust = [](gnc_numeric start, gnc_numeric old_end, gnc_numeric new_end)
+    {
+        return gnc_numeric_sub_fixed (start, gnc_numeric_sub_fixed (new_end, old_end));
+    };
+    gnc_account_set_start_balance (acc, adjust (bal.start_bal, bal.end_bal, end));
+    gnc_account_set_start_cleared_balance (acc, adjust (bal.start_cleared_bal,
+                                                        bal.end_cleared_bal,
+                                                        end_cleared));
+    gnc_account_set_start_reconciled_balance (acc, adjust (bal.start_reconciled_bal,
+                                                           bal.end_reconciled_bal,
+                                                           end_reconciled));
+    xaccAccountRecomputeBalance (acc);
+}
+
+bool
+gnc_sql_transaction_load_tx_for_accounts (GncSqlBackend* sql_be,
+                                          const std::vector<Account*>& accounts,
+                                          time64 since)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+
+    const std::string tpkey(tx_col_table[0]->name());    //guid
+    const std::string stkey(split_col_table[1]->name()); //txn_guid
+    const std::string sakey(split_col_table[2]->name()); //account_guid
+    std::stringstream sql;
+    std::string date_cond;
+
+    if (since > MINTIME && since < MAXTIME)
+        date_cond = "post_date >= '" + GncDateTime(since).format_iso8601() + "'";
+
+    if (!accounts.empty())
+    {
+        sql << "(SELECT DISTINCT " << stkey << " FROM " SPLIT_TABLE " WHERE "
+            << sakey << " IN (";
+        for (auto acc : accounts)
+        {
+            if (acc != accounts.front())
+                sql << ",";
+            sql << "'" << gnc::GUID(*qof_instance_get_guid (acc)).to_string()
+                << "'";
+        }
+        sql << ")";
+        if (!date_cond.empty())
+            sql << " AND " << stkey << " IN (SELECT " << tpkey << " FROM "
+                TRANSACTION_TABLE " WHERE " << date_cond << ")";
+        sql << ")";
+    }
+    else
+        sql << date_cond;
+
+    auto coll = qof_book_get_collection (sql_be->book(), GNC_ID_ACCOUNT);
+    std::vector<full_acct_balances_t> balances;
+    balances.reserve (qof_collection_count (coll));
+    qof_collection_foreach (coll, [](QofInstance* inst, gpointer data)
+                            {
+                                auto bals = static_cast<std::vector<full_acct_balances_t>*>(data);
+                                bals->push_back (get_account_balances (GNC_ACCOUNT (inst)));
+                            }, &balances);
+
+    for (const auto& bal : balances)
+        xaccAccountBeginEdit (bal.acc);
+    auto ok = query_transactions (sql_be, sql.str());
+    for (const auto& bal : balances)
+        xaccAccountCommitEdit (bal.acc);
+    for (const auto& bal : balances)
+        restore_account_balances (bal);
+    return ok;
+}
+
+bool
+gnc_sql_transaction_query_scope (QofQuery* query, QofBook* book,
+                                 std::vector<Account*>& accounts,
+                                 time64& since)
+{
+    g_return_val_if_fail (query != NULL, false);
+
+    if (g_strcmp0 (qof_query_get_search_for (query), GNC_ID_SPLIT) != 0)
+        return false;
+
+    auto or_terms = qof_query_get_terms (query);
+    if (or_terms == nullptr)
+        return false;
+
+    since = INT64_MAX;
+    for (auto or_node = or_terms; or_node; or_node = g_list_next (or_node))
+    {
+        bool has_accounts = false;
+        time64 and_since = INT64_MIN;
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = g_list_next (and_node))
+        {
+            auto term = static_cast<QofQueryTerm*>(and_node->data);
+            auto path = qof_query_term_get_param_path (term);
+            auto pdata = qof_query_term_get_pred_data (term);
+            if (qof_query_term_is_inverted (term) || !path || !path->next)
+                continue;
+
+            auto first = static_cast<const char*>(path->data);
+            auto second = static_cast<const char*>(path->next->data);
+            if (g_strcmp0 (first, SPLIT_ACCOUNT) == 0 &&
+                g_strcmp0 (second, QOF_PARAM_GUID) == 0 &&
+                g_strcmp0 (pdata->type_name, QOF_TYPE_GUID) == 0)
+            {
+                auto pguid = reinterpret_cast<query_guid_t>(pdata);
+                if (pguid->options != QOF_GUID_MATCH_ANY)
+                    continue;
+                for (auto node = pguid->guids; node; node = g_list_next (node))
+                {
+                    auto acc = xaccAccountLookup (static_cast<GncGUID*>(node->data),
+                                                  book);
+                    if (acc && std::find (accounts.begin(), accounts.end(),
+                                          acc) == accounts.end())
+                        accounts.push_back (acc);
+                }
+                has_accounts = true;
+            }
+            else if (g_strcmp0 (first, SPLIT_TRANS) == 0 &&
+                     g_strcmp0 (second, TRANS_DATE_POSTED) == 0 &&
+                     g_strcmp0 (pdata->type_name, QOF_TYPE_DATE) == 0 &&
+                     (pdata->how == QOF_COMPARE_GTE ||
+                      pdata->how == QOF_COMPARE_GT ||
+                      pdata->how == QOF_COMPARE_EQUAL))
+            {
+                auto pdate = reinterpret_cast<query_date_t>(pdata);
+                if (pdate->options == QOF_DATE_MATCH_NORMAL)
+                    and_since = std::max (and_since, pdate->date);
+            }
+        }
+        if (!has_accounts)
+            return false;
+        since = std::min (since, and_since);
+    }
+    return true;
+}
+
 /**
  * Loads all transactions.  This might be used during a save-as operation to ensure that
  * all data is in memory and ready to be saved.
@@ -785,6 +968,82 @@ static const EntryVec acct_balances_col_table
                                          (QofSetterFunc)set_acct_bal_balance),
 };
 
+/* The amounts of one account's splits, and of those that are cleared and
+ * reconciled. */
+struct AccountAmounts
+{
+    std::vector<gnc_numeric> all;
+    std::vector<gnc_numeric> cleared;
+    std::vector<gnc_numeric> reconciled;
+};
+
+/* Amounts saved before their commodity's fraction changed have another
+ * denominator. Bringing them all to one lets them be added as plain
+ * integers. */
+static gnc_numeric
+sum_amounts (std::vector<gnc_numeric>& amounts)
+{
+    if (gnc_numeric_to_common_denom (amounts.data (), amounts.size (),
+                                     nullptr) != GNC_ERROR_OK)
+        return gnc_numeric_sum (amounts.data (), amounts.size (),
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    return gnc_numeric_sum (amounts.data (), amounts.size (), GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+}
+
+void
+gnc_sql_transaction_load_account_balances (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    std::map<Account*, AccountAmounts> amounts;
+    std::string sql("SELECT account_guid, reconcile_state, quantity_num, "
+                    "quantity_denom FROM " SPLIT_TABLE);
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return;
+
+    for (auto row : *result)
+    {
+        single_acct_balance_t bal{sql_be, nullptr, NREC, gnc_numeric_zero ()};
+        gnc_sql_load_object (sql_be, row, nullptr, &bal, acct_balances_col_table);
+        if (bal.acct == nullptr)
+            continue;
+
+        auto& acc_amounts = amounts[bal.acct];
+        acc_amounts.all.push_back (bal.balance);
+        if (bal.reconcile_state != NREC)
+            acc_amounts.cleared.push_back (bal.balance);
+        if (bal.reconcile_state == YREC || bal.reconcile_state == FREC)
+            acc_amounts.reconciled.push_back (bal.balance);
+    }
+
+    std::map<Account*, acct_balances_t> totals;
+    for (auto& [acc, acc_amounts] : amounts)
+        totals.emplace (acc, acct_balances_t{acc, sum_amounts (acc_amounts.all),
+                                             sum_amounts (acc_amounts.cleared),
+                                             sum_amounts (acc_amounts.reconciled)});
+    amounts.clear ();
+
+    /* Splits loaded along with other objects are already in the balances, so
+     * only the rest goes into the starting balances.
+     */
+    for (const auto& [acc, total] : totals)
+    {
+        xaccAccountRecomputeBalance (acc);
+        gnc_account_set_start_balance (acc,
+            gnc_numeric_sub_fixed (total.balance, xaccAccountGetBalance (acc)));
+        gnc_account_set_start_cleared_balance (acc,
+            gnc_numeric_sub_fixed (total.cleared_balance,
+                                   xaccAccountGetClearedBalance (acc)));
+        gnc_account_set_start_reconciled_balance (acc,
+            gnc_numeric_sub_fixed (total.reconciled_balance,
+                                   xaccAccountGetReconciledBalance (acc)));
+        xaccAccountRecomputeBalance (acc);
+    }
+}
+
 /* ----------------------------------------------------------------- */
 template<> void
 GncSqlColumnTableEntryImpl<CT_TXREF>::load (const GncSqlBackend* sql_be,
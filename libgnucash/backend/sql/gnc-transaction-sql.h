@@ -33,6 +33,8 @@
 #include "qof.h"
 #include "Account.h"
 
+#include <vector>
+
 class GncSqlTransBackend : public GncSqlObjectBackend
 {
 public:
@@ -59,6 +61,43 @@ public:
  */
 void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
                                               Account* account);
+
+/**
+ * Loads the transactions which have splits in any of a set of accounts and
+ * were posted on or after a date.  The starting balances of every account
+ * that gains splits are adjusted so that its ending balances don't change.
+ *
+ * @param sql_be SQL backend
+ * @param accounts Accounts, or an empty vector to load every transaction
+ * @param since Earliest post date, or INT64_MIN for no limit
+ * @return false if the database couldn't be read
+ */
+bool gnc_sql_transaction_load_tx_for_accounts (GncSqlBackend* sql_be,
+                                               const std::vector<Account*>& accounts,
+                                               time64 since);
+
+/**
+ * Sets the starting balances of every account so that its balances include
+ * the splits in the database that haven't been loaded yet.  The totals are
+ * computed without loading the splits.
+ *
+ * @param sql_be SQL backend
+ */
+void gnc_sql_transaction_load_account_balances (GncSqlBackend* sql_be);
+
+/**
+ * Finds the accounts and the earliest post date that a split query is limited
+ * to.
+ *
+ * @param query The query
+ * @param book The book searched by the query
+ * @param accounts Filled with the accounts the query matches splits in
+ * @param since Set to the earliest post date matched, INT64_MIN if unlimited
+ * @return false if the query can match splits in any account
+ */
+bool gnc_sql_transaction_query_scope (QofQuery* query, QofBook* book,
+                                      std::vector<Account*>& accounts,
+                                      time64& since);
 typedef struct
 {
     Account* acct;
@@ -100,6 +100,11 @@ public:
     GncSqlStatementPtr create_statement_from_sql (const std::string&)
         const noexcept override {
         return std::unique_ptr<GncMockSqlStatement>(new GncMockSqlStatement); }
+    GncSqlStatementPtr create_statement_from_template (const std::string& sql,
+                                                       const StrVec&)
+        noexcept override { return create_statement_from_sql (sql); }
+    GncSqlStatementCacheStats statement_cache_stats () const noexcept override {
+        return {}; }
     bool does_table_exist (const std::string&) const noexcept override {
         return true; }
     bool begin_transaction () noexcept override { return true;}
@@ -113,6 +118,7 @@ public:
         const noexcept override { return false; }
     virtual std::string quote_string (const std::string& str)
         const noexcept override { return std::string{str}; }
+    unsigned int max_insert_rows () const noexcept override { return 1; }
     int dberror() const noexcept override { return 0; }
     void set_error(QofBackendError error, unsigned int repeat, bool retry) noexcept override { return; }
     bool verify() noexcept override { return true; }
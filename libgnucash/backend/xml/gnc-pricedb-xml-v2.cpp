@@ -136,50 +136,19 @@ price_parse_xml_sub_node (GNCPrice* p, xmlNodePtr sub_node, QofBook* book)
     return TRUE;
 }
 
-static gboolean
-price_parse_xml_end_handler (gpointer data_for_children,
-                             GSList* data_from_children,
-                             GSList* sibling_data,
-                             gpointer parent_data,
-                             gpointer global_data,
-                             gpointer* result,
-                             const gchar* tag)
+GNCPrice*
+dom_tree_to_price (xmlNodePtr price_xml, QofBook* book)
 {
-    gboolean ok = TRUE;
-    xmlNodePtr price_xml = (xmlNodePtr) data_for_children;
     xmlNodePtr child;
     GNCPrice* p = NULL;
-    gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
-    QofBook* book = static_cast<decltype (book)> (gdata->bookdata);
-
-    /* we haven't been handed the *top* level node yet... */
-    if (parent_data) return TRUE;
-
-    *result = NULL;
 
-    if (!price_xml) return FALSE;
-    if (price_xml->next)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-    if (price_xml->prev)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
-    if (!price_xml->xmlChildrenNode)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
+    if (!price_xml) return NULL;
+    if (price_xml->next) return NULL;
+    if (price_xml->prev) return NULL;
+    if (!price_xml->xmlChildrenNode) return NULL;
 
     p = gnc_price_create (book);
-    if (!p)
-    {
-        ok = FALSE;
-        goto cleanup_and_exit;
-    }
+    if (!p) return NULL;
 
     for (child = price_xml->xmlChildrenNode; child; child = child->next)
     {
@@ -191,31 +160,185 @@ price_parse_xml_end_handler (gpointer data_for_children,
         case XML_ELEMENT_NODE:
             if (!price_parse_xml_sub_node (p, child, book))
             {
-                ok = FALSE;
-                goto cleanup_and_exit;
+                gnc_price_unref (p);
+                return NULL;
             }
             break;
         default:
             PERR ("Unknown node type (%d) while parsing gnc-price xml.", child->type);
-            child = NULL;
-            ok = FALSE;
-            goto cleanup_and_exit;
-            break;
+            gnc_price_unref (p);
+            return NULL;
         }
     }
+    return p;
+}
+
+/* Streaming parser for <price>.  Builds the price directly from the SAX
+   events, following dom_tree_to_price: unknown elements are ignored, a
+   bad commodity or id fails the price. */
+class PriceBuilder : public SixtpStreamBuilder
+{
+public:
+    PriceBuilder (QofBook* book);
+    ~PriceBuilder () override;
+    GNCPrice* finish ();
+
+protected:
+    gboolean element_start (int depth, const gchar* tag,
+                            gchar** attrs) override;
+    void element_end (int depth, const gchar* tag,
+                      const std::string& text) override;
+
+private:
+    QofBook* m_book;
+    GNCPrice* m_price;
+    gboolean m_ok = TRUE;
+    gboolean m_guid_ok = FALSE;
+    TimeRef m_time;
+    CommodityRef m_commodity;
+};
+
+PriceBuilder::PriceBuilder (QofBook* book) :
+    m_book{book}, m_price{gnc_price_create (book)}
+{
+    gnc_price_begin_edit (m_price);
+}
 
-cleanup_and_exit:
-    if (ok)
+PriceBuilder::~PriceBuilder ()
+{
+    if (m_price)
     {
-        *result = p;
+        gnc_price_commit_edit (m_price);
+        gnc_price_unref (m_price);
     }
-    else
+}
+
+gboolean
+PriceBuilder::element_start (int depth, const gchar* tag, gchar** attrs)
+{
+    if (depth == 1 && g_strcmp0 ("price:id", tag) == 0)
+        m_guid_ok = guid_attrs_ok (tag, attrs);
+    return FALSE;
+}
+
+void
+PriceBuilder::element_end (int depth, const gchar* tag, const std::string& text)
+{
+    if (!m_ok)
+        return;
+
+    if (depth == 2)
+    {
+        if (g_strcmp0 ("ts:date", tag) == 0)
+            m_time.add (text);
+        else
+            m_commodity.add (tag, text);
+        return;
+    }
+    if (depth != 1)
+        return;
+
+    if (g_strcmp0 ("price:id", tag) == 0)
+    {
+        if (m_guid_ok)
+        {
+            auto guid = text_to_guid (text);
+            gnc_price_set_guid (m_price, &guid);
+        }
+        else
+            m_ok = FALSE;
+    }
+    else if (g_strcmp0 ("price:commodity", tag) == 0 ||
+             g_strcmp0 ("price:currency", tag) == 0)
+    {
+        gnc_commodity* c = m_commodity.get (m_book);
+        if (!c)
+            m_ok = FALSE;
+        else if (g_strcmp0 ("price:commodity", tag) == 0)
+            gnc_price_set_commodity (m_price, c);
+        else
+            gnc_price_set_currency (m_price, c);
+    }
+    else if (g_strcmp0 ("price:time", tag) == 0)
+    {
+        gnc_price_set_time64 (m_price, m_time.get (tag));
+    }
+    else if (g_strcmp0 ("price:source", tag) == 0)
+    {
+        gnc_price_set_source_string (m_price, text.c_str ());
+    }
+    else if (g_strcmp0 ("price:type", tag) == 0)
+    {
+        gnc_price_set_typestr (m_price, text.c_str ());
+    }
+    else if (g_strcmp0 ("price:value", tag) == 0)
     {
-        *result = NULL;
-        gnc_price_unref (p);
+        gnc_price_set_value (m_price, text_to_gnc_numeric (text));
     }
-    xmlFreeNode (price_xml);
-    return ok;
+}
+
+GNCPrice*
+PriceBuilder::finish ()
+{
+    auto p = m_price;
+
+    if (!m_ok || !m_had_content)
+        return NULL;
+
+    m_price = NULL;
+    gnc_price_commit_edit (p);
+    return p;
+}
+
+static gboolean
+price_stream_start_handler (GSList* sibling_data, gpointer parent_data,
+                            gpointer global_data, gpointer* data_for_children,
+                            gpointer* result, const gchar* tag, gchar** attrs)
+{
+    gxpf_data* gdata = static_cast<decltype (gdata)> (global_data);
+
+    /* The parser is being used as the top level parser. */
+    if (!tag)
+        return TRUE;
+
+    *data_for_children =
+        new PriceBuilder (static_cast<QofBook*> (gdata->bookdata));
+    return TRUE;
+}
+
+static gboolean
+price_stream_end_handler (gpointer data_for_children,
+                          GSList* data_from_children,
+                          GSList* sibling_data,
+                          gpointer parent_data,
+                          gpointer global_data,
+                          gpointer* result,
+                          const gchar* tag)
+{
+    auto builder = static_cast<PriceBuilder*> (data_for_children);
+
+    if (!tag) return TRUE;
+
+    g_return_val_if_fail (builder, FALSE);
+
+    GNCPrice* p = builder->finish ();
+    delete builder;
+
+    *result = p;
+    return p != NULL;
+}
+
+static void
+price_stream_fail_handler (gpointer data_for_children,
+                           GSList* data_from_children,
+                           GSList* sibling_data,
+                           gpointer parent_data,
+                           gpointer global_data,
+                           gpointer* result,
+                           const gchar* tag)
+{
+    if (tag)
+        delete static_cast<PriceBuilder*> (data_for_children);
 }
 
 static void
@@ -227,9 +350,15 @@ cleanup_gnc_price (sixtp_child_result* result)
 static sixtp*
 gnc_price_parser_new (void)
 {
-    return sixtp_dom_parser_new (price_parse_xml_end_handler,
-                                 cleanup_gnc_price,
-                                 cleanup_gnc_price);
+    sixtp* parser = sixtp_stream_parser_new ("price",
+                                             price_stream_start_handler,
+                                             price_stream_end_handler,
+                                             price_stream_fail_handler);
+    if (!parser) return NULL;
+
+    sixtp_set_cleanup_result (parser, cleanup_gnc_price);
+    sixtp_set_result_fail (parser, cleanup_gnc_price);
+    return parser;
 }
 
 
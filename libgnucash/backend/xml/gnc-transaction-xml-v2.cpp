@@ -555,42 +555,6 @@ struct dom_tree_handler trn_dom_handlers[] =
     { NULL, NULL, 0, 0 },
 };
 
-static gboolean
-gnc_transaction_end_handler (gpointer data_for_children,
-                             GSList* data_from_children, GSList* sibling_data,
-                             gpointer parent_data, gpointer global_data,
-                             gpointer* result, const gchar* tag)
-{
-    Transaction* trn = NULL;
-    xmlNodePtr tree = (xmlNodePtr)data_for_children;
-    gxpf_data* gdata = (gxpf_data*)global_data;
-
-    if (parent_data)
-    {
-        return TRUE;
-    }
-
-    /* OK.  For some messed up reason this is getting called again with a
-       NULL tag.  So we ignore those cases */
-    if (!tag)
-    {
-        return TRUE;
-    }
-
-    g_return_val_if_fail (tree, FALSE);
-
-    trn = dom_tree_to_transaction (tree,
-                                   static_cast<QofBook*> (gdata->bookdata));
-    if (trn != NULL)
-    {
-        gdata->cb (tag, gdata->parsedata, trn);
-    }
-
-    xmlFreeNode (tree);
-
-    return trn != NULL;
-}
-
 Transaction*
 dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
 {
@@ -624,8 +588,420 @@ dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
     return trn;
 }
 
+/***********************************************************************/
+/* Streaming parser.  Builds the transaction and its splits directly from
+ * the SAX events, collecting a DOM tree only for the slots.  It follows the
+ * DOM conversion above: a missing required or an unknown element fails the
+ * split or transaction it is in, and the first bad split stops the rest
+ * being added. */
+
+enum
+{
+    TRN_ID = 1 << 0,
+    TRN_CURRENCY = 1 << 1,
+    TRN_NUM = 1 << 2,
+    TRN_DATE_POSTED = 1 << 3,
+    TRN_DATE_ENTERED = 1 << 4,
+    TRN_DESCRIPTION = 1 << 5,
+    TRN_SLOTS = 1 << 6,
+    TRN_SPLITS = 1 << 7,
+    TRN_REQUIRED = TRN_ID | TRN_DATE_POSTED | TRN_DATE_ENTERED | TRN_SPLITS,
+};
+
+enum
+{
+    SPL_ID = 1 << 0,
+    SPL_MEMO = 1 << 1,
+    SPL_ACTION = 1 << 2,
+    SPL_RECONCILED_STATE = 1 << 3,
+    SPL_RECONCILE_DATE = 1 << 4,
+    SPL_VALUE = 1 << 5,
+    SPL_QUANTITY = 1 << 6,
+    SPL_ACCOUNT = 1 << 7,
+    SPL_LOT = 1 << 8,
+    SPL_SLOTS = 1 << 9,
+    SPL_REQUIRED = SPL_ID | SPL_RECONCILED_STATE | SPL_VALUE | SPL_QUANTITY |
+                   SPL_ACCOUNT,
+};
+
+struct stream_tag
+{
+    const char* tag;
+    int field;
+};
+
+static const stream_tag trn_stream_tags[] =
+{
+    { "trn:id", TRN_ID },
+    { "trn:currency", TRN_CURRENCY },
+    { "trn:num", TRN_NUM },
+    { "trn:date-posted", TRN_DATE_POSTED },
+    { "trn:date-entered", TRN_DATE_ENTERED },
+    { "trn:description", TRN_DESCRIPTION },
+    { "trn:slots", TRN_SLOTS },
+    { "trn:splits", TRN_SPLITS },
+    { NULL, 0 },
+};
+
+static const stream_tag spl_stream_tags[] =
+{
+    { "split:id", SPL_ID },
+    { "split:memo", SPL_MEMO },
+    { "split:action", SPL_ACTION },
+    { "split:reconciled-state", SPL_RECONCILED_STATE },
+    { "split:reconcile-date", SPL_RECONCILE_DATE },
+    { "split:value", SPL_VALUE },
+    { "split:quantity", SPL_QUANTITY },
+    { "split:account", SPL_ACCOUNT },
+    { "split:lot", SPL_LOT },
+    { "split:slots", SPL_SLOTS },
+    { NULL, 0 },
+};
+
+static int
+stream_tag_field (const stream_tag* tags, const gchar* tag)
+{
+    for (; tags->tag; ++tags)
+        if (g_strcmp0 (tags->tag, tag) == 0)
+            return tags->field;
+
+    PERR ("Unhandled tag: %s", tag ? tag : "(null)");
+    return 0;
+}
+
+class TransactionBuilder : public SixtpStreamBuilder
+{
+public:
+    TransactionBuilder (QofBook* book);
+    ~TransactionBuilder () override;
+    Transaction* finish ();
+
+protected:
+    gboolean element_start (int depth, const gchar* tag,
+                            gchar** attrs) override;
+    void element_end (int depth, const gchar* tag,
+                      const std::string& text) override;
+    void tree_end (int depth, xmlNodePtr tree) override;
+
+private:
+    void split_end ();
+
+    QofBook* m_book;
+    Transaction* m_trans;
+    Split* m_split = NULL;
+    gboolean m_ok = TRUE;
+    gboolean m_split_ok = TRUE;
+    gboolean m_splits_done = FALSE;
+    int m_trn_seen = 0;
+    int m_spl_seen = 0;
+    int m_trn_field = 0;        /* the open child of <gnc:transaction> */
+    int m_spl_field = 0;        /* the open child of <trn:split> */
+    int m_skip_depth = 0;       /* ignore everything below this depth */
+    gboolean m_guid_ok = FALSE;
+    TimeRef m_time;
+    CommodityRef m_currency;
+};
+
+TransactionBuilder::TransactionBuilder (QofBook* book) :
+    m_book{book}, m_trans{xaccMallocTransaction (book)}
+{
+    xaccTransBeginEdit (m_trans);
+}
+
+TransactionBuilder::~TransactionBuilder ()
+{
+    if (m_split)
+        xaccSplitDestroy (m_split);
+    if (m_trans)
+    {
+        xaccTransDestroy (m_trans);
+        xaccTransCommitEdit (m_trans);
+    }
+}
+
+gboolean
+TransactionBuilder::element_start (int depth, const gchar* tag, gchar** attrs)
+{
+    if (m_skip_depth && depth > m_skip_depth)
+        return FALSE;
+    m_skip_depth = 0;
+
+    switch (depth)
+    {
+    case 1:
+        m_trn_field = stream_tag_field (trn_stream_tags, tag);
+        if (!m_trn_field)
+        {
+            m_ok = FALSE;
+            m_skip_depth = depth;
+        }
+        else if (m_trn_field == TRN_ID)
+            m_guid_ok = guid_attrs_ok (tag, attrs);
+        return m_trn_field == TRN_SLOTS;
+
+    case 2:
+        if (m_trn_field != TRN_SPLITS)
+            return FALSE;
+        if (m_splits_done || g_strcmp0 ("trn:split", tag) != 0)
+        {
+            m_splits_done = TRUE;
+            m_skip_depth = depth;
+            return FALSE;
+        }
+        m_split = xaccMallocSplit (m_book);
+        m_split_ok = TRUE;
+        m_spl_seen = 0;
+        return FALSE;
+
+    case 3:
+        if (m_trn_field != TRN_SPLITS)
+            return FALSE;
+        m_spl_field = stream_tag_field (spl_stream_tags, tag);
+        if (!m_spl_field)
+        {
+            m_split_ok = FALSE;
+            m_skip_depth = depth;
+        }
+        else if (m_spl_field & (SPL_ID | SPL_ACCOUNT | SPL_LOT))
+            m_guid_ok = guid_attrs_ok (tag, attrs);
+        return m_spl_field == SPL_SLOTS;
+
+    default:
+        return FALSE;
+    }
+}
+
+void
+TransactionBuilder::element_end (int depth, const gchar* tag,
+                                 const std::string& text)
+{
+    if (m_skip_depth && depth >= m_skip_depth)
+        return;
+
+    if (depth == 1)
+    {
+        switch (m_trn_field)
+        {
+        case TRN_ID:
+            if (m_guid_ok)
+            {
+                auto guid = text_to_guid (text);
+                xaccTransSetGUID (m_trans, &guid);
+            }
+            break;
+        case TRN_CURRENCY:
+            xaccTransSetCurrency (m_trans, m_currency.get (m_book));
+            break;
+        case TRN_NUM:
+            xaccTransSetNum (m_trans, text.c_str ());
+            break;
+        case TRN_DATE_POSTED:
+            xaccTransSetDatePostedSecs (m_trans, m_time.get (tag));
+            break;
+        case TRN_DATE_ENTERED:
+            xaccTransSetDateEnteredSecs (m_trans, m_time.get (tag));
+            break;
+        case TRN_DESCRIPTION:
+            xaccTransSetDescription (m_trans, text.c_str ());
+            break;
+        default:
+            break;
+        }
+        m_trn_seen |= m_trn_field;
+        m_trn_field = 0;
+    }
+    else if (depth == 2)
+    {
+        if (m_trn_field == TRN_CURRENCY)
+            m_currency.add (tag, text);
+        else if ((m_trn_field & (TRN_DATE_POSTED | TRN_DATE_ENTERED)) &&
+                 g_strcmp0 ("ts:date", tag) == 0)
+            m_time.add (text);
+        else if (m_trn_field == TRN_SPLITS && m_split)
+            split_end ();
+    }
+    else if (depth == 3 && m_split)
+    {
+        switch (m_spl_field)
+        {
+        case SPL_ID:
+            if (m_guid_ok)
+            {
+                auto guid = text_to_guid (text);
+                xaccSplitSetGUID (m_split, &guid);
+            }
+            break;
+        case SPL_MEMO:
+            xaccSplitSetMemo (m_split, text.c_str ());
+            break;
+        case SPL_ACTION:
+            xaccSplitSetAction (m_split, text.c_str ());
+            break;
+        case SPL_RECONCILED_STATE:
+            xaccSplitSetReconcile (m_split, text.c_str ()[0]);
+            break;
+        case SPL_RECONCILE_DATE:
+            xaccSplitSetDateReconciledSecs (m_split, m_time.get (tag));
+            break;
+        case SPL_VALUE:
+            xaccSplitSetValue (m_split, text_to_gnc_numeric (text));
+            break;
+        case SPL_QUANTITY:
+            xaccSplitSetAmount (m_split, text_to_gnc_numeric (text));
+            break;
+        case SPL_ACCOUNT:
+            if (m_guid_ok)
+            {
+                auto guid = text_to_guid (text);
+                auto account = xaccAccountLookup (&guid, m_book);
+                if (!account && gnc_transaction_xml_v2_testing &&
+                    !guid_equal (&guid, guid_null ()))
+                {
+                    account = xaccMallocAccount (m_book);
+                    xaccAccountSetGUID (account, &guid);
+                    xaccAccountSetCommoditySCU (account,
+                                                xaccSplitGetAmount (m_split).denom);
+                }
+                xaccAccountInsertSplit (account, m_split);
+            }
+            break;
+        case SPL_LOT:
+            if (m_guid_ok)
+            {
+                auto guid = text_to_guid (text);
+                auto lot = gnc_lot_lookup (&guid, m_book);
+                if (!lot && gnc_transaction_xml_v2_testing &&
+                    !guid_equal (&guid, guid_null ()))
+                {
+                    lot = gnc_lot_new (m_book);
+                    gnc_lot_set_guid (lot, guid);
+                }
+                gnc_lot_add_split (lot, m_split);
+            }
+            break;
+        default:
+            break;
+        }
+        m_spl_seen |= m_spl_field;
+        m_spl_field = 0;
+    }
+    else if (depth == 4 && m_spl_field == SPL_RECONCILE_DATE &&
+             g_strcmp0 ("ts:date", tag) == 0)
+    {
+        m_time.add (text);
+    }
+}
+
+void
+TransactionBuilder::tree_end (int depth, xmlNodePtr tree)
+{
+    QofInstance* inst = depth == 1 ? QOF_INSTANCE (m_trans) :
+                        QOF_INSTANCE (m_split);
+
+    if (!dom_tree_create_instance_slots (tree, inst))
+        PERR ("Unable to parse the slots of a %s",
+              depth == 1 ? "transaction" : "split");
+    if (depth == 1)
+        m_trn_seen |= TRN_SLOTS;
+    else
+        m_spl_seen |= SPL_SLOTS;
+}
+
+void
+TransactionBuilder::split_end ()
+{
+    if (m_split_ok && (m_spl_seen & SPL_REQUIRED) == SPL_REQUIRED)
+    {
+        xaccTransAppendSplit (m_trans, m_split);
+    }
+    else
+    {
+        char guidstr[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (xaccTransGetGUID (m_trans), guidstr);
+        PERR ("Unable to parse a split of transaction %s", guidstr);
+        xaccSplitDestroy (m_split);
+        m_splits_done = TRUE;
+    }
+    m_split = NULL;
+}
+
+Transaction*
+TransactionBuilder::finish ()
+{
+    auto trn = m_trans;
+
+    m_trans = NULL;
+    xaccTransCommitEdit (trn);
+
+    if (!m_ok || (m_trn_seen & TRN_REQUIRED) != TRN_REQUIRED)
+    {
+        char guidstr[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (xaccTransGetGUID (trn), guidstr);
+        PERR ("Unable to parse transaction %s", guidstr);
+        xaccTransBeginEdit (trn);
+        xaccTransDestroy (trn);
+        xaccTransCommitEdit (trn);
+        trn = NULL;
+    }
+    return trn;
+}
+
+static gboolean
+trn_stream_start_handler (GSList* sibling_data, gpointer parent_data,
+                          gpointer global_data, gpointer* data_for_children,
+                          gpointer* result, const gchar* tag, gchar** attrs)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+
+    /* The parser is being used as the top level parser. */
+    if (!tag)
+        return TRUE;
+
+    *data_for_children =
+        new TransactionBuilder (static_cast<QofBook*> (gdata->bookdata));
+    return TRUE;
+}
+
+static gboolean
+trn_stream_end_handler (gpointer data_for_children,
+                        GSList* data_from_children, GSList* sibling_data,
+                        gpointer parent_data, gpointer global_data,
+                        gpointer* result, const gchar* tag)
+{
+    auto builder = static_cast<TransactionBuilder*> (data_for_children);
+    gxpf_data* gdata = (gxpf_data*)global_data;
+
+    if (!tag)
+        return TRUE;
+
+    g_return_val_if_fail (builder, FALSE);
+
+    auto trn = builder->finish ();
+    delete builder;
+
+    if (trn != NULL)
+    {
+        gdata->cb (tag, gdata->parsedata, trn);
+    }
+
+    return trn != NULL;
+}
+
+static void
+trn_stream_fail_handler (gpointer data_for_children,
+                         GSList* data_from_children, GSList* sibling_data,
+                         gpointer parent_data, gpointer global_data,
+                         gpointer* result, const gchar* tag)
+{
+    if (tag)
+        delete static_cast<TransactionBuilder*> (data_for_children);
+}
+
 sixtp*
 gnc_transaction_sixtp_parser_create (void)
 {
-    return sixtp_dom_parser_new (gnc_transaction_end_handler, NULL, NULL);
+    return sixtp_stream_parser_new ("gnc:transaction",
+                                    trn_stream_start_handler,
+                                    trn_stream_end_handler,
+                                    trn_stream_fail_handler);
 }
@@ -33,6 +33,8 @@
 #endif
 
 #include <gnc-engine.h> //for GNC_MOD_BACKEND
+#include <Split.h>
+#include <Transaction.h>
 #include <gnc-uri-utils.h>
 #include <TransLog.h>
 #include <gnc-prefs.h>
@@ -147,6 +149,7 @@ GncXmlBackend::session_begin(QofSession* session, const char* new_uri,
      * Let's start logging */
     xaccLogSetBaseName (m_fullpath.c_str());
     PINFO ("logpath=%s", m_fullpath.empty() ? "(null)" : m_fullpath.c_str());
+    m_journal = m_fullpath + ".journal";
 
     if (mode == SESSION_READ_ONLY)
         return; // Read-only, don't care about locks.
@@ -194,6 +197,11 @@ GncXmlBackend::session_end()
     m_fullpath.clear();
     m_lockfile.clear();
     m_linkfile.clear();
+    m_journal.clear();
+    m_journal_base.clear();
+    m_data_stamp.clear();
+    m_journal_trans.clear();
+    m_journal_saves = 0;
 }
 
 static QofBookFileType
@@ -249,6 +257,8 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
             PWARN ("Syntax error in Xml File %s", m_fullpath.c_str());
             error = ERR_FILEIO_PARSE_ERROR;
         }
+        else
+            error = replay_journal ();
         break;
 
     case GNC_BOOK_XML2_FILE_NO_ENCODING:
@@ -319,17 +329,173 @@ GncXmlBackend::sync(QofBook* book)
         return;
     }
 
-    write_to_file (true);
+    if (write_journal ())
+        return;
+
+    if (write_to_file (true))
+        reset_journal ();
     remove_old_files();
 }
 
 void
 GncXmlBackend::commit(QofInstance* instance)
 {
+    if (!m_journal_base.empty() &&
+        (qof_instance_is_dirty(instance) || qof_instance_get_destroying(instance)))
+    {
+        /* Only transactions can be journaled; anything else needs the whole
+         * file rewritten at the next save. */
+        Transaction* trans = nullptr;
+        if (GNC_IS_TRANSACTION(instance))
+            trans = GNC_TRANSACTION(instance);
+        else if (GNC_IS_SPLIT(instance))
+            trans = xaccSplitGetParent(GNC_SPLIT(instance));
+
+        if (trans)
+        {
+            char guid_str[GUID_ENCODING_LENGTH + 1];
+            guid_to_string_buff (qof_instance_get_guid (trans), guid_str);
+            m_journal_trans.insert (guid_str);
+        }
+        else if (!GNC_IS_SPLIT(instance))
+            m_journal_base.clear();
+    }
+
     if (qof_instance_is_dirty(instance))
         qof_instance_mark_clean(instance);
 }
 
+/* A digest of the data file's contents.  The journal records it so that it
+ * is only ever applied to the file it was written against, wherever that has
+ * been copied to. */
+std::string
+GncXmlBackend::data_file_id()
+{
+    auto in = g_fopen (m_fullpath.c_str(), "rb");
+    if (!in)
+        return {};
+
+    auto checksum = g_checksum_new (G_CHECKSUM_SHA256);
+    guchar buf[65536];
+    size_t len;
+    while ((len = fread (buf, 1, sizeof (buf), in)) > 0)
+        g_checksum_update (checksum, buf, len);
+
+    std::string id;
+    if (!ferror (in))
+        id = std::string{"sha256:"} + g_checksum_get_string (checksum);
+    g_checksum_free (checksum);
+    fclose (in);
+    return id;
+}
+
+/* The size and modification time of the data file, which change whenever
+ * it is rewritten, by us or anyone else. */
+std::string
+GncXmlBackend::data_file_stamp()
+{
+    GStatBuf statbuf;
+    if (g_stat (m_fullpath.c_str(), &statbuf) != 0)
+        return {};
+
+    std::ostringstream stamp;
+    stamp << statbuf.st_size << ':' << statbuf.st_mtime;
+    return stamp.str();
+}
+
+QofBackendError
+GncXmlBackend::replay_journal()
+{
+    m_journal_trans.clear();
+    m_journal_saves = 0;
+    m_data_stamp = data_file_stamp();
+    m_journal_base.clear();
+
+    auto have_journal = g_file_test (m_journal.c_str(), G_FILE_TEST_EXISTS);
+    if (!have_journal && gnc_prefs_get_file_journal_saves () <= 0)
+        return ERR_BACKEND_NO_ERR;
+
+    auto base = data_file_id();
+    if (!have_journal)
+    {
+        m_journal_base = base;
+        return ERR_BACKEND_NO_ERR;
+    }
+
+    /* Replaying commits the journaled transactions, which must not put
+     * them into m_journal_trans: base is only set once it's done. */
+    auto entries = gnc_xml_journal_replay (m_book, m_journal.c_str(), base);
+    m_journal_trans.clear();
+    if (entries >= 0)
+    {
+        m_journal_saves = entries;
+        m_journal_base = base;
+        return ERR_BACKEND_NO_ERR;
+    }
+
+    /* Keep it out of the way of the next save but don't throw it away. */
+    auto rejected = m_journal + ".rejected";
+    PWARN ("Moving journal %s aside to %s", m_journal.c_str(), rejected.c_str());
+    g_rename (m_journal.c_str(), rejected.c_str());
+
+    /* A journal that failed part way has left the book half replayed, so
+     * only a rejected one leaves the book matching the data file. */
+    if (entries != GNC_XML_JOURNAL_FAILED)
+        m_journal_base = base;
+    return entries == GNC_XML_JOURNAL_FAILED ? ERR_FILEIO_PARSE_ERROR
+           : ERR_FILEIO_JOURNAL_REJECTED;
+}
+
+/* Appends the transactions changed since the last save to the journal.
+ * Returns false if the data file has to be rewritten instead. */
+bool
+GncXmlBackend::write_journal()
+{
+    auto max_saves = gnc_prefs_get_file_journal_saves ();
+    if (max_saves <= 0 || m_journal_base.empty() ||
+        m_journal_saves >= max_saves || m_data_stamp != data_file_stamp())
+        return false;
+
+    /* Compact once the journal outgrows the data file. */
+    GStatBuf journal_stat, data_stat;
+    if (g_stat (m_journal.c_str(), &journal_stat) == 0 &&
+        g_stat (m_fullpath.c_str(), &data_stat) == 0 &&
+        journal_stat.st_size > data_stat.st_size)
+        return false;
+
+    if (!m_journal_trans.empty())
+    {
+        if (!gnc_xml_journal_append (m_book, m_journal.c_str(),
+                                     m_journal_trans, m_journal_base))
+        {
+            PWARN ("Unable to append to journal %s, saving the whole file",
+                   m_journal.c_str());
+            return false;
+        }
+        ++m_journal_saves;
+        m_journal_trans.clear();
+    }
+
+    qof_book_mark_session_saved (m_book);
+    return true;
+}
+
+/* After a full save the journal is obsolete. */
+void
+GncXmlBackend::reset_journal()
+{
+    if (g_unlink (m_journal.c_str()) != 0 && errno != ENOENT)
+        PWARN ("Unable to remove journal %s: %s", m_journal.c_str(),
+               g_strerror (errno) ? g_strerror (errno) : "");
+    if (gnc_prefs_get_file_journal_saves () > 0)
+        m_journal_base = data_file_id();
+    else
+        m_journal_base.clear();
+    m_data_stamp = data_file_stamp();
+    m_journal_trans.clear();
+    m_journal_saves = 0;
+}
+
 bool
 GncXmlBackend::save_may_clobber_data()
 {
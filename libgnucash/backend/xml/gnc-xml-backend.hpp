@@ -20,6 +20,7 @@
 
 #include <qof.h>
 
+#include <set>
 #include <string>
 #include <qof-backend.hpp>
 
@@ -53,11 +54,26 @@ private:
     void remove_old_files();
     void write_accounts(QofBook* book);
     bool check_path(const char* fullpath, bool create);
+    std::string data_file_id();
+    std::string data_file_stamp();
+    QofBackendError replay_journal();
+    bool write_journal();
+    void reset_journal();
 
     std::string m_dirname;
     std::string m_lockfile;
     std::string m_linkfile;
     int m_lockfd = -1;
+    std::string m_journal;
+    /* Identifies the data file the journal applies to; empty when the
+     * next save must rewrite the data file. */
+    std::string m_journal_base;
+    /* The data file's stamp when it was last read or written, to notice
+     * anyone else rewriting it. */
+    std::string m_data_stamp;
+    /* GUIDs of the transactions committed since the last save. */
+    std::set<std::string> m_journal_trans;
+    int m_journal_saves = 0;
 
     QofBook* m_book = nullptr;  /* The primary, main open book */
 };
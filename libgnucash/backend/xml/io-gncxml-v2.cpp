@@ -45,8 +45,14 @@
 #include <zlib.h>
 #include <errno.h>
 
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "gnc-engine.h"
 #include "gnc-pricedb-p.h"
+#include "gnc-prefs.h"
 #include "Scrub.h"
 #include "SX-book.h"
 #include "SX-book-p.h"
@@ -81,6 +87,7 @@ typedef struct
     gchar* filename;
     gchar* perms;
     gboolean write;
+    gint threads;
 } gz_thread_params_t;
 
 /* Callback structure */
@@ -362,6 +369,16 @@ counter (const GncXmlDataType_t& data, file_backend* be_data)
     /* XXX: should we do anything with this counter? */
 }
 
+/* Size a collection's table for the number of objects the file says it
+ * holds, so that it doesn't rehash over and over while they're loaded. */
+static void
+reserve_collection (QofBook* book, QofIdType type, gint64 count)
+{
+    if (count > 0 && count <= G_MAXUINT)
+        qof_collection_reserve (qof_book_get_collection (book, type),
+                                static_cast<guint>(count));
+}
+
 static gboolean
 gnc_counter_end_handler (gpointer data_for_children,
                          GSList* data_from_children, GSList* sibling_data,
@@ -401,10 +418,14 @@ gnc_counter_end_handler (gpointer data_for_children,
     else if (g_strcmp0 (type, "transaction") == 0)
     {
         sixdata->counter.transactions_total = val;
+        reserve_collection (sixdata->book, GNC_ID_TRANS, val);
+        /* Nearly every transaction has at least two splits. */
+        reserve_collection (sixdata->book, GNC_ID_SPLIT, 2 * val);
     }
     else if (g_strcmp0 (type, "account") == 0)
     {
         sixdata->counter.accounts_total = val;
+        reserve_collection (sixdata->book, GNC_ID_ACCOUNT, val);
     }
     else if (g_strcmp0 (type, "book") == 0)
     {
@@ -425,6 +446,7 @@ gnc_counter_end_handler (gpointer data_for_children,
     else if (g_strcmp0 (type, "price") == 0)
     {
         sixdata->counter.prices_total = val;
+        reserve_collection (sixdata->book, GNC_ID_PRICE, val);
     }
     else
     {
@@ -677,6 +699,435 @@ gnc_sixtp_gdv2_new (
     return gd;
 }
 
+/* Parallel loading.
+ *
+ * The engine isn't thread safe, so turning XML into books, accounts and
+ * transactions has to stay on the main thread.  What can be farmed out is
+ * the libxml2 work of building the DOM trees for the transactions and
+ * prices, which make up nearly all of a large file.  A structural pass cuts
+ * each top-level <gnc:transaction> and each <price> in the pricedb out of
+ * the file and leaves an empty placeholder element behind.  A pool of
+ * workers parses the cut out elements into DOM trees in file order, while
+ * the main thread runs the usual sixtp parse over what is left.  The
+ * parsers for those elements are swapped for ones that take the next
+ * prebuilt tree and convert it, so the objects are created and handed to
+ * the book in exactly the order a serial load would.
+ */
+static const char* PRICE_TAG = "price";
+
+/* Bound on how many prebuilt trees may wait for the main thread. */
+static const std::size_t PREPARSED_MAX_AHEAD = 4096;
+
+struct PreparsedChunk
+{
+    std::string_view text;
+    const char* tag;
+    xmlNodePtr tree;
+    bool done;
+};
+
+class PreparsedQueue
+{
+public:
+    PreparsedQueue (std::vector<PreparsedChunk>&& chunks, guint n_threads);
+    ~PreparsedQueue ();
+    xmlNodePtr take (const char* tag);
+
+private:
+    static gpointer worker_func (PreparsedQueue* queue);
+    void work ();
+
+    std::vector<PreparsedChunk> m_chunks;
+    std::size_t m_claimed = 0;
+    std::size_t m_taken = 0;
+    bool m_stop = false;
+    GMutex m_mutex;
+    GCond m_cond;
+    std::vector<GThread*> m_workers;
+};
+
+struct gxpf_preparsed_data : gxpf_data
+{
+    PreparsedQueue* queue;
+};
+
+static gboolean
+preparsed_tree_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    if (parent_data || !tag)
+        return TRUE;
+
+    *static_cast<xmlNodePtr*> (global_data) =
+        static_cast<xmlNodePtr> (data_for_children);
+    return TRUE;
+}
+
+PreparsedQueue::PreparsedQueue (std::vector<PreparsedChunk>&& chunks,
+                                guint n_threads) :
+    m_chunks{std::move (chunks)}
+{
+    g_mutex_init (&m_mutex);
+    g_cond_init (&m_cond);
+    xmlInitParser ();
+    for (guint i = 0; i < n_threads; ++i)
+        m_workers.push_back (g_thread_new ("xml_load_worker",
+                                           (GThreadFunc) worker_func, this));
+}
+
+PreparsedQueue::~PreparsedQueue ()
+{
+    g_mutex_lock (&m_mutex);
+    m_stop = true;
+    g_cond_broadcast (&m_cond);
+    g_mutex_unlock (&m_mutex);
+
+    for (auto thread : m_workers)
+        g_thread_join (thread);
+
+    for (auto& chunk : m_chunks)
+        if (chunk.tree)
+            xmlFreeNode (chunk.tree);
+
+    g_cond_clear (&m_cond);
+    g_mutex_clear (&m_mutex);
+}
+
+gpointer
+PreparsedQueue::worker_func (PreparsedQueue* queue)
+{
+    queue->work ();
+    return nullptr;
+}
+
+void
+PreparsedQueue::work ()
+{
+    auto top_parser = sixtp_add_some_sub_parsers (
+        sixtp_new (), TRUE,
+        TRANSACTION_TAG, sixtp_dom_parser_new (preparsed_tree_end_handler,
+                                               NULL, NULL),
+        PRICE_TAG, sixtp_dom_parser_new (preparsed_tree_end_handler,
+                                         NULL, NULL),
+        NULL, NULL);
+
+    g_mutex_lock (&m_mutex);
+    while (!m_stop && m_claimed < m_chunks.size ())
+    {
+        if (m_claimed >= m_taken + PREPARSED_MAX_AHEAD)
+        {
+            g_cond_wait (&m_cond, &m_mutex);
+            continue;
+        }
+        auto& chunk = m_chunks[m_claimed++];
+        g_mutex_unlock (&m_mutex);
+
+        xmlNodePtr tree = NULL;
+        if (top_parser &&
+            !sixtp_parse_buffer (top_parser, const_cast<char*> (chunk.text.data ()),
+                                 static_cast<int> (chunk.text.size ()),
+                                 NULL, &tree, NULL) &&
+            tree)
+        {
+            xmlFreeNode (tree);
+            tree = NULL;
+        }
+
+        g_mutex_lock (&m_mutex);
+        chunk.tree = tree;
+        chunk.done = true;
+        g_cond_broadcast (&m_cond);
+    }
+    g_mutex_unlock (&m_mutex);
+
+    if (top_parser)
+        sixtp_destroy (top_parser);
+}
+
+xmlNodePtr
+PreparsedQueue::take (const char* tag)
+{
+    g_mutex_lock (&m_mutex);
+    if (m_taken >= m_chunks.size ())
+    {
+        g_mutex_unlock (&m_mutex);
+        PERR ("No prebuilt tree left for <%s>", tag);
+        return NULL;
+    }
+
+    auto index = m_taken++;
+    auto& chunk = m_chunks[index];
+    while (!chunk.done)
+        g_cond_wait (&m_cond, &m_mutex);
+    g_cond_broadcast (&m_cond);
+    auto tree = chunk.tree;
+    chunk.tree = NULL;
+    g_mutex_unlock (&m_mutex);
+
+    if (g_strcmp0 (chunk.tag, tag) != 0)
+    {
+        PERR ("Prebuilt tree is a <%s>, expected <%s>", chunk.tag, tag);
+        if (tree)
+            xmlFreeNode (tree);
+        return NULL;
+    }
+    if (!tree)
+        PERR ("Unable to parse <%s> number %" G_GSIZE_FORMAT, tag, index);
+    return tree;
+}
+
+/* Start handler for a placeholder: rather than parsing the element, hand
+ * over the tree a worker built for it. */
+static gboolean
+preparsed_start_handler (GSList* sibling_data, gpointer parent_data,
+                         gpointer global_data, gpointer* data_for_children,
+                         gpointer* result, const gchar* tag, gchar** attrs)
+{
+    auto gpdata = static_cast<gxpf_preparsed_data*> (global_data);
+    auto tree = gpdata->queue->take (tag);
+
+    *data_for_children = tree;
+    return tree != NULL;
+}
+
+static gboolean
+preparsed_transaction_end_handler (gpointer data_for_children,
+                                   GSList* data_from_children,
+                                   GSList* sibling_data, gpointer parent_data,
+                                   gpointer global_data, gpointer* result,
+                                   const gchar* tag)
+{
+    auto tree = static_cast<xmlNodePtr> (data_for_children);
+    auto gdata = static_cast<gxpf_data*> (global_data);
+
+    g_return_val_if_fail (tree, FALSE);
+
+    auto trn = dom_tree_to_transaction (tree,
+                                        static_cast<QofBook*> (gdata->bookdata));
+    if (trn)
+        gdata->cb (tag, gdata->parsedata, trn);
+
+    xmlFreeNode (tree);
+    return trn != NULL;
+}
+
+static gboolean
+preparsed_price_end_handler (gpointer data_for_children,
+                             GSList* data_from_children,
+                             GSList* sibling_data, gpointer parent_data,
+                             gpointer global_data, gpointer* result,
+                             const gchar* tag)
+{
+    auto tree = static_cast<xmlNodePtr> (data_for_children);
+    auto gdata = static_cast<gxpf_data*> (global_data);
+
+    g_return_val_if_fail (tree, FALSE);
+
+    auto p = dom_tree_to_price (tree, static_cast<QofBook*> (gdata->bookdata));
+    *result = p;
+
+    xmlFreeNode (tree);
+    return p != NULL;
+}
+
+static void
+preparsed_price_cleanup (sixtp_child_result* result)
+{
+    if (result->data) gnc_price_unref ((GNCPrice*) result->data);
+}
+
+static void
+replace_sub_parser (sixtp* parser, const char* tag, sixtp* sub_parser)
+{
+    gpointer old_tag, old_parser;
+
+    if (g_hash_table_lookup_extended (parser->child_parsers, tag,
+                                      &old_tag, &old_parser))
+    {
+        g_hash_table_remove (parser->child_parsers, tag);
+        g_free (old_tag);
+        sixtp_destroy (static_cast<sixtp*> (old_parser));
+    }
+    sixtp_add_sub_parser (parser, tag, sub_parser);
+}
+
+/* The streaming transaction and price parsers can't take a tree, so swap
+ * them for ones that convert the prebuilt trees. */
+static void
+use_preparsed_trees (sixtp* parser)
+{
+    auto db_parser = static_cast<sixtp*> (
+        g_hash_table_lookup (parser->child_parsers, PRICEDB_TAG));
+
+    if (g_hash_table_lookup (parser->child_parsers, TRANSACTION_TAG))
+        replace_sub_parser (parser, TRANSACTION_TAG,
+                            sixtp_set_any (sixtp_new (), FALSE,
+                                           SIXTP_START_HANDLER_ID, preparsed_start_handler,
+                                           SIXTP_END_HANDLER_ID, preparsed_transaction_end_handler,
+                                           SIXTP_NO_MORE_HANDLERS));
+    if (db_parser)
+        replace_sub_parser (db_parser, PRICE_TAG,
+                            sixtp_set_any (sixtp_new (), FALSE,
+                                           SIXTP_START_HANDLER_ID, preparsed_start_handler,
+                                           SIXTP_END_HANDLER_ID, preparsed_price_end_handler,
+                                           SIXTP_CLEANUP_RESULT_ID, preparsed_price_cleanup,
+                                           SIXTP_RESULT_FAIL_ID, preparsed_price_cleanup,
+                                           SIXTP_NO_MORE_HANDLERS));
+}
+
+/* The chunks are parsed without the XML declaration, so they'd be read as
+ * UTF-8 whatever the file says. */
+static bool
+is_utf8_document (std::string_view buf)
+{
+    if (buf.compare (0, 5, "<?xml") != 0)
+        return true;
+
+    auto decl = buf.substr (0, buf.find ("?>"));
+    auto enc = decl.find ("encoding=");
+    if (enc == std::string_view::npos)
+        return true;
+
+    auto value = decl.substr (enc + strlen ("encoding=") + 1);
+    return g_ascii_strncasecmp (value.data (), "utf-8", 5) == 0 ||
+           g_ascii_strncasecmp (value.data (), "utf8", 4) == 0;
+}
+
+/* The structural pass.  Copies @buf to @skeleton, replacing each top-level
+ * transaction and each price with an empty element, and records the
+ * elements it cut out in @chunks.  Comments, CDATA sections and DTDs can
+ * hide markup from this simple scan, so it gives up on any of them. */
+static bool
+split_preparsed_chunks (std::string_view buf, std::string& skeleton,
+                        std::vector<PreparsedChunk>& chunks)
+{
+    constexpr auto npos = std::string_view::npos;
+    bool in_template = false, in_pricedb = false;
+    std::size_t copied = 0, pos = 0;
+
+    if (!is_utf8_document (buf))
+        return false;
+
+    while ((pos = buf.find ('<', pos)) != npos)
+    {
+        if (pos + 1 >= buf.size () || buf[pos + 1] == '!')
+            return false;
+        if (buf[pos + 1] == '?')
+        {
+            pos += 2;
+            continue;
+        }
+
+        auto tag_end = buf.find ('>', pos);
+        if (tag_end == npos)
+            return false;
+
+        bool closing = buf[pos + 1] == '/';
+        auto name_start = pos + (closing ? 2 : 1);
+        auto name_end = buf.find_first_of (" \t\r\n/>", name_start);
+        auto name = buf.substr (name_start, name_end - name_start);
+        bool empty = buf[tag_end - 1] == '/';
+
+        const char* tag = nullptr;
+        if (closing || empty)
+        {
+            if (name == TEMPLATE_TRANSACTION_TAG)
+                in_template = false;
+            else if (name == PRICEDB_TAG)
+                in_pricedb = false;
+        }
+        if (!closing)
+        {
+            if (name == TRANSACTION_TAG && !in_template)
+                tag = TRANSACTION_TAG;
+            else if (name == PRICE_TAG && in_pricedb)
+                tag = PRICE_TAG;
+            else if (!empty && name == TEMPLATE_TRANSACTION_TAG)
+                in_template = true;
+            else if (!empty && name == PRICEDB_TAG)
+                in_pricedb = true;
+        }
+        if (!tag)
+        {
+            pos = tag_end + 1;
+            continue;
+        }
+
+        auto end = tag_end + 1;
+        if (!empty)
+        {
+            std::string close_tag{"</"};
+            close_tag.append (tag).append (">");
+            auto close_pos = buf.find (close_tag, end);
+            if (close_pos == npos)
+                return false;
+            end = close_pos + close_tag.size ();
+        }
+
+        skeleton.append (buf.substr (copied, pos - copied));
+        skeleton.append ("<").append (tag).append ("/>");
+        chunks.push_back ({buf.substr (pos, end - pos), tag, NULL, false});
+        copied = pos = end;
+    }
+    skeleton.append (buf.substr (copied));
+    return true;
+}
+
+static std::string
+read_whole_file (FILE* file)
+{
+    std::string buf;
+    char block[65536];
+    std::size_t len;
+
+    while ((len = fread (block, 1, sizeof (block), file)) > 0)
+        buf.append (block, len);
+    if (ferror (file))
+        PWARN ("Error reading XML file");
+    return buf;
+}
+
+static gboolean
+gnc_xml_parse_fd_parallel (sixtp* top_parser, sixtp* main_parser,
+                           sixtp* book_parser, FILE* file, guint n_threads,
+                           gxpf_callback callback, gpointer parsedata,
+                           gpointer bookdata)
+{
+    gxpf_preparsed_data gpdata;
+    gpointer parse_result = NULL;
+    std::string skeleton;
+    std::vector<PreparsedChunk> chunks;
+    gboolean retval;
+
+    gpdata.cb = callback;
+    gpdata.parsedata = parsedata;
+    gpdata.bookdata = bookdata;
+    gpdata.queue = nullptr;
+
+    auto buf = read_whole_file (file);
+    if (!split_preparsed_chunks (buf, skeleton, chunks) || chunks.empty ())
+    {
+        PINFO ("Parsing on a single thread");
+        return sixtp_parse_buffer (top_parser, buf.data (),
+                                   static_cast<int> (buf.size ()),
+                                   NULL, &gpdata, &parse_result);
+    }
+
+    PINFO ("Parsing %" G_GSIZE_FORMAT " objects on %u threads",
+           chunks.size (), n_threads);
+    use_preparsed_trees (main_parser);
+    use_preparsed_trees (book_parser);
+
+    PreparsedQueue queue{std::move (chunks), n_threads};
+    gpdata.queue = &queue;
+    retval = sixtp_parse_buffer (top_parser, skeleton.data (),
+                                 static_cast<int> (skeleton.size ()),
+                                 NULL, &gpdata, &parse_result);
+    return retval;
+}
+
 static gboolean
 qof_session_load_from_xml_file_v2_full (
     GncXmlBackend* xml_be, QofBook* book,
@@ -692,6 +1143,7 @@ qof_session_load_from_xml_file_v2_full (
     struct file_backend be_data;
     gboolean retval;
     char* v2type = NULL;
+    guint n_threads;
 
     gd = gnc_sixtp_gdv2_new (book, FALSE, file_rw_feedback,
                              xml_be->get_percentage());
@@ -791,8 +1243,18 @@ qof_session_load_from_xml_file_v2_full (
         }
         else
         {
-            retval = gnc_xml_parse_fd (top_parser, file,
-                                       generic_callback, gd, book);
+            if (gnc_prefs_get_file_load_threads () > 0)
+                n_threads = gnc_prefs_get_file_load_threads ();
+            else
+                n_threads = g_get_num_processors ();
+
+            if (n_threads > 1)
+                retval = gnc_xml_parse_fd_parallel (top_parser, main_parser,
+                                                    book_parser, file, n_threads,
+                                                    generic_callback, gd, book);
+            else
+                retval = gnc_xml_parse_fd (top_parser, file,
+                                           generic_callback, gd, book);
             fclose (file);
             if (thread)
                 g_thread_join (thread);
@@ -1477,10 +1939,422 @@ gz_thread_read (gzFile file, gz_thread_params_t* params)
     return success;
 }
 
-/* Compress or decompress function that is to be run in a separate thread.
- * Returns 1 on success or 0 otherwise, stuffed into a pointer type. */
-static gpointer
-gz_thread_func (gz_thread_params_t* params)
+/* Block gzip.
+ *
+ * With more than one compression thread the data is cut into GZ_BLOCK_SIZE
+ * pieces and each is deflated on its own into a complete gzip member, so
+ * the pieces can be compressed concurrently.  gzread reads concatenated
+ * members as a single stream, so older versions open these files as usual.
+ * Every member carries a "GC" extra field holding its compressed length,
+ * which lets a reader find the following member without inflating this one
+ * and hand members to several threads.
+ */
+constexpr size_t GZ_BLOCK_SIZE{256 * 1024};
+constexpr size_t GZ_FIXED_HEADER_LEN{10};
+constexpr size_t GZ_HEADER_LEN{GZ_FIXED_HEADER_LEN + 2 + 4 + 4};
+constexpr size_t GZ_TRAILER_LEN{8};
+constexpr guchar GZ_FLAG_EXTRA{0x04};
+constexpr guchar GZ_OS_UNKNOWN{0xff};
+
+static inline void
+put_le32 (guchar* buf, guint32 val)
+{
+    buf[0] = val & 0xff;
+    buf[1] = (val >> 8) & 0xff;
+    buf[2] = (val >> 16) & 0xff;
+    buf[3] = (val >> 24) & 0xff;
+}
+
+static inline guint32
+get_le32 (const guchar* buf)
+{
+    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((guint32)buf[3] << 24);
+}
+
+/* Returns the length of the member whose header is in buf, or 0 if it isn't
+ * a header written by gz_deflate_block.  No member of GZ_BLOCK_SIZE bytes
+ * deflates to more than compressBound of that. */
+static size_t
+gz_block_member_len (const guchar* buf)
+{
+    if (buf[0] != 037 || buf[1] != 0213 || buf[2] != Z_DEFLATED ||
+        buf[3] != GZ_FLAG_EXTRA ||
+        buf[10] != 8 || buf[11] != 0 ||
+        buf[12] != 'G' || buf[13] != 'C' || buf[14] != 4 || buf[15] != 0)
+        return 0;
+
+    auto len = get_le32 (buf + 16);
+    if (len < GZ_HEADER_LEN + GZ_TRAILER_LEN ||
+        len > GZ_HEADER_LEN + compressBound (GZ_BLOCK_SIZE) + GZ_TRAILER_LEN)
+        return 0;
+    return len;
+}
+
+static bool
+gz_deflate_block (const std::string& in, std::string& out)
+{
+    z_stream strm{};
+
+    if (deflateInit2 (&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                      Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    auto bound = deflateBound (&strm, in.size ());
+    out.resize (GZ_HEADER_LEN + bound + GZ_TRAILER_LEN);
+    auto buf = reinterpret_cast<guchar*> (&out[0]);
+
+    strm.next_in = reinterpret_cast<Bytef*> (const_cast<char*> (in.data ()));
+    strm.avail_in = in.size ();
+    strm.next_out = buf + GZ_HEADER_LEN;
+    strm.avail_out = bound;
+    auto ret = deflate (&strm, Z_FINISH);
+    auto deflated = strm.total_out;
+    deflateEnd (&strm);
+    if (ret != Z_STREAM_END)
+        return false;
+
+    auto len = GZ_HEADER_LEN + deflated + GZ_TRAILER_LEN;
+    memset (buf, 0, GZ_HEADER_LEN);
+    buf[0] = 037;
+    buf[1] = 0213;
+    buf[2] = Z_DEFLATED;
+    buf[3] = GZ_FLAG_EXTRA;
+    buf[9] = GZ_OS_UNKNOWN;
+    buf[10] = 8;                /* XLEN */
+    buf[12] = 'G';
+    buf[13] = 'C';
+    buf[14] = 4;                /* subfield length */
+    put_le32 (buf + 16, len);
+
+    auto trailer = buf + GZ_HEADER_LEN + deflated;
+    put_le32 (trailer, crc32 (0, reinterpret_cast<const Bytef*> (in.data ()),
+                              in.size ()));
+    put_le32 (trailer + 4, in.size ());
+    out.resize (len);
+    return true;
+}
+
+static bool
+gz_inflate_block (const std::string& in, std::string& out)
+{
+    auto buf = reinterpret_cast<const guchar*> (in.data ());
+    auto trailer = buf + in.size () - GZ_TRAILER_LEN;
+    auto size = get_le32 (trailer + 4);
+    z_stream strm{};
+
+    /* The writer never puts more than a block in a member, so a larger
+     * size is damage and mustn't be allocated. */
+    if (size > GZ_BLOCK_SIZE)
+        return false;
+    if (inflateInit2 (&strm, -MAX_WBITS) != Z_OK)
+        return false;
+
+    out.resize (size);
+    strm.next_in = const_cast<Bytef*> (buf + GZ_HEADER_LEN);
+    strm.avail_in = in.size () - GZ_HEADER_LEN - GZ_TRAILER_LEN;
+    strm.next_out = reinterpret_cast<Bytef*> (&out[0]);
+    strm.avail_out = out.size ();
+    auto ret = inflate (&strm, Z_FINISH);
+    auto inflated = strm.total_out;
+    inflateEnd (&strm);
+
+    return ret == Z_STREAM_END && inflated == out.size () &&
+           crc32 (0, reinterpret_cast<const Bytef*> (out.data ()), out.size ()) ==
+           get_le32 (trailer);
+}
+
+/* Runs a block transform on a pool of threads.  Blocks are pushed and
+ * popped in the same order; at most max_pending are held at once. */
+class GzBlockPool
+{
+public:
+    using Transform = bool (*) (const std::string& in, std::string& out);
+
+    GzBlockPool (Transform transform, int n_threads);
+    ~GzBlockPool ();
+    GzBlockPool (const GzBlockPool&) = delete;
+    GzBlockPool& operator= (const GzBlockPool&) = delete;
+
+    bool full () const { return m_blocks.size () >= m_max_pending; }
+    bool empty () const { return m_blocks.empty (); }
+    void push (std::string&& in);
+    /* Waits for the oldest block; returns false if its transform failed. */
+    bool pop (std::string& out);
+
+private:
+    struct Block
+    {
+        std::string in;
+        std::string out;
+        bool done;
+        bool ok;
+    };
+
+    static gpointer worker (gpointer data);
+    void work ();
+
+    Transform m_transform;
+    std::deque<Block> m_blocks;
+    size_t m_popped = 0;
+    size_t m_next = 0;
+    size_t m_max_pending;
+    bool m_stop = false;
+    GMutex m_mutex;
+    GCond m_cond;
+    std::vector<GThread*> m_threads;
+};
+
+GzBlockPool::GzBlockPool (Transform transform, int n_threads) :
+    m_transform{transform}, m_max_pending{2 * static_cast<size_t> (n_threads)}
+{
+    g_mutex_init (&m_mutex);
+    g_cond_init (&m_cond);
+    for (int i = 0; i < n_threads; ++i)
+        m_threads.push_back (g_thread_new ("xml_gz_worker", worker, this));
+}
+
+GzBlockPool::~GzBlockPool ()
+{
+    g_mutex_lock (&m_mutex);
+    m_stop = true;
+    g_cond_broadcast (&m_cond);
+    g_mutex_unlock (&m_mutex);
+
+    for (auto thread : m_threads)
+        g_thread_join (thread);
+    g_cond_clear (&m_cond);
+    g_mutex_clear (&m_mutex);
+}
+
+gpointer
+GzBlockPool::worker (gpointer data)
+{
+    static_cast<GzBlockPool*> (data)->work ();
+    return nullptr;
+}
+
+void
+GzBlockPool::work ()
+{
+    g_mutex_lock (&m_mutex);
+    while (true)
+    {
+        while (!m_stop && m_next == m_popped + m_blocks.size ())
+            g_cond_wait (&m_cond, &m_mutex);
+        if (m_stop)
+            break;
+
+        /* Deque references stay valid across push_back and pop_front, and
+         * the block isn't popped before it is done. */
+        auto& block = m_blocks[m_next++ - m_popped];
+        g_mutex_unlock (&m_mutex);
+
+        auto ok = m_transform (block.in, block.out);
+
+        g_mutex_lock (&m_mutex);
+        block.ok = ok;
+        block.done = true;
+        g_cond_broadcast (&m_cond);
+    }
+    g_mutex_unlock (&m_mutex);
+}
+
+void
+GzBlockPool::push (std::string&& in)
+{
+    g_mutex_lock (&m_mutex);
+    m_blocks.push_back ({std::move (in), {}, false, false});
+    g_cond_broadcast (&m_cond);
+    g_mutex_unlock (&m_mutex);
+}
+
+bool
+GzBlockPool::pop (std::string& out)
+{
+    g_mutex_lock (&m_mutex);
+    auto& block = m_blocks.front ();
+    while (!block.done)
+        g_cond_wait (&m_cond, &m_mutex);
+    auto ok = block.ok;
+    out = std::move (block.out);
+    m_blocks.pop_front ();
+    ++m_popped;
+    g_mutex_unlock (&m_mutex);
+    return ok;
+}
+
+/* Reads up to len bytes from the pipe, returning fewer only at its end. */
+static gssize
+read_pipe_block (gint fd, std::string& buf, size_t len)
+{
+    buf.resize (len);
+    size_t got = 0;
+    while (got < len)
+    {
+        auto bytes = read (fd, &buf[got], len - got);
+        if (bytes < 0)
+            return -1;
+        if (bytes == 0)
+            break;
+        got += bytes;
+    }
+    buf.resize (got);
+    return got;
+}
+
+static bool
+gz_block_write_file (GzBlockPool& pool, FILE* file,
+                     gz_thread_params_t* params, bool drain)
+{
+    std::string block;
+
+    while (pool.full () || (drain && !pool.empty ()))
+    {
+        if (!pool.pop (block))
+        {
+            g_warning ("Could not compress a block of '%s'", params->filename);
+            return false;
+        }
+        if (fwrite (block.data (), 1, block.size (), file) != block.size ())
+        {
+            g_warning ("Could not write the compressed file '%s'. The error is: '%s' (%d)",
+                       params->filename, g_strerror (errno), errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+gz_block_thread_write (FILE* file, gz_thread_params_t* params)
+{
+    GzBlockPool pool{gz_deflate_block, params->threads};
+    std::string block;
+    bool first = true;
+
+    while (true)
+    {
+        auto bytes = read_pipe_block (params->fd, block, GZ_BLOCK_SIZE);
+        if (bytes < 0)
+        {
+            g_warning ("Could not read from pipe. The error is '%s' (errno %d)",
+                       g_strerror (errno) ? g_strerror (errno) : "", errno);
+            return false;
+        }
+        /* An empty file still needs one member to be a valid gzip file. */
+        if (bytes > 0 || first)
+            pool.push (std::move (block));
+        first = false;
+
+        auto last = static_cast<size_t> (bytes) < GZ_BLOCK_SIZE;
+        if (!gz_block_write_file (pool, file, params, last))
+            return false;
+        if (last)
+            return true;
+    }
+}
+
+static bool
+gz_block_write_pipe (GzBlockPool& pool, gz_thread_params_t* params, bool drain)
+{
+    std::string block;
+
+    while (pool.full () || (drain && !pool.empty ()))
+    {
+        if (!pool.pop (block))
+        {
+            g_warning ("Could not uncompress a block of '%s'", params->filename);
+            return false;
+        }
+        if (WRITE_FN (params->fd, block.data (), block.size ()) < 0)
+        {
+            g_warning ("Could not write to pipe. The error is '%s' (%d)",
+                       g_strerror (errno) ? g_strerror (errno) : "", errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+gz_block_thread_read (FILE* file, gz_thread_params_t* params)
+{
+    GzBlockPool pool{gz_inflate_block, params->threads};
+    std::string block;
+    guchar header[GZ_HEADER_LEN];
+
+    while (true)
+    {
+        auto got = fread (header, 1, GZ_HEADER_LEN, file);
+        if (got == 0 && feof (file))
+            break;
+
+        auto len = got == GZ_HEADER_LEN ? gz_block_member_len (header) : 0;
+        if (!len)
+        {
+            g_warning ("Could not read from compressed file '%s': damaged block header",
+                       params->filename);
+            return false;
+        }
+        block.assign (reinterpret_cast<char*> (header), GZ_HEADER_LEN);
+        block.resize (len);
+        if (fread (&block[GZ_HEADER_LEN], 1, len - GZ_HEADER_LEN, file) !=
+            len - GZ_HEADER_LEN)
+        {
+            g_warning ("Could not read from compressed file '%s': truncated block",
+                       params->filename);
+            return false;
+        }
+
+        pool.push (std::move (block));
+        if (!gz_block_write_pipe (pool, params, false))
+            return false;
+    }
+    return gz_block_write_pipe (pool, params, true);
+}
+
+/* Handles params with the block format.  Returns false, leaving success
+ * alone, when reading a file that isn't in it. */
+static bool
+gz_block_thread_func (gz_thread_params_t* params, bool& success)
+{
+    auto file = g_fopen (params->filename, params->write ? "wb" : "rb");
+    if (!file)
+    {
+        g_warning ("Child threads fopen failed");
+        success = false;
+        return true;
+    }
+
+    if (params->write)
+    {
+        success = gz_block_thread_write (file, params);
+    }
+    else
+    {
+        guchar header[GZ_HEADER_LEN];
+        auto is_blocks = fread (header, 1, GZ_HEADER_LEN, file) == GZ_HEADER_LEN &&
+                         gz_block_member_len (header);
+        if (!is_blocks)
+        {
+            fclose (file);
+            return false;
+        }
+        rewind (file);
+        success = gz_block_thread_read (file, params);
+    }
+
+    if (fclose (file))
+    {
+        g_warning ("Could not close the compressed file '%s' (errno %d)",
+                   params->filename, errno);
+        success = false;
+    }
+    return true;
+}
+
+static bool
+gz_stream_thread_func (gz_thread_params_t* params)
 {
     gint gzval;
     bool success = true;
@@ -1490,8 +2364,7 @@ gz_thread_func (gz_thread_params_t* params)
     if (!file)
     {
         g_warning ("Child threads gzopen failed");
-        success = 0;
-        goto cleanup_gz_thread_func;
+        return false;
     }
 
     if (params->write)
@@ -1509,8 +2382,19 @@ gz_thread_func (gz_thread_params_t* params)
                    params->filename, gzval);
         success = false;
     }
+    return success;
+}
+
+/* Compress or decompress function that is to be run in a separate thread.
+ * Returns 1 on success or 0 otherwise, stuffed into a pointer type. */
+static gpointer
+gz_thread_func (gz_thread_params_t* params)
+{
+    bool success = true;
+
+    if (params->threads <= 1 || !gz_block_thread_func (params, success))
+        success = gz_stream_thread_func (params);
 
-cleanup_gz_thread_func:
     close (params->fd);
     g_free (params->filename);
     g_free (params->perms);
@@ -1564,6 +2448,9 @@ try_gz_open (const char* filename, const char* perms, gboolean compress,
         params->filename = g_strdup (filename);
         params->perms = g_strdup (perms);
         params->write = write;
+        params->threads = gnc_prefs_get_file_compression_threads ();
+        if (params->threads <= 0)
+            params->threads = g_get_num_processors ();
 
         auto thread = g_thread_new ("xml_thread", (GThreadFunc) gz_thread_func,
                                     params);
@@ -1620,6 +2507,228 @@ gnc_book_write_to_xml_file_v2 (QofBook* book, const char* filename,
     return success;
 }
 
+/* The journal of incremental saves.
+ *
+ * It starts with the opening tag of a JOURNAL_TAG document and each save
+ * appends one complete JOURNAL_ENTRY_TAG element, so it is never closed on
+ * disk; the reader drops anything after the last complete entry and closes
+ * it.  An entry holds whole <gnc:transaction> elements, which replace the
+ * transaction with that GUID, and JOURNAL_DELETE_TAG elements.
+ */
+#define JOURNAL_TAG "gnc-journal"
+#define JOURNAL_ENTRY_TAG "gnc:journal-entry"
+#define JOURNAL_DELETE_TAG "gnc:journal-delete"
+
+static gboolean
+write_journal_header (FILE* out, const std::string& base)
+{
+    return fprintf (out, "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n") >= 0
+           && fprintf (out, "<" JOURNAL_TAG " base=\"%s\"", base.c_str ()) >= 0
+           && gnc_xml2_write_namespace_decl (out, "gnc")
+           && gnc_xml2_write_namespace_decl (out, "cmdty")
+           && gnc_xml2_write_namespace_decl (out, "slot")
+           && gnc_xml2_write_namespace_decl (out, "split")
+           && gnc_xml2_write_namespace_decl (out, "trn")
+           && gnc_xml2_write_namespace_decl (out, "ts")
+           && fprintf (out, ">\n") >= 0;
+}
+
+gboolean
+gnc_xml_journal_append (QofBook* book, const char* filename,
+                        const std::set<std::string>& transactions,
+                        const std::string& base)
+{
+    GStatBuf statbuf;
+    auto is_new = g_stat (filename, &statbuf) != 0;
+
+    auto out = g_fopen (filename, "a");
+    if (!out)
+        return FALSE;
+
+    auto success = (!is_new || write_journal_header (out, base))
+                   && fprintf (out, "<" JOURNAL_ENTRY_TAG ">\n") >= 0;
+
+    for (auto& guid_str : transactions)
+    {
+        GncGUID guid;
+        if (!success || !string_to_guid (guid_str.c_str (), &guid))
+            continue;
+
+        auto trans = xaccTransLookup (&guid, book);
+        if (trans && !qof_instance_get_destroying (trans))
+        {
+            auto node = gnc_transaction_dom_tree_create (trans);
+            xmlElemDump (out, NULL, node);
+            xmlFreeNode (node);
+            success = !ferror (out) && fprintf (out, "\n") >= 0;
+        }
+        else
+        {
+            success = fprintf (out, "<" JOURNAL_DELETE_TAG " type=\"guid\">%s</"
+                               JOURNAL_DELETE_TAG ">\n", guid_str.c_str ()) >= 0;
+        }
+    }
+
+    success = success && fprintf (out, "</" JOURNAL_ENTRY_TAG ">\n") >= 0;
+    if (fclose (out))
+        success = FALSE;
+    return success;
+}
+
+static void
+journal_destroy_transaction (QofBook* book, const GncGUID* guid)
+{
+    auto trans = xaccTransLookup (guid, book);
+    if (!trans)
+        return;
+
+    /* Unlike xaccTransDestroy this doesn't spare read-only transactions; the
+     * journal records what was actually saved. */
+    xaccTransBeginEdit (trans);
+    qof_instance_set_destroying (trans, TRUE);
+    xaccTransCommitEdit (trans);
+}
+
+static GncGUID*
+journal_transaction_guid (xmlNodePtr node)
+{
+    for (auto child = node->xmlChildrenNode; child; child = child->next)
+        if (g_strcmp0 ((char*)child->name, "trn:id") == 0)
+            return dom_tree_to_guid (child);
+    return NULL;
+}
+
+/* Only checks the entry and keeps it; nothing is applied to the book until
+ * the whole journal has been read. */
+static gboolean
+journal_entry_end_handler (gpointer data_for_children,
+                           GSList* data_from_children, GSList* sibling_data,
+                           gpointer parent_data, gpointer global_data,
+                           gpointer* result, const gchar* tag)
+{
+    auto tree = static_cast<xmlNodePtr> (data_for_children);
+    auto entries = static_cast<std::vector<xmlNodePtr>*> (global_data);
+    gboolean successful = TRUE;
+
+    if (parent_data || !tag)
+        return TRUE;
+
+    g_return_val_if_fail (tree, FALSE);
+
+    for (auto node = tree->xmlChildrenNode; node && successful; node = node->next)
+    {
+        auto name = reinterpret_cast<const char*> (node->name);
+        GncGUID* guid = NULL;
+
+        if (node->type != XML_ELEMENT_NODE)
+            continue;
+        if (g_strcmp0 (name, TRANSACTION_TAG) == 0)
+            guid = journal_transaction_guid (node);
+        else if (g_strcmp0 (name, JOURNAL_DELETE_TAG) == 0)
+            guid = dom_tree_to_guid (node);
+        successful = guid != NULL;
+        guid_free (guid);
+    }
+
+    if (successful)
+        entries->push_back (tree);
+    else
+        xmlFreeNode (tree);
+    return successful;
+}
+
+static gboolean
+journal_apply_entry (QofBook* book, xmlNodePtr tree)
+{
+    for (auto node = tree->xmlChildrenNode; node; node = node->next)
+    {
+        auto name = reinterpret_cast<const char*> (node->name);
+        auto is_trans = g_strcmp0 (name, TRANSACTION_TAG) == 0;
+
+        if (node->type != XML_ELEMENT_NODE)
+            continue;
+
+        auto guid = is_trans ? journal_transaction_guid (node)
+                    : dom_tree_to_guid (node);
+        journal_destroy_transaction (book, guid);
+        guid_free (guid);
+        if (is_trans && !dom_tree_to_transaction (node, book))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+gint
+gnc_xml_journal_replay (QofBook* book, const char* filename,
+                        const std::string& base)
+{
+    static const std::string entry_end{"</" JOURNAL_ENTRY_TAG ">"};
+    gchar* contents;
+    gsize length;
+
+    if (!g_file_get_contents (filename, &contents, &length, NULL))
+    {
+        PWARN ("Unable to read journal %s", filename);
+        return GNC_XML_JOURNAL_REJECTED;
+    }
+
+    std::string text{contents, length};
+    g_free (contents);
+
+    auto header_end = text.find ('>', text.find ("<" JOURNAL_TAG));
+    auto base_attr = "base=\"" + base + "\"";
+    if (base.empty () || header_end == std::string::npos ||
+        text.rfind (base_attr, header_end) == std::string::npos)
+    {
+        PWARN ("Journal %s doesn't belong to the current data file", filename);
+        return GNC_XML_JOURNAL_REJECTED;
+    }
+
+    /* A save interrupted while appending leaves a partial entry at the end. */
+    auto last = text.rfind (entry_end);
+    text.resize (last == std::string::npos ? header_end + 1 : last + entry_end.size ());
+    text += "\n</" JOURNAL_TAG ">\n";
+
+    auto top_parser = sixtp_add_some_sub_parsers (
+        sixtp_new (), TRUE,
+        JOURNAL_TAG, sixtp_add_some_sub_parsers (
+            sixtp_new (), TRUE,
+            JOURNAL_ENTRY_TAG, sixtp_dom_parser_new (journal_entry_end_handler,
+                                                     NULL, NULL),
+            NULL, NULL),
+        NULL, NULL);
+    if (!top_parser)
+        return GNC_XML_JOURNAL_REJECTED;
+
+    std::vector<xmlNodePtr> entries;
+    auto success = sixtp_parse_buffer (top_parser, &text[0],
+                                       static_cast<int> (text.size ()),
+                                       NULL, &entries, NULL);
+    sixtp_destroy (top_parser);
+
+    if (!success)
+    {
+        PWARN ("Unable to read journal %s", filename);
+        for (auto tree : entries)
+            xmlFreeNode (tree);
+        return GNC_XML_JOURNAL_REJECTED;
+    }
+
+    gint applied = 0;
+    for (auto tree : entries)
+    {
+        if (success && journal_apply_entry (book, tree))
+            ++applied;
+        else if (success)
+        {
+            PWARN ("Unable to apply entry %d of journal %s", applied + 1, filename);
+            success = FALSE;
+        }
+        xmlFreeNode (tree);
+    }
+    return success ? applied : GNC_XML_JOURNAL_FAILED;
+}
+
 /*
  * Have to pass in the backend as this routine needs the temporary
  * backend for file export, not the real backend which could be
@@ -38,6 +38,8 @@
 #ifdef __cplusplus
 #include "gnc-backend-xml.h"
 #include "sixtp.h"
+#include <set>
+#include <string>
 #include <vector>
 
 class GncXmlBackend;
@@ -90,6 +92,30 @@ gboolean gnc_book_write_to_xml_filehandle_v2 (QofBook* book, FILE* fh);
 gboolean gnc_book_write_to_xml_file_v2 (QofBook* book, const char* filename,
                                         gboolean compress);
 
+/** Append one entry to the journal of incremental saves in filename,
+ * creating it if it doesn't exist.  The entry holds the current state of
+ * each of the transactions whose GUID strings are given, or a deletion for
+ * those that no longer exist.  base identifies the data file the journal
+ * applies to.
+ */
+gboolean gnc_xml_journal_append (QofBook* book, const char* filename,
+                                 const std::set<std::string>& transactions,
+                                 const std::string& base);
+
+/** The journal can't be read or is for another data file; the book hasn't
+ * been changed. */
+#define GNC_XML_JOURNAL_REJECTED -1
+/** Applying the journal failed part way; the book has to be discarded. */
+#define GNC_XML_JOURNAL_FAILED -2
+
+/** Apply the journal in filename to a book freshly loaded from the data
+ * file identified by base.  The whole journal is read and checked before the
+ * book is changed.  Returns the number of entries applied,
+ * GNC_XML_JOURNAL_REJECTED or GNC_XML_JOURNAL_FAILED.
+ */
+gint gnc_xml_journal_replay (QofBook* book, const char* filename,
+                             const std::string& base);
+
 /** write just the commodities and accounts to a file */
 gboolean gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* be,
                                                        QofBook* book, FILE* fh);
@@ -25,6 +25,8 @@
 #ifndef SIXTP_PARSERS_H
 #define SIXTP_PARSERS_H
 
+#include <string>
+
 #include "sixtp.h"
 
 /* Create a parser that will turn the entire sub-tree into a DOM tree
@@ -35,4 +37,82 @@ sixtp* sixtp_dom_parser_new (sixtp_end_handler ender,
                              sixtp_result_handler cleanup_result_by_default_func,
                              sixtp_result_handler cleanup_result_on_fail_func);
 
+/* Base class for building an object straight from the SAX events of an
+   element and its children, without making a DOM tree of it first.
+
+   The start handler of the top element creates the builder and stores it
+   in *data_for_children; the parser made by sixtp_stream_parser_new then
+   feeds every element below it to the builder.  Elements for which
+   element_start returns TRUE are collected into a DOM tree and handed to
+   tree_end instead, which suits rare and deeply nested content like slots.
+   The end handler of the top element finishes and deletes the builder, the
+   fail handler just deletes it.
+*/
+class SixtpStreamBuilder
+{
+public:
+    virtual ~SixtpStreamBuilder ();
+    void start (const gchar* tag, gchar** attrs);
+    void characters (const char* text, int len);
+    void end (const gchar* tag);
+
+protected:
+    /* depth is 1 for the children of the top element. */
+    virtual gboolean element_start (int depth, const gchar* tag,
+                                    gchar** attrs) = 0;
+    /* text is the character content of the element. */
+    virtual void element_end (int depth, const gchar* tag,
+                              const std::string& text) = 0;
+    /* The tree is freed when this returns. */
+    virtual void tree_end (int depth, xmlNodePtr tree) {}
+
+    /* The streaming equivalents of dom_tree_to_guid, dom_tree_to_gnc_numeric,
+       dom_tree_to_time64 and dom_tree_to_commodity_ref. */
+    static gboolean guid_attrs_ok (const gchar* tag, gchar** attrs);
+    static GncGUID text_to_guid (const std::string& text);
+    static gnc_numeric text_to_gnc_numeric (const std::string& text);
+
+    /* Collects the <ts:date> child of a date element. */
+    class TimeRef
+    {
+    public:
+        void add (const std::string& text);
+        time64 get (const gchar* tag);
+    private:
+        int m_seen = 0;
+        time64 m_time = INT64_MAX;
+    };
+
+    /* Collects the <cmdty:space> and <cmdty:id> children of a commodity
+       reference and looks the commodity up. */
+    class CommodityRef
+    {
+    public:
+        ~CommodityRef () { clear (); }
+        void add (const gchar* tag, const std::string& text);
+        gnc_commodity* get (QofBook* book);
+    private:
+        void clear ();
+        gchar* m_space = NULL;
+        gchar* m_id = NULL;
+        gboolean m_duplicate = FALSE;
+    };
+
+    /* TRUE once the top element has any character or element content. */
+    gboolean m_had_content = FALSE;
+
+private:
+    int m_depth = 0;
+    std::string m_text;
+    xmlNodePtr m_tree = NULL;
+    int m_tree_depth = 0;
+};
+
+/* Create a parser for elements named tag that are built by a
+   SixtpStreamBuilder made in starter. */
+sixtp* sixtp_stream_parser_new (const gchar* tag,
+                                sixtp_start_handler starter,
+                                sixtp_end_handler ender,
+                                sixtp_fail_handler failer);
+
 #endif /* _SIXTP_PARSERS_H_ */
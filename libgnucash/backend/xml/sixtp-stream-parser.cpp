@@ -0,0 +1,293 @@
+/********************************************************************
+ * sixtp-stream-parser.cpp                                          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ ********************************************************************/
+#include <config.h>
+
+#include <glib.h>
+#include <string.h>
+
+#include "gnc-commodity.h"
+
+#include "sixtp-dom-parsers.h"
+#include "sixtp-parsers.h"
+#include "sixtp-utils.h"
+#include "sixtp.h"
+
+static QofLogModule log_module = GNC_MOD_IO;
+
+void
+SixtpStreamBuilder::start (const gchar* tag, gchar** attrs)
+{
+    ++m_depth;
+    m_text.clear ();
+
+    if (m_tree)
+    {
+        m_tree = xmlNewChild (m_tree, NULL, BAD_CAST tag, NULL);
+    }
+    else if (element_start (m_depth, tag, attrs))
+    {
+        m_tree = xmlNewNode (NULL, BAD_CAST tag);
+        m_tree_depth = m_depth;
+    }
+    else
+    {
+        return;
+    }
+
+    for (auto attr = attrs; attr && *attr; attr += 2)
+        xmlSetProp (m_tree, BAD_CAST attr[0], BAD_CAST attr[1]);
+}
+
+void
+SixtpStreamBuilder::characters (const char* text, int len)
+{
+    if (len <= 0)
+        return;
+
+    m_had_content = TRUE;
+    if (m_tree)
+        xmlNodeAddContentLen (m_tree, BAD_CAST text, len);
+    else
+        m_text.append (text, len);
+}
+
+void
+SixtpStreamBuilder::end (const gchar* tag)
+{
+    if (m_tree && m_depth > m_tree_depth)
+    {
+        m_tree = m_tree->parent;
+    }
+    else if (m_tree)
+    {
+        tree_end (m_depth, m_tree);
+        xmlFreeNode (m_tree);
+        m_tree = NULL;
+    }
+    else
+    {
+        element_end (m_depth, tag, m_text);
+    }
+
+    m_had_content = TRUE;
+    m_text.clear ();
+    --m_depth;
+}
+
+SixtpStreamBuilder::~SixtpStreamBuilder ()
+{
+    if (!m_tree)
+        return;
+
+    while (m_tree->parent)
+        m_tree = m_tree->parent;
+    xmlFreeNode (m_tree);
+}
+
+gboolean
+SixtpStreamBuilder::guid_attrs_ok (const gchar* tag, gchar** attrs)
+{
+    if (!attrs || !attrs[0])
+        return FALSE;
+
+    if (strcmp (attrs[0], "type") != 0)
+    {
+        PERR ("Unknown attribute for id tag: %s", attrs[0]);
+        return FALSE;
+    }
+
+    /* handle new and guid the same for the moment */
+    if (g_strcmp0 ("guid", attrs[1]) != 0 && g_strcmp0 ("new", attrs[1]) != 0)
+    {
+        PERR ("Unknown type %s for attribute type for tag %s",
+              attrs[1] ? attrs[1] : "(null)", tag);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+GncGUID
+SixtpStreamBuilder::text_to_guid (const std::string& text)
+{
+    GncGUID guid;
+    if (!string_to_guid (text.c_str (), &guid))
+        guid = guid_new_return ();
+    return guid;
+}
+
+gnc_numeric
+SixtpStreamBuilder::text_to_gnc_numeric (const std::string& text)
+{
+    auto num = gnc_numeric_from_string (text.c_str ());
+    if (gnc_numeric_check (num))
+        num = gnc_numeric_zero ();
+    return num;
+}
+
+void
+SixtpStreamBuilder::TimeRef::add (const std::string& text)
+{
+    if (m_seen++ == 0)
+        m_time = gnc_iso8601_to_time64_gmt (text.c_str ());
+}
+
+time64
+SixtpStreamBuilder::TimeRef::get (const gchar* tag)
+{
+    time64 time = INT64_MAX;
+
+    if (m_seen == 0)
+        PERR ("no ts:date node found.");
+    else if (m_seen == 1)
+        time = m_time;
+
+    m_seen = 0;
+    if (!dom_tree_valid_time64 (time, BAD_CAST tag))
+        time = 0;
+    return time;
+}
+
+void
+SixtpStreamBuilder::CommodityRef::add (const gchar* tag, const std::string& text)
+{
+    gchar** field;
+
+    if (g_strcmp0 (tag, "cmdty:space") == 0)
+        field = &m_space;
+    else if (g_strcmp0 (tag, "cmdty:id") == 0)
+        field = &m_id;
+    else
+        return;
+
+    if (*field)
+        m_duplicate = TRUE;
+    else
+        *field = g_strstrip (g_strdup (text.c_str ()));
+}
+
+gnc_commodity*
+SixtpStreamBuilder::CommodityRef::get (QofBook* book)
+{
+    gnc_commodity* ret = NULL;
+
+    if (m_space && m_id && !m_duplicate)
+        ret = gnc_commodity_table_lookup (gnc_commodity_table_get_table (book),
+                                          m_space, m_id);
+    if (!ret)
+        PERR ("Unable to find commodity %s:%s", m_space ? m_space : "(null)",
+              m_id ? m_id : "(null)");
+    clear ();
+    return ret;
+}
+
+void
+SixtpStreamBuilder::CommodityRef::clear ()
+{
+    g_free (m_space);
+    g_free (m_id);
+    m_space = m_id = NULL;
+    m_duplicate = FALSE;
+}
+
+static gboolean
+stream_start_handler (GSList* sibling_data, gpointer parent_data,
+                      gpointer global_data, gpointer* data_for_children,
+                      gpointer* result, const gchar* tag, gchar** attrs)
+{
+    auto builder = static_cast<SixtpStreamBuilder*> (parent_data);
+
+    g_return_val_if_fail (builder, FALSE);
+    builder->start (tag, attrs);
+    *data_for_children = builder;
+    return TRUE;
+}
+
+static gboolean
+stream_chars_handler (GSList* sibling_data, gpointer parent_data,
+                      gpointer global_data, gpointer* result,
+                      const char* text, int length)
+{
+    auto builder = static_cast<SixtpStreamBuilder*> (parent_data);
+
+    if (builder)
+        builder->characters (text, length);
+    return TRUE;
+}
+
+static gboolean
+stream_end_handler (gpointer data_for_children, GSList* data_from_children,
+                    GSList* sibling_data, gpointer parent_data,
+                    gpointer global_data, gpointer* result, const gchar* tag)
+{
+    auto builder = static_cast<SixtpStreamBuilder*> (data_for_children);
+
+    g_return_val_if_fail (builder, FALSE);
+    builder->end (tag);
+    return TRUE;
+}
+
+sixtp*
+sixtp_stream_parser_new (const gchar* tag,
+                         sixtp_start_handler starter,
+                         sixtp_end_handler ender,
+                         sixtp_fail_handler failer)
+{
+    sixtp* top_level;
+    sixtp* child;
+
+    g_return_val_if_fail (tag && starter && ender && failer, NULL);
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, starter,
+                              SIXTP_CHARACTERS_HANDLER_ID, stream_chars_handler,
+                              SIXTP_END_HANDLER_ID, ender,
+                              SIXTP_FAIL_HANDLER_ID, failer,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (! (child =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, stream_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID, stream_chars_handler,
+                              SIXTP_END_HANDLER_ID, stream_end_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    /* Everything below the top element goes to the builder.  The parser is
+       also its own child under its tag so that it can be used as the top
+       level parser of a file holding just one such element. */
+    if (!sixtp_add_sub_parser (child, SIXTP_MAGIC_CATCHER, child) ||
+        !sixtp_add_sub_parser (top_level, SIXTP_MAGIC_CATCHER, child) ||
+        !sixtp_add_sub_parser (top_level, tag, top_level))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    return top_level;
+}
@@ -33,10 +33,12 @@
 #include <cstdlib>
 #include <functional>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 #include <cashobjects.h>
+#include <Transaction.h>
 #include <TransLog.h>
 #include <gnc-engine.h>
 #include <gnc-prefs.h>
@@ -69,6 +71,15 @@ static std::vector<unsigned char> read_file (std::string filename)
     }
 }
 
+static bool
+copy_file (std::string from_file, std::string to_file)
+{
+    auto contents = read_file (from_file);
+    return g_file_set_contents (to_file.c_str (),
+                                reinterpret_cast<const gchar*> (contents.data ()),
+                                contents.size (), nullptr);
+}
+
 static bool
 compare_files (std::string filename1, std::string filename2)
 {
@@ -277,6 +288,340 @@ TEST_P(LoadSaveFiles, test_file)
         return;
 }
 
+/* Verify that a load split across threads produces the same book as a serial
+ * load, by saving it back out and comparing against the original file.
+ */
+TEST_P(LoadSaveFiles, test_file_parallel_load)
+{
+    auto filename = GetParam();
+    auto new_parallel_file = filename + "-test-parallel~";
+    const char *logdomain = "backend.xml";
+    GLogLevelFlags loglevel = static_cast<decltype (loglevel)>
+                              (G_LOG_LEVEL_WARNING);
+    TestErrorStruct check = { loglevel, const_cast<char*> (logdomain), nullptr };
+    g_log_set_handler (logdomain, loglevel,
+                       (GLogFunc)test_checked_handler, &check);
+
+    {
+        auto load_session = std::shared_ptr<QofSession>{qof_session_new (qof_book_new ()), qof_session_destroy};
+
+        gnc_prefs_set_file_load_threads (4);
+        QOF_SESSION_CHECKED_CALL(qof_session_begin, load_session, filename.c_str (), SESSION_READ_ONLY);
+        QOF_SESSION_CHECKED_CALL(qof_session_load, load_session, nullptr);
+        gnc_prefs_set_file_load_threads (1);
+
+        auto save_session = std::shared_ptr<QofSession>{qof_session_new (nullptr), qof_session_destroy};
+
+        g_unlink (new_parallel_file.c_str ());
+        g_unlink ((new_parallel_file + ".LCK").c_str ());
+        QOF_SESSION_CHECKED_CALL(qof_session_begin, save_session, new_parallel_file.c_str (), SESSION_NEW_OVERWRITE);
+
+        qof_event_suspend ();
+        qof_session_swap_data (load_session.get (), save_session.get ());
+        qof_book_mark_session_dirty (qof_session_get_book (save_session.get ()));
+        qof_event_resume ();
+
+        qof_session_end (load_session.get ());
+
+        gnc_prefs_set_file_save_compressed (FALSE);
+        QOF_SESSION_CHECKED_CALL(qof_session_save, save_session, nullptr);
+
+        qof_session_end (save_session.get ());
+    }
+
+    compare_files (filename, new_parallel_file);
+}
+
+/* Loads from_file with the given number of compression threads and saves
+ * it to to_file.
+ */
+static void
+resave_file (std::string from_file, std::string to_file, int threads,
+             gboolean compress)
+{
+    auto load_session = std::shared_ptr<QofSession>{qof_session_new (qof_book_new ()), qof_session_destroy};
+
+    gnc_prefs_set_file_compression_threads (threads);
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, load_session, from_file.c_str (), SESSION_READ_ONLY);
+    QOF_SESSION_CHECKED_CALL(qof_session_load, load_session, nullptr);
+
+    auto save_session = std::shared_ptr<QofSession>{qof_session_new (nullptr), qof_session_destroy};
+
+    g_unlink (to_file.c_str ());
+    g_unlink ((to_file + ".LCK").c_str ());
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, save_session, to_file.c_str (), SESSION_NEW_OVERWRITE);
+
+    qof_event_suspend ();
+    qof_session_swap_data (load_session.get (), save_session.get ());
+    qof_book_mark_session_dirty (qof_session_get_book (save_session.get ()));
+    qof_event_resume ();
+
+    qof_session_end (load_session.get ());
+
+    gnc_prefs_set_file_save_compressed (compress);
+    QOF_SESSION_CHECKED_CALL(qof_session_save, save_session, nullptr);
+    gnc_prefs_set_file_compression_threads (1);
+
+    qof_session_end (save_session.get ());
+}
+
+/* Verify that a file compressed in blocks on several threads can be read
+ * both by the single stream reader and by the block reader.
+ */
+TEST_P(LoadSaveFiles, test_file_parallel_compression)
+{
+    auto filename = GetParam();
+    auto new_compressed_file = filename + "-test-compressed-blocks~";
+    auto new_serial_file = filename + "-test-uncompressed-serial~";
+    auto new_blocks_file = filename + "-test-uncompressed-blocks~";
+    const char *logdomain = "backend.xml";
+    GLogLevelFlags loglevel = static_cast<decltype (loglevel)>
+                              (G_LOG_LEVEL_WARNING);
+    TestErrorStruct check = { loglevel, const_cast<char*> (logdomain), nullptr };
+    g_log_set_handler (logdomain, loglevel,
+                       (GLogFunc)test_checked_handler, &check);
+
+    resave_file (filename, new_compressed_file, 4, TRUE);
+    if (HasFatalFailure ())
+        return;
+
+    resave_file (new_compressed_file, new_serial_file, 1, FALSE);
+    if (HasFatalFailure () || !compare_files (filename, new_serial_file))
+        return;
+
+    resave_file (new_compressed_file, new_blocks_file, 4, FALSE);
+    if (HasFatalFailure ())
+        return;
+    compare_files (filename, new_blocks_file);
+}
+
+/* Verify that a block whose trailer claims more than a block's worth of
+ * data is rejected rather than allocated.
+ */
+TEST_P(LoadSaveFiles, test_file_block_bad_size)
+{
+    auto filename = GetParam();
+    auto new_compressed_file = filename + "-test-compressed-bad-size~";
+    const char *logdomain = "backend.xml";
+    GLogLevelFlags loglevel = static_cast<decltype (loglevel)>
+                              (G_LOG_LEVEL_WARNING);
+    TestErrorStruct check = { loglevel, const_cast<char*> (logdomain), nullptr };
+    g_log_set_handler (logdomain, loglevel,
+                       (GLogFunc)test_checked_handler, &check);
+
+    resave_file (filename, new_compressed_file, 4, TRUE);
+    if (HasFatalFailure ())
+        return;
+
+    /* Set the ISIZE in the first member's trailer to almost 4 GiB. */
+    auto contents = read_file (new_compressed_file);
+    ASSERT_GT (contents.size (), 20u);
+    size_t len = contents[16] | (contents[17] << 8) | (contents[18] << 16) |
+                 (static_cast<size_t> (contents[19]) << 24);
+    ASSERT_LE (len, contents.size ());
+    contents[len - 4] = 0x00;
+    contents[len - 3] = 0xff;
+    contents[len - 2] = 0xff;
+    contents[len - 1] = 0xff;
+    ASSERT_TRUE (g_file_set_contents (new_compressed_file.c_str (),
+                                      reinterpret_cast<const gchar*> (contents.data ()),
+                                      contents.size (), nullptr));
+
+    auto load_session = std::shared_ptr<QofSession>{qof_session_new (qof_book_new ()), qof_session_destroy};
+    gnc_prefs_set_file_compression_threads (4);
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, load_session, new_compressed_file.c_str (), SESSION_READ_ONLY);
+    qof_session_load (load_session.get (), nullptr);
+    gnc_prefs_set_file_compression_threads (1);
+    EXPECT_NE (qof_session_pop_error (load_session.get ()), ERR_BACKEND_NO_ERR);
+    EXPECT_GE (check.hits, 1);
+    qof_session_end (load_session.get ());
+}
+
+static void
+mark_trans_changed (QofInstance* inst, gpointer data)
+{
+    auto trans = GNC_TRANSACTION (inst);
+    auto count = static_cast<int*> (data);
+
+    if ((*count)++ % 2)
+        return;
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, "Changed by an incremental save");
+    xaccTransCommitEdit (trans);
+}
+
+/* Verify that a book loaded from a data file and its journal matches the
+ * book that wrote them, by saving both in full and comparing the files.
+ */
+TEST_P(LoadSaveFiles, test_file_journal)
+{
+    auto filename = GetParam();
+    auto new_journal_file = filename + "-test-journal~";
+    auto journal = new_journal_file + ".journal";
+    auto new_replayed_file = filename + "-test-replayed~";
+    const char *logdomain = "backend.xml";
+    GLogLevelFlags loglevel = static_cast<decltype (loglevel)>
+                              (G_LOG_LEVEL_WARNING);
+    TestErrorStruct check = { loglevel, const_cast<char*> (logdomain), nullptr };
+    g_log_set_handler (logdomain, loglevel,
+                       (GLogFunc)test_checked_handler, &check);
+
+    auto load_session = std::shared_ptr<QofSession>{qof_session_new (qof_book_new ()), qof_session_destroy};
+
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, load_session, filename.c_str (), SESSION_READ_ONLY);
+    QOF_SESSION_CHECKED_CALL(qof_session_load, load_session, nullptr);
+
+    auto journal_session = std::shared_ptr<QofSession>{qof_session_new (nullptr), qof_session_destroy};
+
+    g_unlink (new_journal_file.c_str ());
+    g_unlink (journal.c_str ());
+    g_unlink ((new_journal_file + ".LCK").c_str ());
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, journal_session, new_journal_file.c_str (), SESSION_NEW_OVERWRITE);
+
+    qof_event_suspend ();
+    qof_session_swap_data (load_session.get (), journal_session.get ());
+    qof_book_mark_session_dirty (qof_session_get_book (journal_session.get ()));
+    qof_event_resume ();
+
+    qof_session_end (load_session.get ());
+
+    /* The first save has nothing to append to, so it writes the whole file. */
+    gnc_prefs_set_file_save_compressed (FALSE);
+    gnc_prefs_set_file_journal_saves (10);
+    QOF_SESSION_CHECKED_CALL(qof_session_save, journal_session, nullptr);
+    EXPECT_FALSE (g_file_test (journal.c_str (), G_FILE_TEST_EXISTS));
+
+    auto book = qof_session_get_book (journal_session.get ());
+    int count = 0;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            mark_trans_changed, &count);
+    if (count > 0)
+    {
+        qof_book_mark_session_dirty (book);
+        QOF_SESSION_CHECKED_CALL(qof_session_save, journal_session, nullptr);
+        EXPECT_TRUE (g_file_test (journal.c_str (), G_FILE_TEST_EXISTS));
+    }
+
+    /* The journal belongs to the contents of the data file, so a copy of
+     * both, with new modification times, still replays. */
+    auto copied_file = filename + "-test-journal-copy~";
+    g_unlink ((copied_file + ".journal").c_str ());
+    g_unlink ((copied_file + ".journal.rejected").c_str ());
+    ASSERT_TRUE (copy_file (new_journal_file, copied_file));
+    if (count > 0)
+    {
+        ASSERT_TRUE (copy_file (journal, copied_file + ".journal"));
+
+        /* Saving right after replaying has nothing new to journal. */
+        auto journal_size = read_file (copied_file + ".journal").size ();
+        auto replay_session = std::shared_ptr<QofSession>{qof_session_new (qof_book_new ()), qof_session_destroy};
+        g_unlink ((copied_file + ".LCK").c_str ());
+        QOF_SESSION_CHECKED_CALL(qof_session_begin, replay_session, copied_file.c_str (), SESSION_NORMAL_OPEN);
+        QOF_SESSION_CHECKED_CALL(qof_session_load, replay_session, nullptr);
+        qof_book_mark_session_dirty (qof_session_get_book (replay_session.get ()));
+        QOF_SESSION_CHECKED_CALL(qof_session_save, replay_session, nullptr);
+        qof_session_end (replay_session.get ());
+        EXPECT_EQ (journal_size, read_file (copied_file + ".journal").size ());
+    }
+    resave_file (copied_file, new_replayed_file, 1, FALSE);
+    EXPECT_FALSE (g_file_test ((copied_file + ".journal.rejected").c_str (),
+                               G_FILE_TEST_EXISTS));
+    gnc_prefs_set_file_journal_saves (0);
+
+    /* Rewriting the file in full removes the journal. */
+    qof_book_mark_session_dirty (book);
+    QOF_SESSION_CHECKED_CALL(qof_session_save, journal_session, nullptr);
+    EXPECT_FALSE (g_file_test (journal.c_str (), G_FILE_TEST_EXISTS));
+    qof_session_end (journal_session.get ());
+
+    compare_files (new_journal_file, new_replayed_file);
+}
+
+/* Verify that a journal with a bad entry is set aside as a whole, leaving
+ * the book as it is in the data file, and that the load says so.
+ */
+TEST_P(LoadSaveFiles, test_file_journal_rejected)
+{
+    auto filename = GetParam();
+    auto data_file = filename + "-test-journal-rejected~";
+    auto journal = data_file + ".journal";
+    auto rejected = journal + ".rejected";
+    auto new_resaved_file = filename + "-test-journal-resaved~";
+    const char *logdomain = "backend.xml";
+    GLogLevelFlags loglevel = static_cast<decltype (loglevel)>
+                              (G_LOG_LEVEL_WARNING);
+    TestErrorStruct check = { loglevel, const_cast<char*> (logdomain), nullptr };
+    g_log_set_handler (logdomain, loglevel,
+                       (GLogFunc)test_checked_handler, &check);
+
+    g_unlink (rejected.c_str ());
+    ASSERT_TRUE (copy_file (filename, data_file));
+
+    auto id_session = std::shared_ptr<QofSession>{qof_session_new (qof_book_new ()), qof_session_destroy};
+    gnc_prefs_set_file_journal_saves (10);
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, id_session, data_file.c_str (), SESSION_READ_ONLY);
+    QOF_SESSION_CHECKED_CALL(qof_session_load, id_session, nullptr);
+
+    /* A good entry that would change every transaction, then one that can't
+     * be read: none of it may be applied. */
+    auto book = qof_session_get_book (id_session.get ());
+    std::set<std::string> guids;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            [](QofInstance* inst, gpointer data)
+                            {
+                                auto trans = GNC_TRANSACTION (inst);
+                                xaccTransBeginEdit (trans);
+                                xaccTransSetDescription (trans, "Never applied");
+                                xaccTransCommitEdit (trans);
+                                char guid_str[GUID_ENCODING_LENGTH + 1];
+                                guid_to_string_buff (qof_instance_get_guid (inst), guid_str);
+                                static_cast<std::set<std::string>*> (data)->insert (guid_str);
+                            }, &guids);
+
+    GChecksum* checksum = g_checksum_new (G_CHECKSUM_SHA256);
+    auto contents = read_file (data_file);
+    g_checksum_update (checksum, contents.data (), contents.size ());
+    std::string base{"sha256:"};
+    base += g_checksum_get_string (checksum);
+    g_checksum_free (checksum);
+
+    g_unlink (journal.c_str ());
+    ASSERT_TRUE (gnc_xml_journal_append (book, journal.c_str (), guids, base));
+    qof_session_end (id_session.get ());
+    {
+        auto out = g_fopen (journal.c_str (), "a");
+        ASSERT_NE (out, nullptr);
+        fputs ("<gnc:journal-entry>\n<gnc:journal-delete type=\"guid\">"
+               "not-a-guid</gnc:journal-delete>\n</gnc:journal-entry>\n", out);
+        fclose (out);
+    }
+
+    auto load_session = std::shared_ptr<QofSession>{qof_session_new (qof_book_new ()), qof_session_destroy};
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, load_session, data_file.c_str (), SESSION_READ_ONLY);
+    qof_session_load (load_session.get (), nullptr);
+    EXPECT_EQ (qof_session_pop_error (load_session.get ()), ERR_FILEIO_JOURNAL_REJECTED);
+    EXPECT_FALSE (g_file_test (journal.c_str (), G_FILE_TEST_EXISTS));
+    EXPECT_TRUE (g_file_test (rejected.c_str (), G_FILE_TEST_EXISTS));
+
+    auto save_session = std::shared_ptr<QofSession>{qof_session_new (nullptr), qof_session_destroy};
+    g_unlink (new_resaved_file.c_str ());
+    g_unlink ((new_resaved_file + ".LCK").c_str ());
+    QOF_SESSION_CHECKED_CALL(qof_session_begin, save_session, new_resaved_file.c_str (), SESSION_NEW_OVERWRITE);
+
+    qof_event_suspend ();
+    qof_session_swap_data (load_session.get (), save_session.get ());
+    qof_book_mark_session_dirty (qof_session_get_book (save_session.get ()));
+    qof_event_resume ();
+    qof_session_end (load_session.get ());
+
+    gnc_prefs_set_file_journal_saves (0);
+    gnc_prefs_set_file_save_compressed (FALSE);
+    QOF_SESSION_CHECKED_CALL(qof_session_save, save_session, nullptr);
+    qof_session_end (save_session.get ());
+
+    compare_files (filename, new_resaved_file);
+}
+
 std::vector<std::string> ListTestCases ();
 
 INSTANTIATE_TEST_SUITE_P(
@@ -34,6 +34,10 @@ static gboolean extras_enabled    = FALSE;
 static gboolean use_compression   = TRUE; // This is also the default in the prefs backend
 static gint file_retention_policy = 1;    // 1 = "days", the default in the prefs backend
 static gint file_retention_days   = 30;   // This is also the default in the prefs backend
+static gint file_load_threads     = 1;    // This is also the default in the prefs backend
+static gint file_compression_threads = 1; // This is also the default in the prefs backend
+static gint file_journal_saves    = 0;    // This is also the default in the prefs backend
+static gboolean sql_lazy_load     = FALSE; // This is also the default in the prefs backend
 
 
 /* Global variables used to remove the preference registered callbacks
@@ -119,6 +123,54 @@ gnc_prefs_set_file_retention_days(gint days)
     file_retention_days = days;
 }
 
+gint
+gnc_prefs_get_file_load_threads(void)
+{
+    return file_load_threads;
+}
+
+void
+gnc_prefs_set_file_load_threads(gint threads)
+{
+    file_load_threads = threads;
+}
+
+gint
+gnc_prefs_get_file_compression_threads(void)
+{
+    return file_compression_threads;
+}
+
+void
+gnc_prefs_set_file_compression_threads(gint threads)
+{
+    file_compression_threads = threads;
+}
+
+gint
+gnc_prefs_get_file_journal_saves(void)
+{
+    return file_journal_saves;
+}
+
+void
+gnc_prefs_set_file_journal_saves(gint saves)
+{
+    file_journal_saves = saves;
+}
+
+gboolean
+gnc_prefs_get_sql_lazy_load(void)
+{
+    return sql_lazy_load;
+}
+
+void
+gnc_prefs_set_sql_lazy_load(gboolean lazy)
+{
+    sql_lazy_load = lazy;
+}
+
 guint
 gnc_prefs_get_long_version()
 {
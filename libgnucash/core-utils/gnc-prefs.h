@@ -119,6 +119,18 @@ void gnc_prefs_set_file_retention_policy(gint policy);
 gint gnc_prefs_get_file_retention_days(void);
 void gnc_prefs_set_file_retention_days(gint days);
 
+gint gnc_prefs_get_file_load_threads(void);
+void gnc_prefs_set_file_load_threads(gint threads);
+
+gint gnc_prefs_get_file_compression_threads(void);
+void gnc_prefs_set_file_compression_threads(gint threads);
+
+gint gnc_prefs_get_file_journal_saves(void);
+void gnc_prefs_set_file_journal_saves(gint saves);
+
+gboolean gnc_prefs_get_sql_lazy_load(void);
+void gnc_prefs_set_sql_lazy_load(gboolean lazy);
+
 guint gnc_prefs_get_long_version( void );
 
 /** @} */
@@ -43,11 +43,14 @@
 #include "gnc-lot.h"
 #include "gnc-pricedb.h"
 #include "qofinstance-p.h"
+#include "qof-backend.hpp"
 #include "gnc-features.h"
 #include "guid.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <map>
+#include <optional>
 #include <unordered_set>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
@@ -64,7 +67,6 @@ static const std::string KEY_RECONCILE_INFO("reconcile-info");
 static const std::string KEY_INCLUDE_CHILDREN("include-children");
 static const std::string KEY_POSTPONE("postpone");
 static const std::string KEY_LOT_MGMT("lot-mgmt");
-static const std::string KEY_ONLINE_ID("online_id");
 static const std::string KEY_IMP_APPEND_TEXT("import-append-text");
 static const std::string AB_KEY("hbci");
 static const std::string AB_ACCOUNT_ID("account-id");
@@ -77,6 +79,10 @@ static const std::string KEY_BALANCE_HIGHER_LIMIT_VALUE("higher-value");
 static const std::string KEY_BALANCE_LOWER_LIMIT_VALUE("lower-value");
 static const std::string KEY_BALANCE_INCLUDE_SUB_ACCTS("inlude-sub-accts");
 
+/* Keys looked up often enough to be worth a handle. */
+static const KvpKey KEY_ONLINE_ID("online_id");
+static const KvpKey KEY_NOTES("notes");
+
 using FinalProbabilityVec=std::vector<std::pair<std::string, int32_t>>;
 using ProbabilityVec=std::vector<std::pair<std::string, struct AccountProbability>>;
 using FlatKvpEntry=std::pair<std::string, KvpValue*>;
@@ -326,6 +332,7 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = 0;
 
     priv->higher_balance_limit = {};
     priv->lower_balance_limit = {};
@@ -333,8 +340,10 @@ gnc_account_init(Account* acc)
 
     new (&priv->children) AccountVec ();
     new (&priv->splits) SplitsVec ();
+    new (&priv->split_records) std::vector<AccountSplitRecord> ();
     priv->splits_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
     priv->sort_dirty = FALSE;
+    priv->defer_sort = FALSE;
 }
 
 static void
@@ -479,7 +488,7 @@ gnc_account_get_property (GObject         *object,
         qof_instance_get_path_kvp (QOF_INSTANCE (account), value, {KEY_LOT_MGMT, "next-id"});
         break;
     case PROP_ONLINE_ACCOUNT:
-        qof_instance_get_path_kvp (QOF_INSTANCE (account), value, {KEY_ONLINE_ID});
+        qof_instance_get_key_kvp (QOF_INSTANCE (account), value, {KEY_ONLINE_ID});
         break;
     case PROP_IMP_APPEND_TEXT:
         g_value_set_boolean(value, xaccAccountGetAppendText(account));
@@ -611,7 +620,7 @@ gnc_account_set_property (GObject         *object,
         qof_instance_set_path_kvp (QOF_INSTANCE (account), value, {KEY_LOT_MGMT, "next-id"});
         break;
     case PROP_ONLINE_ACCOUNT:
-        qof_instance_set_path_kvp (QOF_INSTANCE (account), value, {KEY_ONLINE_ID});
+        qof_instance_set_key_kvp (QOF_INSTANCE (account), value, {KEY_ONLINE_ID});
         break;
     case PROP_IMP_APPEND_TEXT:
         xaccAccountSetAppendText(account, g_value_get_boolean(value));
@@ -1138,6 +1147,19 @@ xaccInitAccount (Account * acc, QofBook *book)
 /********************************************************************\
 \********************************************************************/
 
+/* A backend that loads transactions on demand may not have put all of an
+ * account's splits in the book yet; have it fetch those posted on or after
+ * since before they're read. */
+static void
+account_fetch_splits (const Account *acc, time64 since = INT64_MIN)
+{
+    auto book{qof_instance_get_book (acc)};
+    if (qof_book_shutting_down (book))
+        return;
+    if (auto be{qof_book_get_backend (book)})
+        be->fetch_account_splits (QOF_INSTANCE (acc), since);
+}
+
 void
 gnc_account_foreach_split (const Account *acc, std::function<void(Split*)> func,
                            bool reverse)
@@ -1145,6 +1167,8 @@ gnc_account_foreach_split (const Account *acc, std::function<void(Split*)> func,
     if (!GNC_IS_ACCOUNT (acc))
         return;
 
+    account_fetch_splits (acc);
+
     auto& splits{GET_PRIVATE(acc)->splits};
     if (reverse)
         std::for_each(splits.rbegin(), splits.rend(), func);
@@ -1152,6 +1176,15 @@ gnc_account_foreach_split (const Account *acc, std::function<void(Split*)> func,
         std::for_each(splits.begin(), splits.end(), func);
 }
 
+/* Whether split_records matches splits one for one, which it does once the
+ * splits are sorted and their running balances recomputed. */
+static bool
+split_records_current (const AccountPrivate *priv)
+{
+    return !priv->sort_dirty && !priv->balance_dirty &&
+        priv->split_records.size() == priv->splits.size();
+}
+
 void
 gnc_account_foreach_split_until_date (const Account *acc, time64 end_date,
                                       std::function<void(Split*)> f)
@@ -1159,14 +1192,73 @@ gnc_account_foreach_split_until_date (const Account *acc, time64 end_date,
     if (!GNC_IS_ACCOUNT (acc))
         return;
 
-    auto after_date = [](time64 end_date, auto s) -> bool
-    { return (xaccTransGetDate (xaccSplitGetParent (s)) > end_date); };
-
-    auto& splits{GET_PRIVATE(acc)->splits};
-    auto after_date_iter = std::upper_bound (splits.begin(), splits.end(), end_date, after_date);
+    account_fetch_splits (acc);
+    auto priv{GET_PRIVATE(acc)};
+    auto& splits{priv->splits};
+    auto after_date_iter{splits.end()};
+    if (split_records_current (priv))
+    {
+        auto after_date = [](time64 end_date, const AccountSplitRecord& r) -> bool
+        { return r.date_posted > end_date; };
+        const auto& records{priv->split_records};
+        auto after_date_rec{std::upper_bound (records.begin(), records.end(),
+                                              end_date, after_date)};
+        after_date_iter = splits.begin() + std::distance (records.begin(), after_date_rec);
+    }
+    else if (priv->sort_dirty)
+    {
+        /* A deferred sort leaves them in no order, so look at them all. */
+        for (auto s : splits)
+            if (xaccTransGetDate (xaccSplitGetParent (s)) <= end_date)
+                f (s);
+        return;
+    }
+    else
+    {
+        auto after_date = [](time64 end_date, auto s) -> bool
+        { return (xaccTransGetDate (xaccSplitGetParent (s)) > end_date); };
+        after_date_iter = std::upper_bound (splits.begin(), splits.end(), end_date, after_date);
+    }
     std::for_each (splits.begin(), after_date_iter, f);
 }
 
+void
+gnc_account_foreach_split_in_date_range (const Account *acc, time64 start_date,
+                                         time64 end_date,
+                                         std::function<void(Split*)> f)
+{
+    if (!GNC_IS_ACCOUNT (acc) || start_date > end_date)
+        return;
+
+    /* All of them, so that nothing f does can fetch more into the range. */
+    account_fetch_splits (acc);
+    auto priv{GET_PRIVATE(acc)};
+    auto& splits{priv->splits};
+    auto split_date = [](const Split *s)
+    { return xaccTransGetDate (xaccSplitGetParent (s)); };
+
+    /* A changed posting date marks the splits unsorted, so while they're
+     * sorted they can be bisected by date. */
+    if (priv->sort_dirty)
+    {
+        for (auto s : splits)
+        {
+            auto date{split_date (s)};
+            if (date >= start_date && date <= end_date)
+                f (s);
+        }
+        return;
+    }
+
+    auto before_start = [split_date](const Split *s, time64 date) -> bool
+    { return split_date (s) < date; };
+    auto after_end = [split_date](time64 date, const Split *s) -> bool
+    { return split_date (s) > date; };
+    auto first{std::lower_bound (splits.begin(), splits.end(), start_date, before_start)};
+    auto last{std::upper_bound (first, splits.end(), end_date, after_end)};
+    std::for_each (first, last, f);
+}
+
 
 Split*
 gnc_account_find_split (const Account *acc, std::function<bool(const Split*)> predicate,
@@ -1464,6 +1556,8 @@ xaccFreeAccount (Account *acc)
     priv->balance_dirty = FALSE;
     priv->sort_dirty = FALSE;
     priv->splits.~SplitsVec();
+    using SplitRecordVec = std::vector<AccountSplitRecord>;
+    priv->split_records.~SplitRecordVec();
     priv->children.~AccountVec();
     g_hash_table_destroy (priv->splits_hash);
 
@@ -1546,6 +1640,7 @@ xaccAccountCommitEdit (Account *acc)
            themselves will be destroyed by the transaction code */
         if (!qof_book_shutting_down(book))
         {
+            account_fetch_splits (acc);
             // We need to delete in reverse order so that the vector's iterators aren't invalidated.
             for_each(priv->splits.rbegin(), priv->splits.rend(), [](Split *s) {
                 xaccSplitDestroy (s); });
@@ -1866,6 +1961,17 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
 
 /********************************************************************\
 \********************************************************************/
+
+/* Record that the running balances of the splits from position pos onward
+ * need to be recomputed. */
+static void
+set_balance_dirty_from (AccountPrivate *priv, std::size_t pos)
+{
+    if (!priv->balance_dirty || pos < priv->balance_dirty_from)
+        priv->balance_dirty_from = pos;
+    priv->balance_dirty = TRUE;
+}
+
 void
 gnc_account_set_sort_dirty (Account *acc)
 {
@@ -1891,7 +1997,29 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
-    priv->balance_dirty = TRUE;
+    set_balance_dirty_from (priv, 0);
+}
+
+void
+gnc_account_set_balance_dirty_from_split (Account *acc, const Split *split)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+
+    /* Splits are usually edited near the end of the account so search
+     * backwards; a split that isn't in the account yet marks nothing but
+     * the totals, its insertion will take care of the rest. */
+    priv = GET_PRIVATE(acc);
+    const auto& splits{priv->splits};
+    auto it{std::find (splits.rbegin(), splits.rend(), split)};
+    if (it == splits.rend())
+        set_balance_dirty_from (priv, splits.size());
+    else
+        set_balance_dirty_from (priv, std::distance (it, splits.rend()) - 1);
 }
 
 void gnc_account_set_defer_bal_computation (Account *acc, gboolean defer)
@@ -1916,15 +2044,65 @@ gboolean gnc_account_get_defer_bal_computation (Account *acc)
     return priv->defer_bal_computation;
 }
 
+void gnc_account_set_defer_sort (Account *acc, gboolean defer)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail (GNC_IS_ACCOUNT (acc));
+
+    if (qof_instance_get_destroying (acc))
+        return;
+
+    priv = GET_PRIVATE (acc);
+    priv->defer_sort = defer;
+    if (!defer)
+        xaccAccountSortSplits (acc, FALSE);
+}
+
+gboolean gnc_account_get_defer_sort (Account *acc)
+{
+    AccountPrivate *priv;
+    if (!acc)
+        return false;
+    priv = GET_PRIVATE (acc);
+    return priv->defer_sort;
+}
+
 
 /********************************************************************\
 \********************************************************************/
 
+/* Nearly every pair of splits in an account is told apart by the date their
+ * transactions were posted, so sorting compares those first and only falls
+ * back to the full xaccSplitOrder for splits posted at the same time. */
+struct SplitSortKey
+{
+    time64 date_posted;
+    Split *split;
+};
+
+static inline time64
+split_sort_date (const Split *s)
+{
+    /* xaccSplitOrder puts splits without a transaction last. */
+    return s->parent ? s->parent->date_posted : INT64_MAX;
+}
+
 static bool split_cmp_less (const Split* a, const Split* b)
 {
+    auto date_a{split_sort_date (a)}, date_b{split_sort_date (b)};
+    if (date_a != date_b)
+        return date_a < date_b;
     return xaccSplitOrder (a, b) < 0;
 }
 
+static bool split_key_less (const SplitSortKey& a, const SplitSortKey& b)
+{
+    if (a.date_posted != b.date_posted)
+        return a.date_posted < b.date_posted;
+    return xaccSplitOrder (a.split, b.split) < 0;
+}
+
 gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
@@ -1937,19 +2115,31 @@ gnc_account_insert_split (Account *acc, Split *s)
     if (!g_hash_table_add (priv->splits_hash, s))
         return false;
 
-    priv->splits.push_back (s);
-
-    if (qof_instance_get_editlevel(acc) == 0)
-        std::sort (priv->splits.begin(), priv->splits.end(), split_cmp_less);
+    auto& splits{priv->splits};
+    bool sort_now{qof_instance_get_editlevel(acc) == 0 && !priv->defer_sort};
+    if (sort_now && !priv->sort_dirty)
+    {
+        /* The splits are in order, so put s straight into its place. */
+        auto pos{std::upper_bound (splits.begin(), splits.end(), s, split_cmp_less)};
+        pos = splits.insert (pos, s);
+        set_balance_dirty_from (priv, std::distance (splits.begin(), pos));
+    }
     else
+    {
+        splits.push_back (s);
+        set_balance_dirty_from (priv, splits.size() - 1);
         priv->sort_dirty = true;
 
+        /* Sorting moves s into place and marks the balances dirty from there. */
+        if (sort_now)
+            xaccAccountSortSplits (acc, FALSE);
+    }
+
     //FIXME: find better event
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, nullptr);
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1970,18 +2160,25 @@ gnc_account_remove_split (Account *acc, Split *s)
 
     // shortcut pruning the last element. this is the most common
     // remove_split operation during UI or book shutdown.
-    if (s == priv->splits.back())
-        priv->splits.pop_back();
+    auto& splits{priv->splits};
+    if (s == splits.back())
+    {
+        splits.pop_back();
+        set_balance_dirty_from (priv, splits.size());
+    }
     else
-        priv->splits.erase (std::remove (priv->splits.begin(), priv->splits.end(), s),
-                            priv->splits.end());
+    {
+        auto it{std::find (splits.begin(), splits.end(), s)};
+        set_balance_dirty_from (priv, std::distance (splits.begin(), it));
+        if (it != splits.end())
+            splits.erase (it);
+    }
 
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, nullptr);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
@@ -1994,11 +2191,35 @@ xaccAccountSortSplits (Account *acc, gboolean force)
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
 
     priv = GET_PRIVATE(acc);
-    if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
+    if (!priv->sort_dirty ||
+        (!force && (qof_instance_get_editlevel(acc) > 0 || priv->defer_sort)))
         return;
-    std::sort (priv->splits.begin(), priv->splits.end(), split_cmp_less);
+
+    /* Sort copies of the keys rather than the splits so that the
+     * comparisons read one contiguous array instead of chasing each split's
+     * transaction. */
+    auto& splits{priv->splits};
+    std::vector<SplitSortKey> keys;
+    keys.reserve (splits.size());
+    for (auto s : splits)
+        keys.push_back ({split_sort_date (s), s});
+
+    /* The splits ahead of the first one out of order are in order, and the
+     * ones of those that sort before all of the ones after it are already
+     * in place, and so are their running balances. The rest are usually a
+     * few new or changed splits, so sort those and merge them in. */
+    auto unsorted{std::is_sorted_until (keys.begin(), keys.end(), split_key_less)};
+    if (unsorted != keys.end())
+    {
+        std::sort (unsorted, keys.end(), split_key_less);
+        auto first_moved{std::upper_bound (keys.begin(), unsorted, *unsorted, split_key_less)};
+        std::inplace_merge (first_moved, unsorted, keys.end(), split_key_less);
+        auto first_pos{std::distance (keys.begin(), first_moved)};
+        std::transform (first_moved, keys.end(), splits.begin() + first_pos,
+                        [](const SplitSortKey& key) { return key.split; });
+        set_balance_dirty_from (priv, first_pos);
+    }
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
 }
 
 static void
@@ -2193,6 +2414,8 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 
     /* optimizations */
     from_priv = GET_PRIVATE(accfrom);
+    if (accfrom != accto)
+        account_fetch_splits (accfrom);
     if (from_priv->splits.empty() || accfrom == accto)
         return;
 
@@ -2275,18 +2498,40 @@ xaccAccountRecomputeBalance (Account * acc)
     priv = GET_PRIVATE(acc);
     if (qof_instance_get_editlevel(acc) > 0) return;
     if (!priv->balance_dirty || priv->defer_bal_computation) return;
+    /* The running balances follow the sort order, so wait for it. */
+    if (priv->defer_sort && priv->sort_dirty) return;
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
 
-    balance            = priv->starting_balance;
-    noclosing_balance  = priv->starting_noclosing_balance;
-    cleared_balance    = priv->starting_cleared_balance;
-    reconciled_balance = priv->starting_reconciled_balance;
+    /* The running balances of the splits before the first dirty one are
+     * still good, so carry on from the last of them. */
+    const auto& splits{priv->splits};
+    auto& records{priv->split_records};
+    auto first_dirty{std::min ({priv->balance_dirty_from, splits.size(),
+                                records.size()})};
+    if (first_dirty == 0)
+    {
+        balance            = priv->starting_balance;
+        noclosing_balance  = priv->starting_noclosing_balance;
+        cleared_balance    = priv->starting_cleared_balance;
+        reconciled_balance = priv->starting_reconciled_balance;
+    }
+    else
+    {
+        const auto& last_clean{records[first_dirty - 1]};
+        balance            = last_clean.balance;
+        noclosing_balance  = last_clean.noclosing_balance;
+        cleared_balance    = last_clean.cleared_balance;
+        reconciled_balance = last_clean.reconciled_balance;
+    }
+    records.resize (first_dirty);
+    records.reserve (splits.size());
 
-    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
-           priv->accountName, balance.num, balance.denom);
-    for (auto split : priv->splits)
+    PINFO ("acct=%s starting at split %" G_GSIZE_FORMAT " baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
+           priv->accountName, first_dirty, balance.num, balance.denom);
+    for (auto it = splits.begin() + first_dirty; it != splits.end(); ++it)
     {
+        auto split{*it};
         gnc_numeric amt = xaccSplitGetAmount (split);
 
         balance = gnc_numeric_add_fixed(balance, amt);
@@ -2311,6 +2556,9 @@ xaccAccountRecomputeBalance (Account * acc)
         split->cleared_balance = cleared_balance;
         split->reconciled_balance = reconciled_balance;
 
+        records.push_back ({xaccTransGetDate (split->parent), balance,
+                            noclosing_balance, cleared_balance,
+                            reconciled_balance});
     }
 
     priv->balance = balance;
@@ -2318,6 +2566,7 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = 0;
 }
 
 /********************************************************************\
@@ -2418,7 +2667,7 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    set_balance_dirty_from (priv, 0); /* new type may affect balance computation */
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2482,7 +2731,7 @@ xaccAccountSetDescription (Account *acc, const char *str)
 }
 
 static void
-set_kvp_string_path (Account *acc, std::vector<std::string> const & path,
+set_kvp_string_path (Account *acc, KeyPath const & path,
                      const char *value)
 {
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
@@ -2493,35 +2742,35 @@ set_kvp_string_path (Account *acc, std::vector<std::string> const & path,
         GValue v = G_VALUE_INIT;
         g_value_init (&v, G_TYPE_STRING);
         g_value_set_static_string (&v, value);
-        qof_instance_set_path_kvp (QOF_INSTANCE (acc), &v, path);
+        qof_instance_set_key_kvp (QOF_INSTANCE (acc), &v, path);
         g_value_unset (&v);
     }
     else
     {
-         qof_instance_set_path_kvp (QOF_INSTANCE (acc), nullptr, path);
+         qof_instance_set_key_kvp (QOF_INSTANCE (acc), nullptr, path);
     }
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
 
 static void
-set_kvp_string_tag (Account *acc, const char *tag, const char *value)
+set_kvp_string_tag (Account *acc, KvpKeyRef const & tag, const char *value)
 {
     set_kvp_string_path (acc, {tag}, value);
 }
 
 static const char*
-get_kvp_string_path (const Account *acc, std::vector<std::string> const & path,
+get_kvp_string_path (const Account *acc, KeyPath const & path,
                      GValue *v)
 {
     *v = G_VALUE_INIT;
     if (acc == nullptr) return nullptr; // how to check path is valid??
-    qof_instance_get_path_kvp (QOF_INSTANCE (acc), v, path);
+    qof_instance_get_key_kvp (QOF_INSTANCE (acc), v, path);
     return G_VALUE_HOLDS_STRING (v) ? g_value_get_string (v) : nullptr;
 }
 
 static const char*
-get_kvp_string_tag (const Account *acc, const char *tag, GValue *v)
+get_kvp_string_tag (const Account *acc, KvpKeyRef const & tag, GValue *v)
 {
     return get_kvp_string_path (acc, {tag}, v);
 }
@@ -2571,7 +2820,7 @@ qofAccountSetParent (Account *acc, QofInstance *parent)
 void
 xaccAccountSetNotes (Account *acc, const char *str)
 {
-    set_kvp_string_tag (acc, "notes", str);
+    set_kvp_string_tag (acc, KEY_NOTES, str);
 }
 
 
@@ -2624,6 +2873,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     priv->non_standard_scu = FALSE;
 
     /* iterate over splits */
+    account_fetch_splits (acc);
     for (auto s : priv->splits)
     {
         Transaction *trans = xaccSplitGetParent (s);
@@ -2634,7 +2884,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    set_balance_dirty_from (priv, 0);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -3344,7 +3594,7 @@ xaccAccountGetNotes (const Account *acc)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), nullptr);
     GValue v = G_VALUE_INIT;
-    auto rv = get_kvp_string_tag (acc, "notes", &v);
+    auto rv = get_kvp_string_tag (acc, KEY_NOTES, &v);
     g_value_unset (&v);
     return rv;
 }
@@ -3445,7 +3695,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    set_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3458,7 +3708,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    set_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3471,7 +3721,7 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    set_balance_dirty_from (priv, 0);
 }
 
 gnc_numeric
@@ -3501,6 +3751,20 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
     auto today{gnc_time64_get_today_end()};
     std::optional<gnc_numeric> minimum;
 
+    auto priv{GET_PRIVATE(acc)};
+    if (split_records_current (priv))
+    {
+        const auto& records{priv->split_records};
+        for (auto it = records.rbegin(); it != records.rend(); ++it)
+        {
+            if (!minimum || gnc_numeric_compare (it->balance, *minimum) < 0)
+                minimum = it->balance;
+            if (it->date_posted < today)
+                break;
+        }
+        return minimum ? *minimum : gnc_numeric_zero();
+    }
+
     auto before_today_end = [&minimum, today](const Split *s) -> bool
     {
         auto bal{xaccSplitGetBalance(s)};
@@ -3518,37 +3782,86 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+/* Each split carries the account's running balances (total, noclosing,
+ * cleared and reconciled) up to and including itself, and the splits are
+ * sorted by posted date, so together they form a date-ordered index of the
+ * balances. The balance as of a date is that of the latest split posted
+ * before it, which can be found by binary search.
+ */
+static Split*
+latest_split_before_date (const AccountPrivate *priv, time64 date)
+{
+    const auto& splits{priv->splits};
+    if (split_records_current (priv))
+    {
+        auto is_before_date = [date](const AccountSplitRecord& r) -> bool
+        { return r.date_posted < date; };
+        const auto& records{priv->split_records};
+        auto first_not_before{std::partition_point (records.begin(), records.end(),
+                                                    is_before_date)};
+        auto pos{std::distance (records.begin(), first_not_before)};
+        return pos == 0 ? nullptr : splits[pos - 1];
+    }
+
+    /* A deferred sort leaves them in no order, so look at them all. */
+    if (priv->sort_dirty)
+    {
+        std::optional<SplitSortKey> latest;
+        for (auto s : splits)
+        {
+            SplitSortKey key{split_sort_date (s), s};
+            if (key.date_posted < date && (!latest || split_key_less (*latest, key)))
+                latest = key;
+        }
+        return latest ? latest->split : nullptr;
+    }
+
+    auto is_before_date = [date](const Split *s) -> bool
+    { return xaccTransGetDate (xaccSplitGetParent (s)) < date; };
+
+    auto first_not_before{std::partition_point (splits.begin(), splits.end(),
+                                                is_before_date)};
+    return first_not_before == splits.begin() ? nullptr : *std::prev (first_not_before);
+}
+
+/* Only the splits posted on or after date have to be in the book: the
+ * starting balance covers any earlier ones that aren't. */
 static gnc_numeric
-GetBalanceAsOfDate (Account *acc, time64 date, std::function<gnc_numeric(Split*)> split_to_numeric)
+GetBalanceAsOfDate (Account *acc, time64 date, std::function<gnc_numeric(Split*)> split_to_numeric,
+                    gnc_numeric AccountPrivate::*starting_balance)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
+    account_fetch_splits (acc, date);
     xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
-    auto is_before_date = [date](auto s) -> bool
-    { return xaccTransGetDate(xaccSplitGetParent(s)) < date; };
-
-    auto latest_split{gnc_account_find_split (acc, is_before_date, true)};
-    return latest_split ? split_to_numeric (latest_split) : gnc_numeric_zero();
+    auto priv{GET_PRIVATE (acc)};
+    auto latest_split{latest_split_before_date (priv, date)};
+    return latest_split ? split_to_numeric (latest_split) : priv->*starting_balance;
 }
 
 gnc_numeric
 xaccAccountGetBalanceAsOfDate (Account *acc, time64 date)
 {
-    return GetBalanceAsOfDate (acc, date, xaccSplitGetBalance);
+    return GetBalanceAsOfDate (acc, date, xaccSplitGetBalance,
+                               &AccountPrivate::starting_balance);
 }
 
 static gnc_numeric
 xaccAccountGetNoclosingBalanceAsOfDate (Account *acc, time64 date)
 {
-    return GetBalanceAsOfDate (acc, date, xaccSplitGetNoclosingBalance);
+    /* Nothing keeps a starting noclosing balance for splits left out. */
+    account_fetch_splits (acc);
+    return GetBalanceAsOfDate (acc, date, xaccSplitGetNoclosingBalance,
+                               &AccountPrivate::starting_noclosing_balance);
 }
 
 gnc_numeric
 xaccAccountGetReconciledBalanceAsOfDate (Account *acc, time64 date)
 {
-    return GetBalanceAsOfDate (acc, date, xaccSplitGetReconciledBalance);
+    return GetBalanceAsOfDate (acc, date, xaccSplitGetReconciledBalance,
+                               &AccountPrivate::starting_reconciled_balance);
 }
 
 /*
@@ -3669,7 +3982,7 @@ xaccAccountGetXxxBalanceAsOfDateInCurrency(Account *acc, time64 date,
 typedef struct
 {
     const gnc_commodity *currency;
-    gnc_numeric balance;
+    std::vector<gnc_numeric> balances;
     xaccGetBalanceFn fn;
     xaccGetBalanceAsOfDateFn asOfDateFn;
     time64 date;
@@ -3678,8 +3991,8 @@ typedef struct
 
 /*
  * A helper function for iterating over all the accounts in a list or
- * tree.  This function is called once per account, and sums up the
- * values of all these accounts.
+ * tree.  This function is called once per account, and collects the
+ * values of all these accounts for the caller to sum.
  */
 static void
 xaccAccountBalanceHelper (Account *acc, gpointer data)
@@ -3690,9 +4003,7 @@ xaccAccountBalanceHelper (Account *acc, gpointer data)
     if (!cb->fn || !cb->currency)
         return;
     balance = xaccAccountGetXxxBalanceInCurrency (acc, cb->fn, cb->currency);
-    cb->balance = gnc_numeric_add (cb->balance, balance,
-                                   gnc_commodity_get_fraction (cb->currency),
-                                   GNC_HOW_RND_ROUND_HALF_UP);
+    cb->balances.push_back (balance);
 }
 
 static void
@@ -3705,9 +4016,7 @@ xaccAccountBalanceAsOfDateHelper (Account *acc, gpointer data)
 
     balance = xaccAccountGetXxxBalanceAsOfDateInCurrency (
                   acc, cb->date, cb->asOfDateFn, cb->currency);
-    cb->balance = gnc_numeric_add (cb->balance, balance,
-                                   gnc_commodity_get_fraction (cb->currency),
-                                   GNC_HOW_RND_ROUND_HALF_UP);
+    cb->balances.push_back (balance);
 }
 
 
@@ -3742,18 +4051,12 @@ xaccAccountGetXxxBalanceInCurrencyRecursive (const Account *acc,
        commodity. */
     if (include_children)
     {
-#ifdef _MSC_VER
-        /* MSVC compiler: Somehow, the struct initialization containing a
-           gnc_numeric doesn't work. As an exception, we hand-initialize
-           that member afterwards. */
-        CurrencyBalance cb = { report_commodity, { 0 }, fn, nullptr, 0 };
-        cb.balance = balance;
-#else
-        CurrencyBalance cb = { report_commodity, balance, fn, nullptr, 0 };
-#endif
+        CurrencyBalance cb = { report_commodity, { balance }, fn, nullptr, 0 };
 
         gnc_account_foreach_descendant (acc, xaccAccountBalanceHelper, &cb);
-        balance = cb.balance;
+        balance = gnc_numeric_sum (cb.balances.data (), cb.balances.size (),
+                                   gnc_commodity_get_fraction (report_commodity),
+                                   GNC_HOW_RND_ROUND_HALF_UP);
     }
 
     return balance;
@@ -3779,18 +4082,12 @@ xaccAccountGetXxxBalanceAsOfDateInCurrencyRecursive (
        commodity. */
     if (include_children)
     {
-#ifdef _MSC_VER
-        /* MSVC compiler: Somehow, the struct initialization containing a
-           gnc_numeric doesn't work. As an exception, we hand-initialize
-           that member afterwards. */
-        CurrencyBalance cb = { report_commodity, 0, nullptr, fn, date };
-        cb.balance = balance;
-#else
-        CurrencyBalance cb = { report_commodity, balance, nullptr, fn, date };
-#endif
+        CurrencyBalance cb = { report_commodity, { balance }, nullptr, fn, date };
 
         gnc_account_foreach_descendant (acc, xaccAccountBalanceAsOfDateHelper, &cb);
-        balance = cb.balance;
+        balance = gnc_numeric_sum (cb.balances.data (), cb.balances.size (),
+                                   gnc_commodity_get_fraction (report_commodity),
+                                   GNC_HOW_RND_ROUND_HALF_UP);
     }
 
     return balance;
@@ -3944,13 +4241,17 @@ xaccAccountGetNoclosingBalanceChangeInCurrencyForPeriod (Account *acc, time64 t1
 const SplitsVec
 xaccAccountGetSplits (const Account *account)
 {
-    return GNC_IS_ACCOUNT(account) ? GET_PRIVATE(account)->splits : SplitsVec{};
+    if (!GNC_IS_ACCOUNT(account))
+        return SplitsVec{};
+    account_fetch_splits (account);
+    return GET_PRIVATE(account)->splits;
 }
 
 SplitList *
 xaccAccountGetSplitList (const Account *acc)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), nullptr);
+    account_fetch_splits (acc);
     auto priv{GET_PRIVATE(acc)};
     return std::accumulate (priv->splits.rbegin(), priv->splits.rend(),
                             static_cast<GList*>(nullptr), g_list_prepend);
@@ -3959,13 +4260,18 @@ xaccAccountGetSplitList (const Account *acc)
 size_t
 xaccAccountGetSplitsSize (const Account *account)
 {
-    return GNC_IS_ACCOUNT(account) ? GET_PRIVATE(account)->splits.size() : 0;
+    if (!GNC_IS_ACCOUNT(account))
+        return 0;
+    account_fetch_splits (account);
+    return GET_PRIVATE(account)->splits.size();
 }
 
 gboolean gnc_account_and_descendants_empty (Account *acc)
 {
     g_return_val_if_fail (GNC_IS_ACCOUNT (acc), FALSE);
     auto priv = GET_PRIVATE (acc);
+    if (priv->splits.empty())
+        account_fetch_splits (acc);
     if (!priv->splits.empty()) return FALSE;
     return std::all_of (priv->children.begin(), priv->children.end(),
                         gnc_account_and_descendants_empty);
@@ -5500,6 +5806,7 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
     }
 
     /* Now this account */
+    account_fetch_splits (acc);
     for (auto s : priv->splits)
     {
         trans = s->parent;
@@ -5550,6 +5857,8 @@ xaccAccountForEachTransaction(const Account *acc, TransactionCallback proc,
 #define IMAP_FRAME              "import-map"
 #define IMAP_FRAME_BAYES        "import-map-bayes"
 
+static const KvpKey KEY_IMAP_FRAME(IMAP_FRAME);
+
 /* Look up an Account in the map */
 Account*
 gnc_account_imap_find_account (Account *acc,
@@ -5560,11 +5869,11 @@ gnc_account_imap_find_account (Account *acc,
     GncGUID * guid = nullptr;
     Account *retval;
     if (!acc || !key) return nullptr;
-    std::vector<std::string> path {IMAP_FRAME};
+    KeyPath path {KEY_IMAP_FRAME};
     if (category)
         path.push_back (category);
     path.push_back (key);
-    qof_instance_get_path_kvp (QOF_INSTANCE (acc), &v, path);
+    qof_instance_get_key_kvp (QOF_INSTANCE (acc), &v, path);
     if (G_VALUE_HOLDS_BOXED (&v))
         guid = (GncGUID*)g_value_get_boxed (&v);
     retval = xaccAccountLookup (guid, gnc_account_get_book(acc));
@@ -5606,14 +5915,14 @@ gnc_account_imap_add_account (Account *acc,
 {
     GValue v = G_VALUE_INIT;
     if (!acc || !key || !added_acc || (strlen (key) == 0)) return;
-    std::vector<std::string> path {IMAP_FRAME};
+    KeyPath path {KEY_IMAP_FRAME};
     if (category)
         path.emplace_back (category);
     path.emplace_back (key);
     g_value_init (&v, GNC_TYPE_GUID);
     g_value_set_boxed (&v, xaccAccountGetGUID (added_acc));
     xaccAccountBeginEdit (acc);
-    qof_instance_set_path_kvp (QOF_INSTANCE (acc), &v, path);
+    qof_instance_set_key_kvp (QOF_INSTANCE (acc), &v, path);
     qof_instance_set_dirty (QOF_INSTANCE (acc));
     xaccAccountCommitEdit (acc);
     g_value_unset (&v);
@@ -383,6 +383,17 @@ typedef enum
      *  @param defer New value for the flag. */
     void gnc_account_set_defer_bal_computation (Account *acc, gboolean defer);
 
+    /** Set the defer sort flag. If defer is true, splits inserted into the
+     * account are appended and the account is only marked as needing a
+     * sort, so that importers adding many splits pay for one sort instead
+     * of placing each split as it comes. Running balances aren't computed
+     * while the sort is deferred. Clearing the flag sorts the splits.
+     *
+     *  @param acc Set the flag on this account.
+     *
+     *  @param defer New value for the flag. */
+    void gnc_account_set_defer_sort (Account *acc, gboolean defer);
+
     /** Insert the given split from an account.
      *
      *  @param acc The account to which the split should be added.
@@ -430,6 +441,8 @@ typedef enum
     GNCPolicy *gnc_account_get_policy (Account *account);
     /** Get the account's flag for deferred balance computation */
     gboolean gnc_account_get_defer_bal_computation (Account *acc);
+    /** Get the account's flag for deferred split sorting */
+    gboolean gnc_account_get_defer_sort (Account *acc);
 
     /** The following recompute the partial balances (stored with the
      *  transaction) and the total balance, for this account
@@ -49,6 +49,14 @@ void gnc_account_foreach_split (const Account*, std::function<void(Split*)>, boo
 void gnc_account_foreach_split_until_date (const Account *acc, time64 end_date,
                                            std::function<void(Split*)> f);
 
+/** Call f on each split in acc whose transaction was posted between
+ *  start_date and end_date inclusive, in date order when the account's
+ *  splits are sorted. This bisects the splits rather than scanning them.
+ */
+void gnc_account_foreach_split_in_date_range (const Account *acc, time64 start_date,
+                                              time64 end_date,
+                                              std::function<void(Split*)> f);
+
 /** scans account split list (in forward or reverse order) until
  *    predicate split->bool returns true. Maybe return the split.
  *
@@ -54,6 +54,21 @@
  * No one outside of the engine should ever include this file.
 */
 
+/** What the balance and date scans need from each of an account's splits,
+ * kept in AccountPrivate::split_records in the same order as the splits so
+ * that those scans read one array instead of following every split to its
+ * transaction.
+ */
+struct AccountSplitRecord
+{
+    time64 date_posted;
+    /* The running balances up to and including the split. */
+    gnc_numeric balance;
+    gnc_numeric noclosing_balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+};
+
 /** \struct Account */
 typedef struct AccountPrivate
 {
@@ -118,8 +133,14 @@ typedef struct AccountPrivate
     std::optional<bool>    include_sub_account_balances;
  
     gboolean balance_dirty;     /* balances in splits incorrect */
+    /* While balance_dirty is set, the position in splits of the earliest
+     * split whose running balances are incorrect. */
+    std::size_t balance_dirty_from;
 
     std::vector<Split*> splits;              /* list of split pointers */
+    /* A record for each split, rebuilt by xaccAccountRecomputeBalance along
+     * with the running balances and good up to the same point. */
+    std::vector<AccountSplitRecord> split_records;
     GHashTable* splits_hash;
     gboolean sort_dirty;        /* sort order of splits is bad */
 
@@ -139,6 +160,7 @@ typedef struct AccountPrivate
      * account tree. */
     short mark;
     gboolean defer_bal_computation;
+    gboolean defer_sort;        /* leave sort_dirty set until cleared */
 } AccountPrivate;
 
 struct account_s
@@ -154,6 +176,10 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Mark the running balances dirty from split onward, so that
+ * xaccAccountRecomputeBalance needn't recompute the splits before it. */
+void gnc_account_set_balance_dirty_from_split (Account *acc, const Split *split);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
@@ -44,6 +44,7 @@
 #include "Query.h"
 #include "Transaction.h"
 #include "TransactionP.hpp"
+#include "qofquery-p.h"
 
 static QofLogModule log_module = GNC_MOD_QUERY;
 
@@ -631,6 +632,67 @@ xaccQueryGetLatestDateFound(QofQuery * q)
     return latest;
 }
 
+/*******************************************************************
+ *  xaccQueryIsSplitLocal
+ *******************************************************************/
+
+/* Whether a parameter path from a split only reads the split, its
+ * transaction, their other splits and the GUID of the split's account. */
+static gboolean
+split_param_path_is_local (QofQueryParamList *path)
+{
+    QofIdTypeConst type = GNC_ID_SPLIT;
+
+    for (; path; path = path->next)
+    {
+        auto name = static_cast<const char*>(path->data);
+
+        if (!g_strcmp0 (type, GNC_ID_ACCOUNT))
+            return !path->next && !g_strcmp0 (name, QOF_PARAM_GUID);
+        if (g_strcmp0 (type, GNC_ID_SPLIT) && g_strcmp0 (type, GNC_ID_TRANS))
+            return FALSE;
+        /* Running balances change with the splits before them. */
+        if (!g_strcmp0 (type, GNC_ID_SPLIT) &&
+            (!g_strcmp0 (name, SPLIT_BALANCE) ||
+             !g_strcmp0 (name, SPLIT_CLEARED_BALANCE) ||
+             !g_strcmp0 (name, SPLIT_RECONCILED_BALANCE)))
+            return FALSE;
+
+        auto param = qof_class_get_parameter (type, name);
+        if (!param)
+            return TRUE;
+        type = param->param_type;
+    }
+
+    /* Objects compare by their default sort, which reads their fields. */
+    return !qof_class_is_registered (type) ||
+        !g_strcmp0 (type, GNC_ID_SPLIT) || !g_strcmp0 (type, GNC_ID_TRANS);
+}
+
+gboolean
+xaccQueryIsSplitLocal (QofQuery *q)
+{
+    QofQuerySort *sorts[3];
+
+    if (!q || g_strcmp0 (qof_query_get_search_for (q), GNC_ID_SPLIT))
+        return FALSE;
+
+    for (auto or_node = qof_query_get_terms (q); or_node; or_node = or_node->next)
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = and_node->next)
+        {
+            auto term = static_cast<QofQueryTerm*>(and_node->data);
+            if (!split_param_path_is_local (qof_query_term_get_param_path (term)))
+                return FALSE;
+        }
+
+    qof_query_get_sorts (q, &sorts[0], &sorts[1], &sorts[2]);
+    for (auto sort : sorts)
+        if (!split_param_path_is_local (qof_query_sort_get_param_path (sort)))
+            return FALSE;
+    return TRUE;
+}
+
 void
 xaccQueryAddDescriptionMatch(QofQuery *q, const char *m, gboolean c, gboolean r,
                              QofQueryCompare h, QofQueryOp o)
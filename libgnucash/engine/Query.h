@@ -192,6 +192,15 @@ void xaccQueryAddGUIDMatch(QofQuery * q, const GncGUID *guid,
 time64 xaccQueryGetEarliestDateFound(QofQuery * q);
 time64 xaccQueryGetLatestDateFound(QofQuery * q);
 
+/** Whether the splits q matches, and the order they sort in, depend only
+ *  on the splits themselves, their transactions and their accounts' GUIDs.
+ *  Other fields of accounts, lots and commodities, and running balances,
+ *  change without events on the split or its transaction. The results of
+ *  such a query can be kept up to date with qof_query_update_results()
+ *  from the splits and transactions that events report changed.
+ */
+gboolean xaccQueryIsSplitLocal (QofQuery *q);
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,10 +57,21 @@
 #include "gnc-lot.h"
 #include "gnc-event.h"
 #include "qofinstance-p.h"
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
+#include "Account.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 const char *void_former_amt_str = "void-former-amount";
 const char *void_former_val_str = "void-former-value";
 
+static const KvpKey split_online_id_key {"online_id"};
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_ENGINE;
 
@@ -205,7 +216,7 @@ gnc_split_get_property(GObject         *object,
             qof_instance_get_kvp (QOF_INSTANCE (split), value, 2, GNC_SX_ID, GNC_SX_SHARES);
             break;
         case PROP_ONLINE_ACCOUNT:
-            qof_instance_get_kvp (QOF_INSTANCE (split), value, 1, "online_id");
+            qof_instance_get_key_kvp (QOF_INSTANCE (split), value, {split_online_id_key});
             break;
         case PROP_GAINS_SPLIT:
             qof_instance_get_kvp (QOF_INSTANCE (split), value, 1, "gains-split");
@@ -282,7 +293,7 @@ gnc_split_set_property(GObject         *object,
             qof_instance_set_kvp (QOF_INSTANCE (split), value, 2, GNC_SX_ID, GNC_SX_SHARES);
             break;
         case PROP_ONLINE_ACCOUNT:
-            qof_instance_set_kvp (QOF_INSTANCE (split), value, 1, "online_id");
+            qof_instance_set_key_kvp (QOF_INSTANCE (split), value, {split_online_id_key});
             break;
         case PROP_GAINS_SPLIT:
             qof_instance_set_kvp (QOF_INSTANCE (split), value, 1, "gains-split");
@@ -765,7 +776,8 @@ void mark_split (Split *s)
 {
     if (s->acc)
     {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, nullptr);
+        gnc_account_set_sort_dirty (s->acc);
+        gnc_account_set_balance_dirty_from_split (s->acc, s);
     }
 
     /* set dirty flag on lot too. */
@@ -1032,7 +1044,8 @@ xaccSplitCommitEdit(Split *s)
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, nullptr);
+        gnc_account_set_sort_dirty (acc);
+        gnc_account_set_balance_dirty_from_split (acc, s);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -2250,6 +2263,161 @@ qofSplitSetAccount(Split *s, QofInstance *ent)
     xaccSplitSetAccount(s, acc);
 }
 
+/* Query planning.
+ *
+ * Most split queries come from registers and reports and match the splits
+ * in a few accounts, often within a range of posting dates. Each account
+ * keeps its splits sorted by posting date, so rather than test every split
+ * in the book such a query only needs to look at the ones those accounts
+ * have in that range. The index is used only when every OR term of the
+ * query has a non-inverted "split's account is any of" term; otherwise
+ * the query falls back to scanning every split.
+ *
+ * Account membership and posting dates are read from the accounts' split
+ * lists, which follow a split when its transaction is committed. The
+ * splits of transactions still open for editing are therefore always
+ * candidates.
+ */
+
+struct SplitDateRange
+{
+    time64 start = std::numeric_limits<time64>::min();
+    time64 end = std::numeric_limits<time64>::max();
+};
+
+static bool
+param_path_is (const QofQueryParamList *path, const char *first,
+               const char *second)
+{
+    return path && path->next && !path->next->next &&
+        !g_strcmp0 (static_cast<const char*>(path->data), first) &&
+        !g_strcmp0 (static_cast<const char*>(path->next->data), second);
+}
+
+/* Narrow range to the posting dates a date term can match. */
+static void
+narrow_date_range (const query_date_def *pdata, SplitDateRange& range)
+{
+    static const SplitDateRange empty_range {std::numeric_limits<time64>::max(),
+                                             std::numeric_limits<time64>::min()};
+    if (pdata->options != QOF_DATE_MATCH_NORMAL)
+        return;
+
+    auto date{pdata->date};
+    switch (pdata->pd.how)
+    {
+    case QOF_COMPARE_LT:
+        if (date == std::numeric_limits<time64>::min())
+            range = empty_range;
+        else
+            range.end = std::min (range.end, date - 1);
+        break;
+    case QOF_COMPARE_LTE:
+        range.end = std::min (range.end, date);
+        break;
+    case QOF_COMPARE_EQUAL:
+        range.start = std::max (range.start, date);
+        range.end = std::min (range.end, date);
+        break;
+    case QOF_COMPARE_GTE:
+        range.start = std::max (range.start, date);
+        break;
+    case QOF_COMPARE_GT:
+        if (date == std::numeric_limits<time64>::max())
+            range = empty_range;
+        else
+            range.start = std::max (range.start, date + 1);
+        break;
+    default:
+        break;
+    }
+}
+
+static gboolean
+split_query_index (QofBook *book, const QofQuery *query,
+                   QofInstanceForeachCB cb, gpointer user_data)
+{
+    std::vector<std::pair<Account*, SplitDateRange>> candidates;
+    std::unordered_map<Account*, size_t> candidate_index;
+
+    auto or_terms{qof_query_get_terms (query)};
+    if (!or_terms)
+        return FALSE;
+
+    for (auto or_node = or_terms; or_node; or_node = g_list_next (or_node))
+    {
+        const query_guid_def *accounts = nullptr;
+        SplitDateRange range;
+
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = g_list_next (and_node))
+        {
+            auto term{static_cast<QofQueryTerm*>(and_node->data)};
+            auto path{qof_query_term_get_param_path (term)};
+            auto pdata{qof_query_term_get_pred_data (term)};
+
+            /* An inverted term can only reject more splits. */
+            if (!pdata || qof_query_term_is_inverted (term))
+                continue;
+
+            if (!accounts && param_path_is (path, SPLIT_ACCOUNT, QOF_PARAM_GUID) &&
+                !g_strcmp0 (pdata->type_name, QOF_TYPE_GUID))
+            {
+                auto guid_data{reinterpret_cast<const query_guid_def*>(pdata)};
+                if (guid_data->options == QOF_GUID_MATCH_ANY)
+                    accounts = guid_data;
+            }
+            else if (param_path_is (path, SPLIT_TRANS, TRANS_DATE_POSTED) &&
+                     !g_strcmp0 (pdata->type_name, QOF_TYPE_DATE))
+            {
+                narrow_date_range (reinterpret_cast<const query_date_def*>(pdata),
+                                   range);
+            }
+        }
+
+        if (!accounts)
+            return FALSE;
+        if (range.start > range.end)
+            continue;
+
+        /* An account in several OR terms is searched once, over a range
+         * spanning all of theirs. */
+        for (auto node = accounts->guids; node; node = g_list_next (node))
+        {
+            auto acc{xaccAccountLookup (static_cast<GncGUID*>(node->data), book)};
+            if (!acc)
+                continue;
+            auto [it, inserted] = candidate_index.emplace (acc, candidates.size());
+            if (inserted)
+            {
+                candidates.emplace_back (acc, range);
+                continue;
+            }
+            auto& known{candidates[it->second].second};
+            known.start = std::min (known.start, range.start);
+            known.end = std::max (known.end, range.end);
+        }
+    }
+
+    std::unordered_set<Split*> pending;
+    xaccTransForeachOpen (book, [&pending](Transaction *trans)
+                          {
+                              for (auto node = trans->splits; node; node = node->next)
+                                  pending.insert (GNC_SPLIT (node->data));
+                          });
+    for (auto s : pending)
+        cb (QOF_INSTANCE (s), user_data);
+
+    for (const auto& [acc, range] : candidates)
+        gnc_account_foreach_split_in_date_range (acc, range.start, range.end,
+                                                 [cb, user_data, &pending](Split *s)
+                                                 {
+                                                     if (!pending.count (s))
+                                                         cb (QOF_INSTANCE (s), user_data);
+                                                 });
+    return TRUE;
+}
+
 gboolean xaccSplitRegister (void)
 {
     static const QofParam params[] =
@@ -2349,6 +2517,7 @@ gboolean xaccSplitRegister (void)
                         nullptr);
     qof_class_register (SPLIT_CORR_ACCT_CODE,
                         (QofSortFunc)xaccSplitCompareOtherAccountCodes, nullptr);
+    qof_query_register_index (GNC_ID_SPLIT, split_query_index);
 
     return qof_object_register (&split_object_def);
 }
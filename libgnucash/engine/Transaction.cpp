@@ -60,6 +60,8 @@
 #include "gncInvoice.h"
 #include "gncOwner.h"
 
+#include <unordered_set>
+
 /* Notes about xaccTransBeginEdit(), xaccTransCommitEdit(), and
  *  xaccTransRollback():
  *
@@ -178,6 +180,15 @@ const char *void_former_notes_str = "void-former-notes";
 const char *trans_is_closing_str = "book_closing";
 const char *doclink_uri_str = "assoc_uri"; // this is the old name for the document link, kept for compatibility
 
+/* Keys looked up often enough to be worth a handle. */
+static const KvpKey trans_notes_key {trans_notes_str};
+static const KvpKey trans_online_id_key {"online_id"};
+
+/* The transactions between xaccTransBeginEdit and their commit or
+ * rollback. Their splits can have moved to another account or date that
+ * the accounts' split lists only learn about at the commit. */
+static std::unordered_set<Transaction*> open_transactions;
+
 /* KVP entry for date-due value */
 #define TRANS_DATE_DUE_KVP       "trans-date-due"
 #define TRANS_TXN_TYPE_KVP       "trans-txn-type"
@@ -332,7 +343,7 @@ gnc_transaction_get_property(GObject* object,
         qof_instance_get_kvp (QOF_INSTANCE (tx), value, 1, GNC_SX_FROM);
         break;
     case PROP_ONLINE_ACCOUNT:
-        qof_instance_get_kvp (QOF_INSTANCE (tx), value, 1, "online_id");
+        qof_instance_get_key_kvp (QOF_INSTANCE (tx), value, {trans_online_id_key});
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -380,7 +391,7 @@ gnc_transaction_set_property(GObject* object,
         qof_instance_set_kvp (QOF_INSTANCE (tx), value, 1, GNC_SX_FROM);
         break;
     case PROP_ONLINE_ACCOUNT:
-        qof_instance_set_kvp (QOF_INSTANCE (tx), value, 1, "online_id");
+        qof_instance_set_key_kvp (QOF_INSTANCE (tx), value, {trans_online_id_key});
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -798,6 +809,8 @@ xaccFreeTransaction (Transaction *trans)
         return;
     }
 
+    open_transactions.erase (trans);
+
     /* free up the destination splits */
     g_list_free_full (trans->splits, (GDestroyNotify)xaccFreeSplit);
     trans->splits = nullptr;
@@ -1381,6 +1394,7 @@ xaccTransBeginEdit (Transaction *trans)
 {
     if (!trans) return;
     if (!qof_begin_edit(&trans->inst)) return;
+    open_transactions.insert (trans);
 
     if (qof_book_shutting_down(qof_instance_get_book(trans))) return;
 
@@ -1551,6 +1565,7 @@ static void trans_cleanup_commit(QofInstance *inst)
     /* Put back to zero. */
     qof_instance_decrease_editlevel(trans);
     g_assert(qof_instance_get_editlevel(trans) == 0);
+    open_transactions.erase (trans);
 
     gen_event_trans (trans); //TODO: could be conditional
     qof_event_gen (&trans->inst, QOF_EVENT_MODIFY, nullptr);
@@ -1777,6 +1792,7 @@ xaccTransRollbackEdit (Transaction *trans)
 
     /* Put back to zero. */
     qof_instance_decrease_editlevel(trans);
+    open_transactions.erase (trans);
     /* FIXME: The register code seems to depend on the engine to
        generate an event during rollback, even though the state is just
        reverting to what it was. */
@@ -1791,6 +1807,14 @@ xaccTransIsOpen (const Transaction *trans)
     return trans ? (0 < qof_instance_get_editlevel(trans)) : FALSE;
 }
 
+void
+xaccTransForeachOpen (QofBook *book, std::function<void(Transaction*)> func)
+{
+    for (auto trans : open_transactions)
+        if (qof_instance_get_book (trans) == book)
+            func (trans);
+}
+
 #define SECS_PER_DAY 86400
 
 int
@@ -2118,7 +2142,7 @@ xaccTransSetNotes (Transaction *trans, const char *notes)
     g_value_init (&v, G_TYPE_STRING);
     g_value_set_static_string (&v, notes);
     xaccTransBeginEdit(trans);
-    qof_instance_set_kvp (QOF_INSTANCE (trans), &v, 1, trans_notes_str);
+    qof_instance_set_key_kvp (QOF_INSTANCE (trans), &v, {trans_notes_key});
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     g_value_unset (&v);
     xaccTransCommitEdit(trans);
@@ -2142,6 +2166,7 @@ xaccTransSetIsClosingTxn (Transaction *trans, gboolean is_closing)
     {
         qof_instance_set_kvp (QOF_INSTANCE (trans), nullptr, 1, trans_is_closing_str);
     }
+    mark_trans(trans);  /* Closing status affects sorting and noclosing balances */
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
 }
@@ -2325,7 +2350,7 @@ xaccTransGetNotes (const Transaction *trans)
     g_return_val_if_fail (trans, nullptr);
 
     GValue v = G_VALUE_INIT;
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, trans_notes_str);
+    qof_instance_get_key_kvp (QOF_INSTANCE (trans), &v, {trans_notes_key});
     const char *notes = G_VALUE_HOLDS_STRING (&v) ? g_value_get_string (&v) : nullptr;
     g_value_unset (&v);
 
@@ -2652,14 +2677,14 @@ xaccTransVoid(Transaction *trans, const char *reason)
         return;
     }
     xaccTransBeginEdit(trans);
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, trans_notes_str);
+    qof_instance_get_key_kvp (QOF_INSTANCE (trans), &v, {trans_notes_key});
     if (G_VALUE_HOLDS_STRING (&v))
         qof_instance_set_kvp (QOF_INSTANCE (trans), &v, 1, void_former_notes_str);
     else
         g_value_init (&v, G_TYPE_STRING);
 
     g_value_set_static_string (&v, _("Voided transaction"));
-    qof_instance_set_kvp (QOF_INSTANCE (trans), &v, 1, trans_notes_str);
+    qof_instance_set_key_kvp (QOF_INSTANCE (trans), &v, {trans_notes_key});
     g_value_set_static_string (&v, reason);
     qof_instance_set_kvp (QOF_INSTANCE (trans), &v, 1, void_reason_str);
 
@@ -2727,7 +2752,7 @@ xaccTransUnvoid (Transaction *trans)
 
     qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, void_former_notes_str);
     if (G_VALUE_HOLDS_STRING (&v))
-        qof_instance_set_kvp (QOF_INSTANCE (trans), &v, 1, trans_notes_str);
+        qof_instance_set_key_kvp (QOF_INSTANCE (trans), &v, {trans_notes_key});
     qof_instance_set_kvp (QOF_INSTANCE (trans), nullptr, 1, void_former_notes_str);
     qof_instance_set_kvp (QOF_INSTANCE (trans), nullptr, 1, void_reason_str);
     qof_instance_set_kvp (QOF_INSTANCE (trans), nullptr, 1, void_time_str);
@@ -52,6 +52,8 @@
 #include "SplitP.hpp"
 #include "qof.h"
 
+#include <functional>
+
 
 /** STRUCTS *********************************************************/
 /*
@@ -173,6 +175,10 @@ void xaccDisableDataScrubbing(void);
 void xaccTransRemoveSplit (Transaction *trans, const Split *split);
 void check_open (const Transaction *trans);
 
+/* Call func for each transaction in book that is open for editing. */
+void xaccTransForeachOpen (QofBook *book,
+                           std::function<void(Transaction*)> func);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
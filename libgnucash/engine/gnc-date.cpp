@@ -115,7 +115,7 @@ gnc_localtime_r (const time64 *secs, struct tm* time)
 {
     try
     {
-        *time = static_cast<struct tm>(GncDateTime(*secs));
+        *time = GncDateTime::local_tm(*secs);
         return time;
     }
     catch(std::invalid_argument&)
@@ -220,9 +220,9 @@ gnc_mktime (struct tm* time)
     try
     {
         normalize_struct_tm (time);
-        GncDateTime gncdt(*time);
-        *time = static_cast<struct tm>(gncdt);
-        return static_cast<time64>(gncdt);
+        auto secs = GncDateTime::local_time64(*time);
+        *time = GncDateTime::local_tm(secs);
+        return secs;
     }
     catch(std::invalid_argument&)
     {
@@ -1169,7 +1169,7 @@ gnc_dmy2time64_internal (int day, int month, int year, DayPart day_part)
     try
     {
         auto date = GncDate(year, month, day);
-        return static_cast<time64>(GncDateTime (date, day_part));
+        return GncDateTime::date_time64(date, day_part);
     }
     catch(const std::logic_error& err)
     {
@@ -1213,10 +1213,9 @@ GDate time64_to_gdate (time64 t)
     GDate result;
 
     g_date_clear (&result, 1);
-    GncDateTime time(t);
-    auto date = time.date().year_month_day();
-    g_date_set_dmy (&result, date.day, static_cast<GDateMonth>(date.month),
-                    date.year);
+    auto tm = GncDateTime::local_tm(t);
+    g_date_set_dmy (&result, tm.tm_mday, static_cast<GDateMonth>(tm.tm_mon + 1),
+                    tm.tm_year + 1900);
     g_assert(g_date_valid (&result));
 
     return result;
@@ -36,6 +36,8 @@
 #include <unicode/calendar.h>
 #include <libintl.h>
 #include <locale.h>
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <iostream>
@@ -276,16 +278,243 @@ LDT_from_struct_tm(const struct tm tm)
     }
 }
 
+/* Incremented whenever tzp changes so that each thread's ZoneCache knows to
+ * start over. */
+static std::atomic<unsigned int> tzp_generation{0};
+
 void
 _set_tzp(TimeZoneProvider& new_tzp)
 {
     tzp = &new_tzp;
+    ++tzp_generation;
 }
 
 void
 _reset_tzp()
 {
     tzp = &ltzp;
+    ++tzp_generation;
+}
+
+/* Converting between time64 and local calendar time through an LDT means
+ * looking up the year's zone, constructing the LDT and working out the year's
+ * DST rules, every time; registers and reports do it for every split. Instead
+ * each thread memoizes, per UTC year, the zone's offsets and the instants in
+ * that year at which DST starts or ends, found once by asking boost itself so
+ * that the results can't disagree with the LDT path. A conversion is then a
+ * lookup in that table plus calendar arithmetic.
+ */
+static constexpr time64 secs_per_day{86400};
+
+static time64
+floor_div(time64 num, time64 den) noexcept
+{
+    auto quot = num / den;
+    return quot - (num % den < 0 ? 1 : 0);
+}
+
+/* Howard Hinnant's days_from_civil and civil_from_days; days are counted
+ * from 1970-01-01 in the proleptic Gregorian calendar. */
+static time64
+days_from_civil(time64 year, unsigned int month, unsigned int day) noexcept
+{
+    year -= month <= 2;
+    auto era = floor_div(year, 400);
+    auto yoe = static_cast<unsigned int>(year - era * 400);
+    auto doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<time64>(doe) - 719468;
+}
+
+static void
+civil_from_days(time64 days, int& year, unsigned int& month,
+                unsigned int& day) noexcept
+{
+    days += 719468;
+    auto era = floor_div(days, 146097);
+    auto doe = static_cast<unsigned int>(days - era * 146097);
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(yoe + era * 400 + (month <= 2));
+}
+
+static bool
+year_in_range(int year) noexcept
+{
+    return year >= static_cast<int>(TimeZoneProvider::min_year) &&
+        year <= static_cast<int>(TimeZoneProvider::max_year);
+}
+
+static bool
+LDT_is_dst(time64 time, const TZ_Ptr& tz)
+{
+    PTime temp(unix_epoch.date(),
+               boost::posix_time::hours(time / 3600) +
+               boost::posix_time::seconds(time % 3600));
+    return LDT(temp, tz).is_dst();
+}
+
+struct ZoneYear
+{
+    time64 begin;             // UTC start of the year
+    time64 end;               // UTC start of the next year
+    TZ_Ptr zone;              // tzp->get(year)
+    time64 base;              // Standard offset from UTC in seconds
+    time64 dst;               // Added to base while DST is in effect
+    bool dst_at_begin;
+    std::vector<time64> changes; // When DST starts or ends, ascending
+
+    bool is_dst(time64 time) const noexcept
+    {
+        auto passed = std::upper_bound(changes.begin(), changes.end(), time) -
+            changes.begin();
+        return dst_at_begin != static_cast<bool>(passed & 1);
+    }
+    time64 offset(time64 time) const noexcept
+    {
+        return base + (is_dst(time) ? dst : 0);
+    }
+};
+
+/* Returns false if boost can't describe the zone's DST for the year, in
+ * which case conversions for the year use the LDT path.
+ */
+static bool
+make_zone_year(int year, ZoneYear& zy)
+{
+    zy.begin = days_from_civil(year, 1, 1) * secs_per_day;
+    zy.end = days_from_civil(year + 1, 1, 1) * secs_per_day;
+    zy.zone = tzp->get(year);
+    zy.base = zy.zone->base_utc_offset().total_seconds();
+    zy.dst = zy.zone->has_dst() ? zy.zone->dst_offset().total_seconds() : 0;
+    try
+    {
+        zy.dst_at_begin = LDT_is_dst(zy.begin, zy.zone);
+        if (!zy.zone->has_dst())
+            return true;
+        /* Boost applies the DST rule for the year of the local standard
+         * time, so the neighboring years' changes can fall in this one. */
+        for (auto rule_year = year - 1; rule_year <= year + 1; ++rule_year)
+        {
+            if (!year_in_range(rule_year))
+                continue;
+            for (auto local : {zy.zone->dst_local_start_time(rule_year),
+                               zy.zone->dst_local_end_time(rule_year)})
+            {
+                if (local.is_special())
+                    return false;
+                auto guess = (local - unix_epoch).total_seconds() - zy.base;
+                auto lo = std::max(zy.begin, guess - 2 * secs_per_day);
+                auto hi = std::min(zy.end - 1, guess + 2 * secs_per_day);
+                if (lo >= hi)
+                    continue;
+                auto lo_dst = LDT_is_dst(lo, zy.zone);
+                if (lo_dst == LDT_is_dst(hi, zy.zone))
+                    continue;
+                while (hi - lo > 1)
+                {
+                    auto mid = lo + (hi - lo) / 2;
+                    (LDT_is_dst(mid, zy.zone) == lo_dst ? lo : hi) = mid;
+                }
+                zy.changes.push_back(hi);
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+    std::sort(zy.changes.begin(), zy.changes.end());
+    zy.changes.erase(std::unique(zy.changes.begin(), zy.changes.end()),
+                     zy.changes.end());
+    return true;
+}
+
+struct ZoneCache
+{
+    unsigned int generation;
+    std::map<int, std::optional<ZoneYear>> years;
+    const ZoneYear* last;
+};
+
+/* @return The table for time's UTC year or nullptr if conversions in that
+ * year have to go through an LDT. */
+static const ZoneYear*
+zone_year(time64 time)
+{
+    thread_local ZoneCache cache{tzp_generation.load(), {}, nullptr};
+    auto generation = tzp_generation.load();
+    if (cache.generation != generation)
+    {
+        cache.years.clear();
+        cache.last = nullptr;
+        cache.generation = generation;
+    }
+    if (cache.last && cache.last->begin <= time && time < cache.last->end)
+        return cache.last;
+
+    int year;
+    unsigned int month, day;
+    civil_from_days(floor_div(time, secs_per_day), year, month, day);
+    if (!year_in_range(year))
+        return nullptr;
+    auto iter = cache.years.find(year);
+    if (iter == cache.years.end())
+    {
+        ZoneYear zy;
+        iter = cache.years.emplace(year, std::nullopt).first;
+        if (make_zone_year(year, zy))
+            iter->second = std::move(zy);
+    }
+    if (!iter->second)
+        return nullptr;
+    return cache.last = &*iter->second;
+}
+
+/* True if DST starts or ends within a few hours of time. Boost's handling of
+ * local times that are skipped or repeated depends on its view of the zone's
+ * rules, so times near a change are left for an LDT to convert.
+ */
+static bool
+near_dst_change(time64 time)
+{
+    static constexpr time64 margin{3 * 3600};
+    for (auto edge : {time - margin, time + margin})
+    {
+        auto zy = zone_year(edge);
+        if (!zy)
+            return true;
+        auto change = std::lower_bound(zy->changes.begin(), zy->changes.end(),
+                                       time - margin);
+        if (change != zy->changes.end() && *change <= time + margin)
+            return true;
+    }
+    return false;
+}
+
+/* @return The UTC time whose local time is secs after the start of the day,
+ * or nothing if it has to be found with an LDT. */
+static std::optional<time64>
+time64_from_local(int year, unsigned int month, unsigned int day, time64 secs)
+{
+    if (!year_in_range(year))
+        return {};
+    auto zy = zone_year(days_from_civil(year, 1, 1) * secs_per_day);
+    if (!zy)
+        return {};
+    auto local = days_from_civil(year, month, day) * secs_per_day + secs;
+    /* LDT_from_struct_tm uses the zone for the local year, so only believe a
+     * table that has the same zone. */
+    auto zone = zy->zone;
+    auto utc = local - zy->base;
+    auto utc_zy = zone_year(utc);
+    if (!utc_zy || utc_zy->zone != zone || near_dst_change(utc))
+        return {};
+    utc -= utc_zy->offset(utc) - zy->base;
+    return utc;
 }
 
 class GncDateTimeImpl
@@ -805,6 +1034,90 @@ GncDateTime::utc_tm() const
     return m_impl->utc_tm();
 }
 
+struct tm
+GncDateTime::local_tm(time64 time)
+{
+    auto zy = zone_year(time);
+    if (!zy)
+        return static_cast<struct tm>(GncDateTime(time));
+    auto dst = zy->is_dst(time);
+    auto offset = zy->base + (dst ? zy->dst : 0);
+    auto days = floor_div(time + offset, secs_per_day);
+    auto secs = time + offset - days * secs_per_day;
+    int year;
+    unsigned int month, day;
+    civil_from_days(days, year, month, day);
+    if (!year_in_range(year))
+        return static_cast<struct tm>(GncDateTime(time));
+    struct tm tm{};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = secs / 3600;
+    tm.tm_min = secs % 3600 / 60;
+    tm.tm_sec = secs % 60;
+    tm.tm_wday = (days % 7 + 11) % 7; // 1970-01-01 was a Thursday.
+    tm.tm_yday = days - days_from_civil(year, 1, 1);
+    tm.tm_isdst = dst;
+#if HAVE_STRUCT_TM_GMTOFF
+    tm.tm_gmtoff = offset;
+#endif
+    return tm;
+}
+
+time64
+GncDateTime::local_time64(const struct tm& tm)
+{
+    auto year = tm.tm_year + 1900;
+    auto month = static_cast<unsigned int>(tm.tm_mon + 1);
+    auto day = static_cast<unsigned int>(tm.tm_mday);
+    if (tm.tm_mon >= 0 && tm.tm_mon < 12 && tm.tm_mday >= 1 &&
+        days_from_civil(year, month, day) <
+        (month == 12 ? days_from_civil(year + 1, 1, 1) :
+         days_from_civil(year, month + 1, 1)))
+        if (auto time = time64_from_local(year, month, day,
+                                          tm.tm_hour * INT64_C(3600) +
+                                          tm.tm_min * 60 + tm.tm_sec))
+            return *time;
+    return static_cast<time64>(GncDateTime(tm));
+}
+
+time64
+GncDateTime::date_time64(const GncDate& date, DayPart part)
+{
+    static constexpr time64 neutral_secs{10 * 3600 + 59 * 60};
+    auto ymd = date.year_month_day();
+    std::optional<time64> time;
+    switch (part)
+    {
+    case DayPart::start:
+        time = time64_from_local(ymd.year, ymd.month, ymd.day, 0);
+        break;
+    case DayPart::end:
+        time = time64_from_local(ymd.year, ymd.month, ymd.day,
+                                 secs_per_day - 1);
+        break;
+    case DayPart::neutral:
+        /* As in LDT_from_date_daypart: 10:59 UTC, moved for the zones so far
+         * from UTC that it would be on a different local day. */
+        auto utc = days_from_civil(ymd.year, ymd.month, ymd.day) *
+            secs_per_day + neutral_secs;
+        if (auto zy = zone_year(utc))
+        {
+            auto offset = zy->offset(utc);
+            if (offset < -10 * 3600)
+                utc -= (offset / 3600 + 10) * 3600;
+            if (offset > 13 * 3600)
+                utc += (13 - offset / 3600) * 3600;
+            time = utc;
+        }
+        break;
+    }
+    if (time)
+        return *time;
+    return static_cast<time64>(GncDateTime(date, part));
+}
+
 GncDate
 GncDateTime::date() const
 {
@@ -129,6 +129,24 @@ public:
  * @return struct tm
  */
     struct tm utc_tm() const;
+/** Convert a time64 to a struct tm in the local timezone.
+ *
+ *  The same as static_cast<struct tm>(GncDateTime(time)), but instead of
+ *  constructing a GncDateTime it looks the UTC offset up in a per-thread table
+ *  of each year's offsets and DST changes, so it's much faster for converting
+ *  many times.
+ * @exception std::invalid_argument if the year is outside the constraints.
+ */
+    static struct tm local_tm(time64 time);
+/** Convert a struct tm in the local timezone to a time64 the same way as
+ *  static_cast<time64>(GncDateTime(tm)), using the table local_tm() uses.
+ * @exception std::invalid_argument if the year is outside the constraints.
+ */
+    static time64 local_time64(const struct tm& tm);
+/** Obtain static_cast<time64>(GncDateTime(date, part)) using the table
+ *  local_tm() uses.
+ */
+    static time64 date_time64(const GncDate& date, DayPart part);
 /** Obtain the date from the time, as a GncDate, in the current timezone.
  *  @return GncDate represented by the GncDateTime.
  */
@@ -31,6 +31,12 @@
 #include <cstdio>
 #include <sstream>
 
+/* GNC_INT128_PORTABLE forces the code for compilers without a native 128-bit
+ * integer, so that a test build can exercise it. */
+#if defined(__SIZEOF_INT128__) && !defined(GNC_INT128_PORTABLE)
+#define GNC_INT128_NATIVE 1
+#endif
+
 /* All algorithms from Donald E. Knuth, "The Art of Computer
  * Programming, Volume 2: Seminumerical Algorithms", 3rd Ed.,
  * Addison-Wesley, 1998.
@@ -59,6 +65,25 @@ namespace {
     {
         return leg & nummask;
     }
+#ifdef GNC_INT128_NATIVE
+/* GCC and Clang provide a native 128-bit integer on 64-bit targets. Its
+ * multiply is two or three hardware multiplies and its divide is the
+ * compiler runtime's, both far cheaper than working in 32-bit sublegs, so
+ * the arithmetic operators use it on the magnitudes when it's available.
+ */
+    using uint128 = unsigned __int128;
+    static inline uint128 to_uint128(uint64_t hi, uint64_t lo)
+    {
+        return (static_cast<uint128>(get_num(hi)) << GncInt128::legbits) | lo;
+    }
+    static inline unsigned int ctz128(uint128 val)
+    {
+        auto lo = static_cast<uint64_t>(val);
+        return lo ? __builtin_ctzll(lo) :
+            GncInt128::legbits +
+            __builtin_ctzll(static_cast<uint64_t>(val >> GncInt128::legbits));
+    }
+#endif
 }
 
 GncInt128::GncInt128 () : m_hi {0}, m_lo {0}{}
@@ -191,6 +216,22 @@ GncInt128::gcd(GncInt128 b) const noexcept
     if (isOverflow() || isNan())
         return *this;
 
+#ifdef GNC_INT128_NATIVE
+    auto u = to_uint128(m_hi, m_lo), v = to_uint128(b.m_hi, b.m_lo);
+    auto k = ctz128(u | v);
+    u >>= ctz128(u);
+    do
+    {
+        v >>= ctz128(v);
+        if (u > v)
+            std::swap(u, v);
+        v -= u;
+    }
+    while (v);
+    u <<= k;
+    return GncInt128(static_cast<uint64_t>(u >> legbits),
+                     static_cast<uint64_t>(u));
+#else
     GncInt128 a (isNeg() ? -(*this) : *this);
     if (b.isNeg()) b = -b;
 
@@ -213,6 +254,7 @@ GncInt128::gcd(GncInt128 b) const noexcept
         t = a - b;  //B6
     }
     return a << k;
+#endif
 }
 
 /* Since u * v = gcd(u, v) * lcm(u, v), we find lcm by u / gcd * v. */
@@ -492,6 +534,20 @@ GncInt128::operator*= (const GncInt128& b) noexcept
     if (isOverflow() || isNan())
         return *this;
 
+#ifdef GNC_INT128_NATIVE
+    uint128 product;
+    if (__builtin_mul_overflow(to_uint128(m_hi, m_lo),
+                               to_uint128(b.m_hi, b.m_lo), &product) ||
+        (static_cast<uint64_t>(product >> legbits) & flagmask))
+    {
+        flags |= overflow;
+        m_hi = set_flags(m_hi, flags);
+        return *this;
+    }
+    m_lo = static_cast<uint64_t>(product);
+    m_hi = set_flags(static_cast<uint64_t>(product >> legbits), flags);
+    return *this;
+#else
     /* Test for overflow before spending time on the calculation */
     auto hi = get_num(m_hi);
     auto bhi = get_num(b.m_hi);
@@ -584,8 +640,10 @@ GncInt128::operator*= (const GncInt128& b) noexcept
     }
     m_hi = set_flags(hi, flags);
     return *this;
+#endif
 }
 
+#ifndef GNC_INT128_NATIVE
 namespace {
 /* Algorithm from Knuth (full citation at operator*=) p272ff.  Again, there
  * are faster algorithms out there, but they require much larger numbers to
@@ -596,98 +654,70 @@ void
 div_multi_leg (uint64_t* u, size_t m, uint64_t* v, size_t n,
                GncInt128& q, GncInt128& r) noexcept
 {
-/* D1, Normalization */
-    uint64_t qv[sublegs] {};
-    uint64_t d {(UINT64_C(1) << sublegbits)/(v[n - 1] + UINT64_C(1))};
-    uint64_t carry {UINT64_C(0)};
     bool negative {q.isNeg()};
     bool rnegative {r.isNeg()};
-    for (size_t i = 0; i < m; ++i)
-    {
-        u[i] = u[i] * d + carry;
-        if (u[i] > sublegmask)
-        {
-            carry = u[i] >> sublegbits;
-            u[i] &= sublegmask;
-        }
-        else
-            carry = UINT64_C(0);
-        assert (u[i] <= sublegmask);
-    }
-    if (carry)
-    {
-        u[m++] = carry;
-        carry = UINT64_C(0);
-    }
-    for (size_t i = 0; i < n; ++i)
-    {
-        v[i] = v[i] * d + carry;
-        if (v[i] > sublegmask)
-        {
-            carry = v[i] >> sublegbits;
-            v[i] &= sublegmask;
-        }
-        else
-            carry = UINT64_C(0);
-        assert (v[i] < sublegmask);
-    }
-    assert (carry == UINT64_C(0));
-    for (int j = m - n; j >= 0; j--) //D3
+/* D1, Normalization: shift both so that v's top subleg has its high bit set,
+ * which keeps the quotient estimates in D3 within 2 of the true digit.
+ */
+    unsigned int shift {};
+    while (!(v[n - 1] << shift & (UINT64_C(1) << (sublegbits - 1))))
+        ++shift;
+    uint64_t un[sublegs + 1] {}, vn[sublegs] {}, qv[sublegs] {};
+    for (size_t i = n - 1; i > 0; --i)
+        vn[i] = ((v[i] << shift) | (v[i - 1] >> (sublegbits - shift))) &
+            sublegmask;
+    vn[0] = (v[0] << shift) & sublegmask;
+    un[m] = u[m - 1] >> (sublegbits - shift);
+    for (size_t i = m - 1; i > 0; --i)
+        un[i] = ((u[i] << shift) | (u[i - 1] >> (sublegbits - shift))) &
+            sublegmask;
+    un[0] = (u[0] << shift) & sublegmask;
+
+    for (int j = m - n; j >= 0; --j) //D2, D7
     {
-        uint64_t qhat, rhat;
-        qhat = ((u[j + n] << sublegbits) + u[j + n - 1]) / v[n - 1];
-        rhat = ((u[j + n] << sublegbits) + u[j + n - 1]) % v[n - 1];
-
+        uint64_t top {(un[j + n] << sublegbits) + un[j + n - 1]}; //D3
+        uint64_t qhat {top / vn[n - 1]}, rhat {top % vn[n - 1]};
         while (qhat > sublegmask ||
-               (rhat <= sublegmask &&
-                ((qhat * v[n - 2]) > ((rhat << sublegbits) + u[j + n - 2]))))
+               qhat * vn[n - 2] > (rhat << sublegbits) + un[j + n - 2])
         {
             --qhat;
-            rhat += v[n - 1];
+            rhat += vn[n - 1];
+            if (rhat > sublegmask)
+                break;
         }
-        carry = UINT64_C(0);
-        uint64_t borrow {};
+        uint64_t carry {}, borrow {};
         for (size_t k = 0; k < n; ++k) //D4
         {
-            auto subend = qhat * v[k] + carry;
-            carry = subend >> sublegbits;
-            subend &= sublegmask;
-            if (u[j + k] >= subend)
-            {
-                u[j + k] = u[j + k] - subend;
-                borrow = UINT64_C(0);
-            }
-            else
-            {
-                if (u[j + k + 1] > 0)
-                    --u[j + k + 1];
-                else
-                    ++borrow;
-                u[j + k] = u[j + k] + sublegmask + 1 - subend;
-                u[j + k] &= sublegmask;
-            }
+            auto product = qhat * vn[k] + carry;
+            carry = product >> sublegbits;
+            auto subend = (product & sublegmask) + borrow;
+            borrow = un[j + k] < subend ? 1 : 0;
+            un[j + k] = (un[j + k] - subend) & sublegmask;
         }
-        u[j + n] -= carry;
-        qv[j] = qhat;
-        if (borrow) //D5
-        { //D6
+        auto subend = carry + borrow;
+        borrow = un[j + n] < subend ? 1 : 0;
+        un[j + n] = (un[j + n] - subend) & sublegmask;
+        qv[j] = qhat; //D5
+        if (borrow) //D6, qhat was one too big so add v back.
+        {
             --qv[j];
             carry = UINT64_C(0);
             for (size_t k = 0; k < n; ++k)
             {
-                u[j + k] += v[k] + carry;
-                if (u[j + k] > sublegmask)
-                {
-                    carry = u[j + k] >> sublegbits;
-                    u[j + k] &= sublegmask;
-                }
+                un[j + k] += vn[k] + carry;
+                carry = un[j + k] >> sublegbits;
+                un[j + k] &= sublegmask;
             }
-            u[j + n] += carry;
+            un[j + n] = (un[j + n] + carry) & sublegmask;
         }
-    }//D7
+    }
+/* D8, Unnormalize the remainder. */
+    uint64_t rv[sublegs] {};
+    for (size_t i = 0; i < n; ++i)
+        rv[i] = ((un[i] >> shift) | (un[i + 1] << (sublegbits - shift))) &
+            sublegmask;
     q = GncInt128 ((qv[3] << sublegbits) + qv[2], (qv[1] << sublegbits) + qv[0]);
-    r = GncInt128 ((u[3] << sublegbits) + u[2], (u[1] << sublegbits) + u[0]);
-    r /= d;
+    r = GncInt128 ((rv[3] << sublegbits) + rv[2], (rv[1] << sublegbits) + rv[0]);
     if (negative) q = -q;
     if (rnegative) r = -r;
 }
@@ -718,6 +748,7 @@ div_single_leg (uint64_t* u, size_t m, uint64_t v,
 }
 
 }// namespace
+#endif
 
 void
 GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) const noexcept
@@ -789,6 +820,15 @@ GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) const noexcept
         return;
     }
 
+#ifdef GNC_INT128_NATIVE
+    auto dividend = to_uint128(m_hi, m_lo), divisor = to_uint128(b.m_hi, b.m_lo);
+    auto quotient = dividend / divisor, remainder = dividend % divisor;
+    q.m_lo = static_cast<uint64_t>(quotient);
+    q.m_hi = set_flags(static_cast<uint64_t>(quotient >> legbits), qflags);
+    r.m_lo = static_cast<uint64_t>(remainder);
+    r.m_hi = set_flags(static_cast<uint64_t>(remainder >> legbits), rflags);
+#else
+
     uint64_t u[sublegs + 2] {(m_lo & sublegmask), (m_lo >> sublegbits),
             (hi & sublegmask), (hi >> sublegbits), 0, 0};
     uint64_t v[sublegs] {(b.m_lo & sublegmask), (b.m_lo >> sublegbits),
@@ -801,6 +841,7 @@ GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) const noexcept
         return div_single_leg (u, m, v[0], q, r);
 
     return div_multi_leg (u, m, v, n, q, r);
+#endif
 }
 
 GncInt128&
@@ -29,7 +29,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <cstdint>
+#include <numeric>
 #include <sstream>
+#include <utility>
 #include <boost/regex.hpp>
 #include <boost/locale/encoding_utf.hpp>
 
@@ -417,6 +419,27 @@ GncNumeric::prepare_conversion(int64_t new_denom) const
             static_cast<int64_t>(red_conv.denom()), static_cast<int64_t>(rem)};
 }
 
+GNCNumericErrorCode
+GncNumeric::try_prepare_conversion(int64_t new_denom,
+                                   round_param& params) const noexcept
+{
+    if (new_denom == m_den || new_denom == GNC_DENOM_AUTO)
+    {
+        params = {m_num, m_den, 0};
+        return GNC_ERROR_OK;
+    }
+    /* The gcd of two int64_t can't overflow, so reduce() won't throw. */
+    auto red_conv = GncRational(new_denom, m_den).reduce();
+    auto new_num = GncInt128(m_num) * red_conv.num();
+    auto rem = new_num % red_conv.denom();
+    new_num /= red_conv.denom();
+    if (new_num.isBig())
+        return GNC_ERROR_OVERFLOW;
+    params = {static_cast<int64_t>(new_num),
+              static_cast<int64_t>(red_conv.denom()), static_cast<int64_t>(rem)};
+    return GNC_ERROR_OK;
+}
+
 int64_t
 GncNumeric::sigfigs_denom(unsigned figs) const noexcept
 {
@@ -614,8 +637,39 @@ operator/(GncNumeric a, GncNumeric b)
     return static_cast<GncNumeric>(rr);
 }
 
-template <typename T, typename I> T
-convert(T num, I new_denom, int how)
+template <RoundType RT, typename T, typename I> static inline GNCNumericErrorCode
+try_convert_rt(const T& num, I new_denom, bool sigfigs, unsigned int figs,
+            T& result) noexcept
+{
+    if (sigfigs)
+        return num.template try_convert_sigfigs<RT>(figs, result);
+    return num.template try_convert<RT>(new_denom, result);
+}
+
+static inline GNCNumericErrorCode
+try_reduce(GncNumeric& num) noexcept
+{
+    num = num.reduce();
+    return GNC_ERROR_OK;
+}
+
+static inline GNCNumericErrorCode
+try_reduce(GncRational& num) noexcept
+{
+    /* GncRational::reduce() throws only for invalid values. */
+    if (!num.valid())
+        return GNC_ERROR_OVERFLOW;
+    num = num.reduce();
+    return GNC_ERROR_OK;
+}
+
+/* Convert num as the C API's how says. Failing conversions are routine for
+ * callers rounding prices with odd denominators or checking with
+ * GNC_HOW_RND_NEVER whether a value fits, so this uses the try_convert
+ * members and returns a GNCNumericErrorCode instead of throwing.
+ */
+template <typename T, typename I> static GNCNumericErrorCode
+try_convert(T num, I new_denom, int how, T& result) noexcept
 {
     auto rtype = static_cast<RoundType>(how & GNC_NUMERIC_RND_MASK);
     unsigned int figs = GNC_HOW_GET_SIGFIGS(how);
@@ -623,64 +677,65 @@ convert(T num, I new_denom, int how)
     auto dtype = static_cast<DenomType>(how & GNC_NUMERIC_DENOM_MASK);
     bool sigfigs = dtype == DenomType::sigfigs;
     if (dtype == DenomType::reduce)
-        num = num.reduce();
+    {
+        auto err = try_reduce(num);
+        if (err != GNC_ERROR_OK)
+            return err;
+    }
 
     switch (rtype)
     {
         case RoundType::floor:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::floor>(figs);
-            else
-                return num.template convert<RoundType::floor>(new_denom);
+            return try_convert_rt<RoundType::floor>(num, new_denom, sigfigs, figs, result);
         case RoundType::ceiling:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::ceiling>(figs);
-            else
-                return num.template convert<RoundType::ceiling>(new_denom);
+            return try_convert_rt<RoundType::ceiling>(num, new_denom, sigfigs, figs, result);
         case RoundType::truncate:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::truncate>(figs);
-            else
-                return num.template convert<RoundType::truncate>(new_denom);
+            return try_convert_rt<RoundType::truncate>(num, new_denom, sigfigs, figs, result);
         case RoundType::promote:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::promote>(figs);
-            else
-                return num.template convert<RoundType::promote>(new_denom);
+            return try_convert_rt<RoundType::promote>(num, new_denom, sigfigs, figs, result);
         case RoundType::half_down:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::half_down>(figs);
-            else
-                return num.template convert<RoundType::half_down>(new_denom);
+            return try_convert_rt<RoundType::half_down>(num, new_denom, sigfigs, figs, result);
         case RoundType::half_up:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::half_up>(figs);
-            else
-                return num.template convert<RoundType::half_up>(new_denom);
+            return try_convert_rt<RoundType::half_up>(num, new_denom, sigfigs, figs, result);
         case RoundType::bankers:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::bankers>(figs);
-            else
-                return num.template convert<RoundType::bankers>(new_denom);
+            return try_convert_rt<RoundType::bankers>(num, new_denom, sigfigs, figs, result);
         case RoundType::never:
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::never>(figs);
-            else
-                return num.template convert<RoundType::never>(new_denom);
+            return try_convert_rt<RoundType::never>(num, new_denom, sigfigs, figs, result);
         default:
             /* round-truncate just returns the numerator unchanged. The old
              * gnc-numeric convert had no "default" behavior at rounding that
              * had the same result, but we need to make it explicit here to
              * run the rest of the conversion code.
              */
-            if (sigfigs)
-                return num.template convert_sigfigs<RoundType::truncate>(figs);
-            else
-                return num.template convert<RoundType::truncate>(new_denom);
-
+            return try_convert_rt<RoundType::truncate>(num, new_denom, sigfigs, figs, result);
     }
 }
 
+static inline bool
+fits_numeric(const GncNumeric&) noexcept
+{
+    return true;
+}
+
+static inline bool
+fits_numeric(const GncRational& num) noexcept
+{
+    return num.valid() && !num.is_big();
+}
+
+/* try_convert num and return the result or the error as a gnc_numeric. */
+template <typename T, typename I> static gnc_numeric
+convert_to_numeric(T num, I new_denom, int how) noexcept
+{
+    T result;
+    auto err = try_convert(num, new_denom, how, result);
+    if (err != GNC_ERROR_OK)
+        return gnc_numeric_error(err);
+    if (!fits_numeric(result))
+        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
+    return static_cast<gnc_numeric>(result);
+}
+
 /* =============================================================== */
 /* This function is small, simple, and used everywhere below,
  * lets try to inline it.
@@ -872,6 +927,79 @@ denom_lcd(gnc_numeric a, gnc_numeric b, int64_t denom, int how)
     return denom;
 }
 
+/* Most sums are of values sharing a denominator, usually the currency's
+ * 100, and the result is wanted in that same denominator. Then the full
+ * rational arithmetic below can only ever produce the plain sum of the
+ * numerators, so when it fits in 64 bits skip it. Reducing or exact
+ * denominators and significant figures can change the denominator, so
+ * those always go the long way.
+ */
+static inline bool
+fast_denom_ok (int64_t common, int64_t denom, int how) noexcept
+{
+    if (common <= 0 || (denom != GNC_DENOM_AUTO && denom != common))
+        return false;
+    auto dtype = how & GNC_NUMERIC_DENOM_MASK;
+    return dtype != GNC_HOW_DENOM_EXACT && dtype != GNC_HOW_DENOM_REDUCE &&
+        dtype != GNC_HOW_DENOM_SIGFIG;
+}
+
+/* INT64_MIN is excluded because GncInt128 considers it too big for an
+ * int64_t and the long way would round it. */
+static inline bool
+fast_result_ok (bool overflowed, int64_t result) noexcept
+{
+    return !overflowed && result != INT64_MIN;
+}
+
+static inline bool
+fast_add (gnc_numeric a, gnc_numeric b, int64_t denom, int how,
+          gnc_numeric& result) noexcept
+{
+    if (a.denom != b.denom || !fast_denom_ok (a.denom, denom, how))
+        return false;
+    int64_t num;
+    bool overflowed = __builtin_add_overflow (a.num, b.num, &num);
+    if (!fast_result_ok (overflowed, num))
+        return false;
+    result = {num, a.denom};
+    return true;
+}
+
+static inline bool
+fast_sub (gnc_numeric a, gnc_numeric b, int64_t denom, int how,
+          gnc_numeric& result) noexcept
+{
+    if (a.denom != b.denom || b.num == INT64_MIN ||
+        !fast_denom_ok (a.denom, denom, how))
+        return false;
+    int64_t num;
+    bool overflowed = __builtin_sub_overflow (a.num, b.num, &num);
+    if (!fast_result_ok (overflowed, num))
+        return false;
+    result = {num, a.denom};
+    return true;
+}
+
+/* Multiplying by a whole number keeps the other operand's denominator. A
+ * zero operand is left to the long way because it makes the product 0/1. */
+static inline bool
+fast_mul (gnc_numeric a, gnc_numeric b, int64_t denom, int how,
+          gnc_numeric& result) noexcept
+{
+    if (a.denom == 1 && b.denom != 1)
+        std::swap (a, b);
+    if (b.denom != 1 || a.num == 0 || b.num == 0 ||
+        !fast_denom_ok (a.denom, denom, how))
+        return false;
+    int64_t num;
+    bool overflowed = __builtin_mul_overflow (a.num, b.num, &num);
+    if (!fast_result_ok (overflowed, num))
+        return false;
+    result = {num, a.denom};
+    return true;
+}
+
 /* *******************************************************************
  *  gnc_numeric_add
  ********************************************************************/
@@ -884,6 +1012,9 @@ gnc_numeric_add(gnc_numeric a, gnc_numeric b,
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    gnc_numeric result;
+    if (fast_add(a, b, denom, how, result))
+        return result;
     try
     {
         denom = denom_lcd(a, b, denom, how);
@@ -891,17 +1022,14 @@ gnc_numeric_add(gnc_numeric a, gnc_numeric b,
         {
             GncNumeric an (a), bn (b);
             GncNumeric sum = an + bn;
-            return static_cast<gnc_numeric>(convert(sum, denom, how));
+            return convert_to_numeric(sum, denom, how);
         }
         GncRational ar(a), br(b);
         auto sum = ar + br;
         if (denom == GNC_DENOM_AUTO &&
             (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
             return static_cast<gnc_numeric>(sum.round_to_numeric());
-        sum = convert(sum, denom, how);
-        if (sum.is_big() || !sum.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(sum);
+        return convert_to_numeric(sum, denom, how);
     }
     catch (const std::overflow_error& err)
     {
@@ -937,6 +1065,9 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    gnc_numeric result;
+    if (fast_sub(a, b, denom, how, result))
+        return result;
     try
     {
         denom = denom_lcd(a, b, denom, how);
@@ -944,17 +1075,14 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
         {
             GncNumeric an (a), bn (b);
             auto sum = an - bn;
-            return static_cast<gnc_numeric>(convert(sum, denom, how));
+            return convert_to_numeric(sum, denom, how);
         }
         GncRational ar(a), br(b);
         auto sum = ar - br;
         if (denom == GNC_DENOM_AUTO &&
             (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
             return static_cast<gnc_numeric>(sum.round_to_numeric());
-        sum = convert(sum, denom, how);
-        if (sum.is_big() || !sum.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(sum);
+        return convert_to_numeric(sum, denom, how);
     }
     catch (const std::overflow_error& err)
     {
@@ -978,6 +1106,88 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
     }
 }
 
+/* *******************************************************************
+ *  gnc_numeric_sum
+ ********************************************************************/
+
+gnc_numeric
+gnc_numeric_sum(const gnc_numeric *values, gsize count,
+                gint64 denom, gint how)
+{
+    if (!count)
+        return gnc_numeric_zero();
+    g_return_val_if_fail (values, gnc_numeric_error(GNC_ERROR_ARG));
+    if (gnc_numeric_check(values[0]))
+        return gnc_numeric_error(GNC_ERROR_ARG);
+
+    /* Add up the run of values sharing the first one's denominator in a
+     * plain integer, then carry on the long way from wherever that stops. */
+    auto sum = values[0];
+    gsize i = 1;
+    if (fast_denom_ok(sum.denom, denom, how))
+    {
+        for (; i < count && values[i].denom == sum.denom; ++i)
+        {
+            int64_t num;
+            bool overflowed = __builtin_add_overflow(sum.num, values[i].num,
+                                                     &num);
+            if (!fast_result_ok(overflowed, num))
+                break;
+            sum.num = num;
+        }
+    }
+    for (; i < count; ++i)
+    {
+        sum = gnc_numeric_add(sum, values[i], denom, how);
+        if (gnc_numeric_check(sum))
+            return sum;
+    }
+    return sum;
+}
+
+/* *******************************************************************
+ *  gnc_numeric_to_common_denom
+ ********************************************************************/
+
+GNCNumericErrorCode
+gnc_numeric_to_common_denom(gnc_numeric *values, gsize count, gint64 *denom)
+{
+    g_return_val_if_fail (values || !count, GNC_ERROR_ARG);
+    int64_t common = 1;
+    for (gsize i = 0; i < count; ++i)
+    {
+        auto d = values[i].denom;
+        if (d <= 0)
+            return GNC_ERROR_ARG;
+        if (d == common || common % d == 0)
+            continue;
+        if (__builtin_mul_overflow(common / std::gcd(common, d), d, &common))
+            return GNC_ERROR_OVERFLOW;
+    }
+
+    /* Make sure every numerator can be scaled before touching any of them. */
+    bool scale = false;
+    for (gsize i = 0; i < count; ++i)
+    {
+        if (values[i].denom == common)
+            continue;
+        int64_t num;
+        if (__builtin_mul_overflow(values[i].num, common / values[i].denom,
+                                   &num))
+            return GNC_ERROR_OVERFLOW;
+        scale = true;
+    }
+    if (scale)
+        for (gsize i = 0; i < count; ++i)
+        {
+            values[i].num *= common / values[i].denom;
+            values[i].denom = common;
+        }
+    if (denom)
+        *denom = common;
+    return GNC_ERROR_OK;
+}
+
 /* *******************************************************************
  *  gnc_numeric_mul
  ********************************************************************/
@@ -990,6 +1200,9 @@ gnc_numeric_mul(gnc_numeric a, gnc_numeric b,
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
+    gnc_numeric result;
+    if (fast_mul(a, b, denom, how, result))
+        return result;
 
     try
     {
@@ -998,17 +1211,14 @@ gnc_numeric_mul(gnc_numeric a, gnc_numeric b,
         {
             GncNumeric an (a), bn (b);
             auto prod = an * bn;
-            return static_cast<gnc_numeric>(convert(prod, denom, how));
+            return convert_to_numeric(prod, denom, how);
         }
         GncRational ar(a), br(b);
         auto prod = ar * br;
         if (denom == GNC_DENOM_AUTO &&
             (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
             return static_cast<gnc_numeric>(prod.round_to_numeric());
-        prod = convert(prod, denom, how);
-        if (prod.is_big() || !prod.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(prod);
+        return convert_to_numeric(prod, denom, how);
      }
     catch (const std::overflow_error& err)
     {
@@ -1052,17 +1262,14 @@ gnc_numeric_div(gnc_numeric a, gnc_numeric b,
         {
             GncNumeric an (a), bn (b);
             auto quot = an / bn;
-            return static_cast<gnc_numeric>(convert(quot, denom, how));
+            return convert_to_numeric(quot, denom, how);
         }
         GncRational ar(a), br(b);
         auto quot = ar / br;
         if (denom == GNC_DENOM_AUTO &&
             (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
             return static_cast<gnc_numeric>(quot.round_to_numeric());
-        quot =  static_cast<gnc_numeric>(convert(quot, denom, how));
-        if (quot.is_big() || !quot.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(quot);
+        return convert_to_numeric(quot, denom, how);
     }
     catch (const std::overflow_error& err)
     {
@@ -1126,26 +1333,8 @@ gnc_numeric_convert(gnc_numeric in, int64_t denom, int how)
 {
     if (gnc_numeric_check(in))
         return in;
-    try
-    {
-        return convert(GncNumeric(in), denom, how);
-    }
-    catch (const std::invalid_argument& err)
-    {
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::overflow_error& err)
-    {
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::underflow_error& err)
-    {
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::domain_error& err)
-    {
-        return gnc_numeric_error(GNC_ERROR_REMAINDER);
-    }
+    /* GncNumeric(in) can't throw, gnc_numeric_check rejected 0 denominators. */
+    return convert_to_numeric(GncNumeric(in), denom, how);
 }
 
 
@@ -1267,7 +1456,7 @@ double_to_gnc_numeric(double in, gint64 denom, gint how)
     try
     {
         GncNumeric an(in);
-        return convert(an, denom, how);
+        return convert_to_numeric(an, denom, how);
     }
     catch (const std::overflow_error& err)
     {
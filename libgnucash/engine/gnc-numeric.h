@@ -394,6 +394,30 @@ gnc_numeric gnc_numeric_add(gnc_numeric a, gnc_numeric b,
 gnc_numeric gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
                             gint64 denom, gint how);
 
+/** Return the sum of count values, the same as adding each of them in turn
+ *  to the first with gnc_numeric_add(sum, value, denom, how), but without
+ *  the cost of rational arithmetic for values sharing a denominator. The
+ *  sum of no values is zero.
+ */
+gnc_numeric gnc_numeric_sum(const gnc_numeric *values, gsize count,
+                            gint64 denom, gint how);
+
+/** Convert count values in place to the least common multiple of their
+ *  denominators, so that they can be compared or added as plain integers.
+ *  Values already sharing a denominator are left as they are, so a run of
+ *  amounts in one commodity costs a comparison each.
+ *
+ *  @param values The values to convert. All must have positive denominators.
+ *  @param count The number of values.
+ *  @param denom If not NULL, set to the common denominator on success.
+ *  @return GNC_ERROR_OK, GNC_ERROR_ARG if a value is an error or has a
+ *  denominator <= 0, or GNC_ERROR_OVERFLOW if the common denominator or one
+ *  of the converted numerators doesn't fit in a gint64. Nothing is changed
+ *  unless the result is GNC_ERROR_OK.
+ */
+GNCNumericErrorCode gnc_numeric_to_common_denom(gnc_numeric *values,
+                                                gsize count, gint64 *denom);
+
 /** Multiply a times b, returning the product.  An overflow
  *  may occur if the result of the multiplication can't
  *  be represented as a ratio of 64-bit int's after removing
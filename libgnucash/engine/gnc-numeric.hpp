@@ -47,6 +47,8 @@ class GncRational;
  * * Overflowing 128 bits will raise a std::overflow_error.
  * * Failure to convert a number as specified by the arguments to convert() will
  * raise a std::domain_error.
+ * try_convert() and try_convert_sigfigs() report conversion failures with a
+ * GNCNumericErrorCode instead, for callers that expect them to be common.
  *
  * Rounding Policy: GncNumeric provides a convert() member function that object
  * amount and value setters (and *only* those functions!) should call to set a
@@ -200,6 +202,33 @@ public:
                                 params.rem, RT2T<RT>()), new_denom);
     }
 
+    /**
+     * Convert a GncNumeric to use a new denominator without throwing. Use this
+     * instead of convert() where failing conversions are expected often enough
+     * for exceptions to be costly.
+     *
+     * \param new_denom The new denominator to convert the fraction to.
+     * \param result Set to the converted value on success, unchanged
+     * otherwise.
+     * \return GNC_ERROR_OK, GNC_ERROR_REMAINDER if RoundType::never would have
+     * to round or GNC_ERROR_OVERFLOW if the result doesn't fit.
+     */
+    template <RoundType RT>
+    GNCNumericErrorCode try_convert(int64_t new_denom,
+                                    GncNumeric& result) const noexcept
+    {
+        round_param params;
+        auto err = try_prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == GNC_DENOM_AUTO)
+            new_denom = m_den;
+        int64_t num;
+        err = try_round(params.num, params.den, params.rem, RT2T<RT>(), num);
+        if (err == GNC_ERROR_OK)
+            result = GncNumeric(num, new_denom);
+        return err;
+    }
     /**
      * Convert with the specified sigfigs. The resulting denominator depends on
      * the value of the GncNumeric, such that the specified significant digits
@@ -223,6 +252,26 @@ public:
         return GncNumeric(round(params.num, params.den,
                                 params.rem, RT2T<RT>()), new_denom);
     }
+    /**
+     * convert_sigfigs() without throwing; see try_convert().
+     */
+    template <RoundType RT>
+    GNCNumericErrorCode try_convert_sigfigs(unsigned int figs,
+                                            GncNumeric& result) const noexcept
+    {
+        auto new_denom(sigfigs_denom(figs));
+        round_param params;
+        auto err = try_prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == 0)
+            new_denom = 1;
+        int64_t num;
+        err = try_round(params.num, params.den, params.rem, RT2T<RT>(), num);
+        if (err == GNC_ERROR_OK)
+            result = GncNumeric(num, new_denom);
+        return err;
+    }
     /**
      * Return a string representation of the GncNumeric. See operator<< for
      * details.
@@ -277,6 +326,10 @@ private:
      * finish computing a GncNumeric with the new denominator.
      */
     round_param prepare_conversion(int64_t new_denom) const;
+    /* prepare_conversion() for try_convert(), returning GNC_ERROR_OVERFLOW
+     * instead of throwing. */
+    GNCNumericErrorCode try_prepare_conversion(int64_t new_denom,
+                                               round_param& params) const noexcept;
     int64_t m_num;
     int64_t m_den;
 };
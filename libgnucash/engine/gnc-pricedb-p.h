@@ -51,6 +51,10 @@ struct gnc_price_s
     guint32  refcount;             /* garbage collection reference count */
 };
 
+/* Opaque time-sorted index of the prices for each commodity/currency
+ * pair; it's a C++ object defined in gnc-pricedb.cpp. */
+struct gnc_price_series_index_s;
+
 struct _GncPriceClass
 {
     QofInstanceClass parent_class;
@@ -60,6 +64,7 @@ struct gnc_price_db_s
 {
     QofInstance inst;              /* globally unique object identifier */
     GHashTable *commodity_hash;
+    struct gnc_price_series_index_s *series_index;
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
     gboolean reset_nth_price_cache;
 };
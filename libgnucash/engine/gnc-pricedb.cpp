@@ -32,6 +32,10 @@
 #include "gnc-pricedb-p.h"
 #include <qofinstance-p.h>
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_PRICE;
 
@@ -40,10 +44,6 @@ static gboolean remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup);
 static GNCPrice *lookup_nearest_in_time(GNCPriceDB *db, const gnc_commodity *c,
                                         const gnc_commodity *currency,
                                         time64 t, gboolean sameday);
-static gboolean
-pricedb_pricelist_traversal(GNCPriceDB *db,
-                            gboolean (*f)(GList *p, gpointer user_data),
-                            gpointer user_data);
 
 enum
 {
@@ -766,6 +766,176 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* price series index
+
+   Walking a PriceList to find the price nearest to a time is linear in
+   the length of the price history, and reports do a great many such
+   lookups. To make them logarithmic the price database also keeps, for
+   each commodity/currency pair, a vector of the pair's prices sorted
+   oldest first, i.e. in exactly the reverse of PriceList order, which
+   can be binary searched. add_price() and remove_price() keep the
+   series in step with the lists in the commodity hash.
+ */
+
+using PriceSeries = std::vector<GNCPrice*>;
+using PriceSeriesKey = std::pair<const gnc_commodity*, const gnc_commodity*>;
+
+struct PriceSeriesKeyHash
+{
+    std::size_t operator()(const PriceSeriesKey& key) const noexcept
+    {
+        std::hash<const gnc_commodity*> hasher;
+        return hasher (key.first) ^ (hasher (key.second) << 1);
+    }
+};
+
+struct gnc_price_series_index_s
+{
+    std::unordered_map<PriceSeriesKey, PriceSeries, PriceSeriesKeyHash> series;
+    /* The series in which each commodity appears on either side, for the
+     * any-currency lookups. */
+    std::unordered_map<const gnc_commodity*, std::vector<const PriceSeries*>> by_commodity;
+};
+
+/* True if a sorts before b in a series, i.e. after b in a PriceList. */
+static inline bool
+price_series_less (const GNCPrice *a, const GNCPrice *b)
+{
+    return compare_prices_by_date (a, b) > 0;
+}
+
+/* Of two prices, the one that would come first in a PriceList. Either may be
+ * null. */
+static inline GNCPrice *
+price_series_newer (GNCPrice *a, GNCPrice *b)
+{
+    if (!a) return b;
+    if (!b) return a;
+    return compare_prices_by_date (a, b) <= 0 ? a : b;
+}
+
+/* Of two prices, the one that would come last in a PriceList. Either may be
+ * null. */
+static inline GNCPrice *
+price_series_older (GNCPrice *a, GNCPrice *b)
+{
+    if (!a) return b;
+    if (!b) return a;
+    return compare_prices_by_date (a, b) > 0 ? a : b;
+}
+
+/* Position of the first price in the series that is later than t. */
+static inline PriceSeries::size_type
+price_series_upper_bound (const PriceSeries& series, time64 t)
+{
+    auto it = std::upper_bound (series.begin(), series.end(), t,
+                                [](time64 time, const GNCPrice *p)
+                                { return time < p->tmspec; });
+    return it - series.begin();
+}
+
+/* Position of the first price in the series that isn't earlier than t. */
+static inline PriceSeries::size_type
+price_series_lower_bound (const PriceSeries& series, time64 t)
+{
+    auto it = std::lower_bound (series.begin(), series.end(), t,
+                                [](const GNCPrice *p, time64 time)
+                                { return p->tmspec < time; });
+    return it - series.begin();
+}
+
+static const PriceSeries*
+price_series_lookup (const GNCPriceDB *db, const gnc_commodity *commodity,
+                     const gnc_commodity *currency)
+{
+    if (!db->series_index)
+        return nullptr;
+    const auto& series = db->series_index->series;
+    auto it = series.find ({commodity, currency});
+    if (it == series.end() || it->second.empty())
+        return nullptr;
+    return &it->second;
+}
+
+/* Inserts p in its commodity/currency series. If check_dupl is set and the
+ * series already has a price for the same day and value, p is not inserted
+ * and FALSE is returned. Because a day's prices are contiguous in the series
+ * only the neighbors of p's position need to be checked. */
+static gboolean
+price_series_insert (GNCPriceDB *db, GNCPrice *p, gboolean check_dupl)
+{
+    auto index = db->series_index;
+    auto [entry, created] = index->series.try_emplace (PriceSeriesKey{p->commodity, p->currency});
+    auto& series = entry->second;
+    if (created)
+    {
+        index->by_commodity[p->commodity].push_back (&series);
+        if (p->currency != p->commodity)
+            index->by_commodity[p->currency].push_back (&series);
+    }
+
+    auto pos = std::upper_bound (series.begin(), series.end(), p,
+                                 price_series_less);
+    if (check_dupl)
+    {
+        auto day = time64CanonicalDayTime (p->tmspec);
+        for (auto it = pos; it != series.begin(); --it)
+        {
+            auto prev = *std::prev (it);
+            if (time64CanonicalDayTime (prev->tmspec) != day)
+                break;
+            if (!price_is_duplicate (p, prev))
+                return FALSE;
+        }
+        for (auto it = pos; it != series.end(); ++it)
+        {
+            if (time64CanonicalDayTime ((*it)->tmspec) != day)
+                break;
+            if (!price_is_duplicate (p, *it))
+                return FALSE;
+        }
+    }
+
+    series.insert (pos, p);
+    return TRUE;
+}
+
+static void
+price_series_remove (GNCPriceDB *db, GNCPrice *p)
+{
+    auto index = db->series_index;
+    auto entry = index->series.find ({p->commodity, p->currency});
+    if (entry == index->series.end())
+        return;
+
+    auto& series = entry->second;
+    auto range = std::equal_range (series.begin(), series.end(), p,
+                                   price_series_less);
+    auto pos = std::find (range.first, range.second, p);
+    /* Someone changed the date or GUID behind our back, do it the hard way. */
+    if (pos == range.second)
+        pos = std::find (series.begin(), series.end(), p);
+    if (pos == series.end())
+        return;
+
+    series.erase (pos);
+    if (!series.empty())
+        return;
+
+    for (auto com : {p->commodity, p->currency})
+    {
+        auto users = index->by_commodity.find (com);
+        if (users == index->by_commodity.end())
+            continue;
+        auto& vec = users->second;
+        vec.erase (std::remove (vec.begin(), vec.end(), &series), vec.end());
+        if (vec.empty())
+            index->by_commodity.erase (users);
+    }
+    index->series.erase (entry);
+}
+
 /* ==================================================================== */
 /* GNCPriceDB functions
 
@@ -774,7 +944,8 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
    type gnc_commodity*) to GNCPrice lists (see gnc-pricedb.h for a
    description of GNCPrice lists).  The top-level key is the commodity
    you want the prices for, and the second level key is the commodity
-   that the value is expressed in terms of.
+   that the value is expressed in terms of. The series index described
+   above duplicates the price lists in a form suited to lookups by time.
  */
 
 /* GObject Initialization */
@@ -826,6 +997,7 @@ gnc_pricedb_create(QofBook * book)
 
     result->commodity_hash = g_hash_table_new(nullptr, nullptr);
     g_return_val_if_fail (result->commodity_hash, nullptr);
+    result->series_index = new gnc_price_series_index_s;
     return result;
 }
 
@@ -873,6 +1045,8 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = nullptr;
+    delete db->series_index;
+    db->series_index = nullptr;
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -1076,8 +1250,16 @@ add_price(GNCPriceDB *db, GNCPrice *p)
     }
 
     price_list = static_cast<GList*>(g_hash_table_lookup(currency_hash, currency));
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
+    /* The series does the duplicate check without scanning the whole list. */
+    if (!price_series_insert(db, p, !db->bulk_update))
+    {
+        /* A duplicate; as gnc_price_list_insert does, keep the ref and
+         * report success without inserting it. */
+        gnc_price_ref(p);
+    }
+    else if (!gnc_price_list_insert(&price_list, p, FALSE))
     {
+        price_series_remove(db, p);
         LEAVE ("gnc_price_list_insert failed");
         return FALSE;
     }
@@ -1183,6 +1365,7 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
         LEAVE (" cannot remove price list");
         return FALSE;
     }
+    price_series_remove(db, p);
 
     /* if the price list is empty, then remove this currency from the
        commodity hash */
@@ -1734,20 +1917,24 @@ GNCPrice *gnc_pricedb_lookup_latest(GNCPriceDB *db,
                           const gnc_commodity *commodity,
                           const gnc_commodity *currency)
 {
-    GList *price_list;
-    GNCPrice *result;
+    GNCPrice *result = nullptr;
 
     if (!db || !commodity || !currency) return nullptr;
     ENTER ("db=%p commodity=%p currency=%p", db, commodity, currency);
 
-    price_list = pricedb_get_prices_internal(db, commodity, currency, TRUE);
-    if (!price_list) return nullptr;
-    /* This works magically because prices are inserted in date-sorted
-     * order, and the latest date always comes first. So return the
-     * first in the list.  */
-    result = static_cast<GNCPrice*>(price_list->data);
+    /* The series are sorted oldest first so the latest price is at the back
+     * of one of them. */
+    for (auto series : {price_series_lookup (db, commodity, currency),
+                        price_series_lookup (db, currency, commodity)})
+        if (series)
+            result = price_series_newer (result, series->back());
+
+    if (!result)
+    {
+        LEAVE ("no price list");
+        return nullptr;
+    }
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE("price is %p", result);
     return result;
 }
@@ -1759,66 +1946,44 @@ typedef struct
     time64 t;
 } UsesCommodity;
 
-/* price_list_scan_any_currency is the helper function used with
- * pricedb_pricelist_traversal by the "any_currency" price lookup functions. It
- * builds a list of prices that are either to or from the commodity "com".
- * The resulting list will include the last price newer than "t" and the first
- * price older than "t".  All other prices will be ignored.  Since in the most
- * common cases we will be looking for recent prices which are at the front of
- * the various price lists, this is considerably faster than concatenating all
- * the relevant price lists and sorting the result.
+/* price_series_scan_any_currency is the helper used by the "any_currency"
+ * price lookup functions. It builds a list of prices that are either to or
+ * from the commodity "com". From each series the resulting list will include
+ * the last price newer than "t" and the first price older than "t", or the
+ * oldest price if none are older. All other prices will be ignored. This is
+ * considerably faster than concatenating all the relevant price lists and
+ * sorting the result.
 */
 
-static gboolean
-price_list_scan_any_currency(GList *price_list, gpointer data)
+static void
+price_series_scan_any_currency(GNCPriceDB *db, UsesCommodity *helper)
 {
-    UsesCommodity *helper = (UsesCommodity*)data;
-    gnc_commodity *com;
-    gnc_commodity *cur;
-
-    if (!price_list)
-        return TRUE;
-
-    auto price = static_cast<GNCPrice*>(price_list->data);
-    com = gnc_price_get_commodity(price);
-    cur = gnc_price_get_currency(price);
-
-    /* if this price list isn't for the commodity we are interested in,
-       ignore it. */
-    if (com != helper->com && cur != helper->com)
-        return TRUE;
+    auto index = db->series_index;
+    if (!index)
+        return;
+    auto users = index->by_commodity.find (helper->com);
+    if (users == index->by_commodity.end())
+        return;
 
-    /* The price list is sorted in decreasing order of time.  Find the first
-       price on it that is older than the requested time and add it and the
-       previous price to the result list. */
-    for (auto node = price_list; node; node = g_list_next (node))
+    for (auto series : users->second)
     {
-        price = static_cast<GNCPrice*>(node->data);
-        time64 price_t = gnc_price_get_time64(price);
-        if (price_t < helper->t)
+        auto older = price_series_lower_bound (*series, helper->t);
+        if (older == 0)
         {
-            /* If there is a previous price add it to the results. */
-            if (node->prev)
-            {
-                auto prev_price = static_cast<GNCPrice*>(node->prev->data);
-                gnc_price_ref(prev_price);
-                *helper->list = g_list_prepend(*helper->list, prev_price);
-            }
-            /* Add the first price before the desired time */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
-            /* No point in looking further, they will all be older */
-            break;
+            /* Every price is later than the given time, add the oldest. */
+            gnc_price_ref (series->front());
+            *helper->list = g_list_prepend (*helper->list, series->front());
+            continue;
         }
-        else if (node->next == nullptr)
+        /* The first price before the desired time and the one after it. */
+        gnc_price_ref ((*series)[older - 1]);
+        *helper->list = g_list_prepend (*helper->list, (*series)[older - 1]);
+        if (older < series->size())
         {
-            /* The last price is later than given time, add it */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
+            gnc_price_ref ((*series)[older]);
+            *helper->list = g_list_prepend (*helper->list, (*series)[older]);
         }
     }
-
-    return TRUE;
 }
 
 /* This operates on the principal that the prices are sorted by date and that we
@@ -1973,7 +2138,7 @@ gnc_pricedb_lookup_nearest_in_time_any_currency_t64(GNCPriceDB *db,
     if (!db || !commodity) return nullptr;
     ENTER ("db=%p commodity=%p", db, commodity);
 
-    pricedb_pricelist_traversal(db, price_list_scan_any_currency, &helper);
+    price_series_scan_any_currency(db, &helper);
     prices = g_list_sort(prices, compare_prices_by_date);
     result = nearest_to(prices, commodity, t);
     gnc_price_list_destroy(prices);
@@ -1993,8 +2158,7 @@ gnc_pricedb_lookup_nearest_before_any_currency_t64(GNCPriceDB *db,
     if (!db || !commodity) return nullptr;
     ENTER ("db=%p commodity=%p", db, commodity);
 
-    pricedb_pricelist_traversal(db, price_list_scan_any_currency,
-                                       &helper);
+    price_series_scan_any_currency(db, &helper);
     prices = g_list_sort(prices, compare_prices_by_date);
     result = latest_before(prices, commodity, t);
     gnc_price_list_destroy(prices);
@@ -2185,7 +2349,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        time64 t,
                        gboolean sameday)
 {
-    GList *price_list;
     GNCPrice *current_price = nullptr;
     GNCPrice *next_price = nullptr;
     GNCPrice *result = nullptr;
@@ -2193,26 +2356,32 @@ lookup_nearest_in_time(GNCPriceDB *db,
     if (!db || !c || !currency) return nullptr;
     if (t == INT64_MAX) return nullptr;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return nullptr;
-
-    /* default answer */
-    current_price = static_cast<GNCPrice*>(price_list->data);
+    auto forward = price_series_lookup (db, c, currency);
+    auto reverse = price_series_lookup (db, currency, c);
+    if (!forward && !reverse)
+    {
+        LEAVE ("no price list");
+        return nullptr;
+    }
 
-    /* find the first candidate past the one we want.  Remember that
-       prices are in most-recent-first order. */
-    for (auto item = price_list; item; item = g_list_next (item))
+    /* next_price is the latest price not after t and current_price the
+       earliest one after it. */
+    for (auto series : {forward, reverse})
     {
-        auto p = static_cast<GNCPrice*>(item->data);
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time <= t)
-        {
-            next_price = static_cast<GNCPrice*>(item->data);
-            break;
-        }
-        current_price = static_cast<GNCPrice*>(item->data);
+        if (!series)
+            continue;
+        auto later = price_series_upper_bound (*series, t);
+        if (later > 0)
+            next_price = price_series_newer (next_price, (*series)[later - 1]);
+        if (later < series->size())
+            current_price = price_series_older (current_price, (*series)[later]);
     }
 
+    /* If the requested time is not earlier than the latest price then
+       current_price and next_price are the same. */
+    if (!current_price)
+        current_price = next_price;
+
     if (current_price)      /* How can this be null??? */
     {
         if (!next_price)
@@ -2283,7 +2452,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
     }
 
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE (" ");
     return result;
 }
@@ -2297,12 +2465,6 @@ gnc_pricedb_lookup_nearest_in_time64(GNCPriceDB *db,
     return lookup_nearest_in_time(db, c, currency, t, FALSE);
 }
 
-// return 0 if price's time is less or equal to time
-static int price_time64_less_or_equal (GNCPrice *p, time64 *time)
-{
-    return !(gnc_price_get_time64 (p) <= *time);
-}
-
 GNCPrice *
 gnc_pricedb_lookup_nearest_before_t64 (GNCPriceDB *db,
                                        const gnc_commodity *c,
@@ -2312,15 +2474,18 @@ gnc_pricedb_lookup_nearest_before_t64 (GNCPriceDB *db,
     GNCPrice *current_price = nullptr;
     if (!db || !c || !currency) return nullptr;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    auto price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return nullptr;
-    auto p = g_list_find_custom (price_list, &t, (GCompareFunc)price_time64_less_or_equal);
-    if (p)
+    for (auto series : {price_series_lookup (db, c, currency),
+                        price_series_lookup (db, currency, c)})
     {
-        current_price = GNC_PRICE (p->data);
-        gnc_price_ref (current_price);
+        if (!series)
+            continue;
+        auto later = price_series_upper_bound (*series, t);
+        if (later > 0)
+            current_price = price_series_newer (current_price,
+                                                (*series)[later - 1]);
     }
-    g_list_free (price_list);
+    if (current_price)
+        gnc_price_ref (current_price);
     LEAVE (" ");
     return current_price;
 }
@@ -2637,54 +2802,6 @@ unstable_price_traversal(GNCPriceDB *db,
     return foreach_data.ok;
 }
 
-/* foreach_pricelist */
-typedef struct
-{
-    gboolean ok;
-    gboolean (*func)(GList *p, gpointer user_data);
-    gpointer user_data;
-} GNCPriceListForeachData;
-
-static void
-pricedb_pricelist_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
-{
-    GList *price_list = (GList *) val;
-    GNCPriceListForeachData *foreach_data = (GNCPriceListForeachData *) user_data;
-    if (foreach_data->ok)
-    {
-        foreach_data->ok = foreach_data->func(price_list, foreach_data->user_data);
-    }
-}
-
-static void
-pricedb_pricelist_foreach_currencies_hash(gpointer key, gpointer val, gpointer user_data)
-{
-    GHashTable *currencies_hash = (GHashTable *) val;
-    g_hash_table_foreach(currencies_hash, pricedb_pricelist_foreach_pricelist, user_data);
-}
-
-static gboolean
-pricedb_pricelist_traversal(GNCPriceDB *db,
-                         gboolean (*f)(GList *p, gpointer user_data),
-                         gpointer user_data)
-{
-    GNCPriceListForeachData foreach_data;
-
-    if (!db || !f) return FALSE;
-    foreach_data.ok = TRUE;
-    foreach_data.func = f;
-    foreach_data.user_data = user_data;
-    if (db->commodity_hash == nullptr)
-    {
-        return FALSE;
-    }
-    g_hash_table_foreach(db->commodity_hash,
-                         pricedb_pricelist_foreach_currencies_hash,
-                         &foreach_data);
-
-    return foreach_data.ok;
-}
-
 static bool
 compare_hash_entries_by_commodity_key (const CommodityPtrPair& he_a, const CommodityPtrPair& he_b)
 {
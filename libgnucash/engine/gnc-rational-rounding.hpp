@@ -220,4 +220,17 @@ round<GncInt128>(GncInt128 num, GncInt128 den, GncInt128 rem,
         return num + (num.isNeg() ? -1 : 1);
     return num;
 }
+
+/* The status-returning counterpart of round() for the try_convert functions:
+ * rather than throwing when RoundType::never would have to round it returns
+ * GNC_ERROR_REMAINDER. None of the other policies can fail.
+ */
+template <typename T, RoundType RT> inline GNCNumericErrorCode
+try_round(T num, T den, T rem, RT2T<RT> rt, T& result) noexcept
+{
+    if (RT == RoundType::never && rem != 0)
+        return GNC_ERROR_REMAINDER;
+    result = round(num, den, rem, rt);
+    return GNC_ERROR_OK;
+}
 #endif //__GNC_RATIONAL_ROUNDING_HPP__
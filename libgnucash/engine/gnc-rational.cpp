@@ -156,6 +156,29 @@ GncRational::prepare_conversion (GncInt128 new_denom) const
     return {new_num, red_conv.denom(), rem};
 }
 
+GNCNumericErrorCode
+GncRational::try_prepare_conversion (GncInt128 new_denom,
+                                     round_param& params) const noexcept
+{
+    if (new_denom == m_den || new_denom == GNC_DENOM_AUTO)
+    {
+        params = {m_num, m_den, 0};
+        return GNC_ERROR_OK;
+    }
+    /* reduce() only throws when the gcd of its members is invalid, which
+     * needs one of them to be invalid already. */
+    if (!valid() || !new_denom.valid())
+        return GNC_ERROR_OVERFLOW;
+    auto red_conv = GncRational(new_denom, m_den).reduce();
+    auto new_num = m_num * red_conv.num();
+    if (new_num.isOverflow())
+        return GNC_ERROR_OVERFLOW;
+    auto rem = new_num % red_conv.denom();
+    new_num /= red_conv.denom();
+    params = {new_num, red_conv.denom(), rem};
+    return GNC_ERROR_OK;
+}
+
 GncInt128
 GncRational::sigfigs_denom(unsigned figs) const noexcept
 {
@@ -206,18 +229,12 @@ GncRational::round_to_numeric() const
         GncRational new_v;
         while (new_v.num().isZero())
         {
-            try
-            {
-                new_v = convert<RoundType::half_down>(m_den / (m_num.abs() >> ll_bits));
-                if (new_v.is_big())
-                {
-                    --ll_bits;
-                    new_v = GncRational();
-                }
-            }
-            catch(const std::overflow_error& err)
+            if (try_convert<RoundType::half_down>(m_den / (m_num.abs() >> ll_bits),
+                                                  new_v) != GNC_ERROR_OK ||
+                new_v.is_big())
             {
                 --ll_bits;
+                new_v = GncRational();
             }
         }
         return new_v;
@@ -50,6 +50,8 @@ enum class DenomType;
  * * Overflowing 128 bits will raise a std::overflow_error.
  * * Failure to convert a number as specified by the arguments to convert() will
  * raise a std::domain_error.
+ * try_convert() and try_convert_sigfigs() report conversion failures with a
+ * GNCNumericErrorCode instead, for callers that expect them to be common.
  *
  */
 
@@ -125,6 +127,33 @@ public:
                                  params.rem, RT2T<RT>()), new_denom);
     }
 
+    /**
+     * Convert a GncRational to use a new denominator without throwing; see
+     * GncNumeric::try_convert().
+     *
+     * \param new_denom The new denominator to convert the fraction to.
+     * \param result Set to the converted value on success, unchanged
+     * otherwise.
+     * \return GNC_ERROR_OK, GNC_ERROR_REMAINDER if RoundType::never would have
+     * to round or GNC_ERROR_OVERFLOW if the calculation overflows.
+     */
+    template <RoundType RT>
+    GNCNumericErrorCode try_convert(GncInt128 new_denom,
+                                    GncRational& result) const noexcept
+    {
+        round_param params;
+        auto err = try_prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == GNC_DENOM_AUTO)
+            new_denom = m_den;
+        GncInt128 num;
+        err = try_round(params.num, params.den, params.rem, RT2T<RT>(), num);
+        if (err == GNC_ERROR_OK)
+            result = GncRational(num, new_denom);
+        return err;
+    }
+
     /**
      * Convert with the specified sigfigs. The resulting denominator depends on
      * the value of the GncRational, such that the specified significant digits
@@ -149,6 +178,25 @@ public:
                                 params.rem, RT2T<RT>()), new_denom);
     }
 
+    /** convert_sigfigs() without throwing; see try_convert(). */
+    template <RoundType RT>
+    GNCNumericErrorCode try_convert_sigfigs(unsigned int figs,
+                                            GncRational& result) const noexcept
+    {
+        auto new_denom(sigfigs_denom(figs));
+        round_param params;
+        auto err = try_prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == 0)
+            new_denom = 1;
+        GncInt128 num;
+        err = try_round(params.num, params.den, params.rem, RT2T<RT>(), num);
+        if (err == GNC_ERROR_OK)
+            result = GncRational(num, new_denom);
+        return err;
+    }
+
     /** Numerator accessor */
     GncInt128 num() const noexcept { return m_num; }
     /** Denominator accessor */
@@ -190,6 +238,10 @@ private:
      * finish computing a GncNumeric with the new denominator.
      */
     round_param prepare_conversion(GncInt128 new_denom) const;
+    /* prepare_conversion() for try_convert(), returning GNC_ERROR_OVERFLOW
+     * instead of throwing. */
+    GNCNumericErrorCode try_prepare_conversion(GncInt128 new_denom,
+                                               round_param& params) const noexcept;
     GncInt128 m_num;
     GncInt128 m_den;
 };
@@ -39,60 +39,337 @@
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = "qof.kvp";
 
+/* Every frame and value is preceded by a header holding the arena it came
+ * from, or nullptr if it came from the free store, so that operator delete
+ * can send it back to the right place.
+ */
+static constexpr size_t chunk_align =
+    std::max (alignof (KvpFrameImpl), alignof (KvpValueImpl));
+static constexpr size_t chunk_header_size =
+    (sizeof (KvpFrameArena*) + chunk_align - 1) / chunk_align * chunk_align;
+
+class KvpFrameArena
+{
+public:
+    void* allocate_frame () { return allocate (m_frames); }
+    void* allocate_value () { return allocate (m_values); }
+    void deallocate_frame (void* frame) noexcept { deallocate (m_frames, frame); }
+    void deallocate_value (void* value) noexcept { deallocate (m_values, value); }
+    void release () noexcept;
+    void get_frame_stats (size_t& allocated, size_t& live, size_t& bytes) const noexcept
+    {
+        m_frames.get_stats (allocated, live, bytes);
+    }
+    void get_value_stats (size_t& allocated, size_t& live, size_t& bytes) const noexcept
+    {
+        m_values.get_stats (allocated, live, bytes);
+    }
+
+private:
+    static constexpr size_t chunks_per_block = 1024;
+
+    /* Chunks of one size, carved from blocks of chunks_per_block. */
+    struct Pool
+    {
+        explicit Pool (size_t object_size) :
+            chunk_size {(chunk_header_size + object_size + chunk_align - 1) /
+                        chunk_align * chunk_align} {}
+        void get_stats (size_t& allocated, size_t& live, size_t& bytes) const noexcept;
+
+        const size_t chunk_size;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        size_t next_chunk = chunks_per_block;
+        /* Freed chunks, linked through the space their objects occupied. */
+        char* free = nullptr;
+        size_t allocated = 0;
+        size_t live = 0;
+    };
+
+    void* allocate (Pool& pool);
+    void deallocate (Pool& pool, void* object) noexcept;
+
+    Pool m_frames {sizeof (KvpFrameImpl)};
+    Pool m_values {sizeof (KvpValueImpl)};
+    bool m_released = false;
+};
+
+static thread_local KvpFrameArena* s_current_arena = nullptr;
+
+void*
+KvpFrameArena::allocate (Pool& pool)
+{
+    char* chunk;
+    if (pool.free)
+    {
+        chunk = pool.free;
+        pool.free = *reinterpret_cast<char**> (chunk + chunk_header_size);
+    }
+    else
+    {
+        if (pool.next_chunk == chunks_per_block)
+        {
+            pool.blocks.emplace_back (new char[chunks_per_block * pool.chunk_size]);
+            pool.next_chunk = 0;
+        }
+        chunk = pool.blocks.back ().get () + pool.next_chunk++ * pool.chunk_size;
+    }
+    *reinterpret_cast<KvpFrameArena**> (chunk) = this;
+    ++pool.allocated;
+    ++pool.live;
+    return chunk + chunk_header_size;
+}
+
+void
+KvpFrameArena::deallocate (Pool& pool, void* object) noexcept
+{
+    *reinterpret_cast<char**> (object) = pool.free;
+    pool.free = static_cast<char*> (object) - chunk_header_size;
+    --pool.live;
+    if (m_released && !m_frames.live && !m_values.live)
+        delete this;
+}
+
+void
+KvpFrameArena::release () noexcept
+{
+    if (s_current_arena == this)
+        s_current_arena = nullptr;
+    m_released = true;
+    if (!m_frames.live && !m_values.live)
+        delete this;
+}
+
+void
+KvpFrameArena::Pool::get_stats (size_t& allocated, size_t& live,
+                                size_t& bytes) const noexcept
+{
+    allocated = this->allocated;
+    live = this->live;
+    bytes = blocks.size () * chunks_per_block * chunk_size;
+}
+
+KvpFrameArena*
+kvp_frame_arena_new () noexcept
+{
+    return new KvpFrameArena;
+}
+
+KvpFrameArena*
+kvp_frame_arena_set_current (KvpFrameArena* arena) noexcept
+{
+    auto previous = s_current_arena;
+    s_current_arena = arena;
+    return previous;
+}
+
+void
+kvp_frame_arena_release (KvpFrameArena* arena) noexcept
+{
+    if (arena)
+        arena->release ();
+}
+
+void
+kvp_frame_arena_get_stats (const KvpFrameArena* arena, size_t& allocated,
+                           size_t& live, size_t& bytes) noexcept
+{
+    allocated = live = bytes = 0;
+    if (arena)
+        arena->get_frame_stats (allocated, live, bytes);
+}
+
+void
+kvp_frame_arena_get_value_stats (const KvpFrameArena* arena, size_t& allocated,
+                                 size_t& live, size_t& bytes) noexcept
+{
+    allocated = live = bytes = 0;
+    if (arena)
+        arena->get_value_stats (allocated, live, bytes);
+}
+
+static void*
+free_store_allocate (size_t size)
+{
+    auto chunk = static_cast<char*> (::operator new (chunk_header_size + size));
+    *reinterpret_cast<KvpFrameArena**> (chunk) = nullptr;
+    return chunk + chunk_header_size;
+}
+
+static KvpFrameArena*
+chunk_arena (void* object) noexcept
+{
+    return *reinterpret_cast<KvpFrameArena**> (static_cast<char*> (object) -
+                                               chunk_header_size);
+}
+
+void*
+KvpFrameImpl::operator new (size_t size)
+{
+    if (s_current_arena && size == sizeof (KvpFrameImpl))
+        return s_current_arena->allocate_frame ();
+    return free_store_allocate (size);
+}
+
+void
+KvpFrameImpl::operator delete (void* frame) noexcept
+{
+    if (!frame)
+        return;
+    if (auto arena = chunk_arena (frame))
+        arena->deallocate_frame (frame);
+    else
+        ::operator delete (static_cast<char*> (frame) - chunk_header_size);
+}
+
+void*
+KvpValueImpl::operator new (size_t size)
+{
+    if (s_current_arena && size == sizeof (KvpValueImpl))
+        return s_current_arena->allocate_value ();
+    return free_store_allocate (size);
+}
+
+void
+KvpValueImpl::operator delete (void* value) noexcept
+{
+    if (!value)
+        return;
+    if (auto arena = chunk_arena (value))
+        arena->deallocate_value (value);
+    else
+        ::operator delete (static_cast<char*> (value) - chunk_header_size);
+}
+
+static bool
+slot_key_less (const KvpFrameImpl::value_type& slot, const char* key) noexcept
+{
+    return std::strcmp (slot.first, key) < 0;
+}
+
 KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
 {
-    std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
-        [this](const map_type::value_type & a)
+    if (rhs.m_valuemap)
+        m_valuemap.reset (new map_type);
+    else
+        m_slots.reserve (rhs.m_slots.size());
+    /* rhs is already sorted so the slots can simply be appended. */
+    std::for_each(rhs.begin(), rhs.end(),
+        [this](const value_type & a)
         {
             auto key = qof_string_cache_insert(a.first);
             auto val = new KvpValueImpl(*a.second);
-            this->m_valuemap.insert({key,val});
+            if (this->m_valuemap)
+                this->m_valuemap->emplace_hint(this->m_valuemap->end(), key, val);
+            else
+                this->m_slots.emplace_back(key, val);
         }
     );
 }
 
 KvpFrameImpl::~KvpFrameImpl() noexcept
 {
-    std::for_each(m_valuemap.begin(), m_valuemap.end(),
-		 [](const map_type::value_type &a){
+    std::for_each(begin(), end(),
+		 [](const value_type &a){
 		      qof_string_cache_remove(a.first);
 		      delete a.second;
 		  }
 	);
-    m_valuemap.clear();
+    m_slots.clear();
+    m_valuemap.reset();
+}
+
+KvpFrameImpl::const_iterator
+KvpFrameImpl::lower_bound (const char* key) const noexcept
+{
+    if (m_valuemap)
+        return const_iterator{m_valuemap->lower_bound (key)};
+    return const_iterator{std::lower_bound (m_slots.cbegin (), m_slots.cend (),
+                                            key, slot_key_less)};
+}
+
+KvpValue *
+KvpFrameImpl::find_value (const char* key) const noexcept
+{
+    if (m_valuemap)
+    {
+        auto spot = m_valuemap->find (key);
+        return spot == m_valuemap->end () ? nullptr : spot->second;
+    }
+    auto spot = std::lower_bound (m_slots.begin (), m_slots.end (), key,
+                                  slot_key_less);
+    if (spot != m_slots.end () && std::strcmp (spot->first, key) == 0)
+        return spot->second;
+    return nullptr;
+}
+
+const char*
+KvpKey::interned () const noexcept
+{
+    /* The reference taken here is never given back, so the cached copy
+     * lives as long as the cache does. */
+    auto generation = qof_string_cache_generation ();
+    if (m_generation != generation)
+    {
+        m_interned = qof_string_cache_insert (m_name);
+        m_generation = generation;
+    }
+    return m_interned;
+}
+
+KvpValue *
+KvpFrameImpl::find_interned (const char* key) const noexcept
+{
+    /* A key that isn't cached can't be in any frame. The empty key isn't
+     * cached either, so it has no unique address to look for. */
+    if (!key)
+        return nullptr;
+    if (m_valuemap || !*key)
+        return find_value (key);
+    for (auto const & slot : m_slots)
+        if (slot.first == key)
+            return slot.second;
+    return nullptr;
+}
+
+KvpValue *
+KvpFrameImpl::find_key (KvpKeyRef const & key) const noexcept
+{
+    if (key.key ())
+        return find_interned (key.key ()->interned ());
+    return find_value (key.name ());
 }
 
 KvpFrame *
 KvpFrame::get_child_frame_or_nullptr (Path const & path) noexcept
 {
-    if (!path.size ())
-        return this;
-    auto key = path.front ();
-    auto map_iter = m_valuemap.find (key.c_str ());
-    if (map_iter == m_valuemap.end ())
-        return nullptr;
-    auto child = map_iter->second->get <KvpFrame *> ();
-    if (!child)
-        return nullptr;
-    Path send;
-    std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    return child->get_child_frame_or_nullptr (send);
+    auto frame = this;
+    for (auto const & key : path)
+    {
+        auto value = frame->find_value (key.c_str ());
+        if (!value)
+            return nullptr;
+        frame = value->get <KvpFrame *> ();
+        if (!frame)
+            return nullptr;
+    }
+    return frame;
 }
 
 KvpFrame *
 KvpFrame::get_child_frame_or_create (Path const & path) noexcept
 {
-    if (!path.size ())
-        return this;
-    auto key = path.front ();
-    auto spot = m_valuemap.find (key.c_str ());
-    if (spot == m_valuemap.end () || spot->second->get_type () != KvpValue::Type::FRAME)
-        delete set_impl (key.c_str (), new KvpValue {new KvpFrame});
-    Path send;
-    std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    auto child_val = m_valuemap.at (key.c_str ());
-    auto child = child_val->get <KvpFrame *> ();
-    return child->get_child_frame_or_create (send);
+    auto frame = this;
+    for (auto const & key : path)
+    {
+        auto value = frame->find_value (key.c_str ());
+        if (!value || value->get_type () != KvpValue::Type::FRAME)
+        {
+            value = new KvpValue {new KvpFrame};
+            delete frame->set_impl (key, value);
+        }
+        frame = value->get <KvpFrame *> ();
+    }
+    return frame;
 }
 
 
@@ -100,18 +377,50 @@ KvpValue *
 KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
 {
     KvpValue * ret {};
-    auto spot = m_valuemap.find (key.c_str ());
-    if (spot != m_valuemap.end ())
+    if (m_valuemap)
+    {
+        auto spot = m_valuemap->find (key.c_str ());
+        if (spot != m_valuemap->end ())
+        {
+            qof_string_cache_remove (spot->first);
+            ret = spot->second;
+            m_valuemap->erase (spot);
+        }
+        if (value)
+        {
+            auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
+            m_valuemap->emplace (cachedkey, value);
+        }
+        return ret;
+    }
+
+    auto spot = std::lower_bound (m_slots.begin (), m_slots.end (),
+                                  key.c_str (), slot_key_less);
+    if (spot != m_slots.end () && key == spot->first)
     {
-        qof_string_cache_remove (spot->first);
         ret = spot->second;
-        m_valuemap.erase (spot);
+        if (value)
+        {
+            /* Same key, so the cached one can stay. */
+            spot->second = value;
+            return ret;
+        }
+        qof_string_cache_remove (spot->first);
+        m_slots.erase (spot);
+        return ret;
     }
-    if (value)
+    if (!value)
+        return ret;
+
+    auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
+    if (m_slots.size () < max_flat_size)
     {
-        auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
-        m_valuemap.emplace (cachedkey, value);
+        m_slots.emplace (spot, cachedkey, value);
+        return ret;
     }
+    m_valuemap.reset (new map_type {m_slots.begin (), m_slots.end ()});
+    m_valuemap->emplace (cachedkey, value);
+    flat_type {}.swap (m_slots);
     return ret;
 }
 
@@ -140,17 +449,56 @@ KvpFrameImpl::set_path (Path path, KvpValue* value) noexcept
 }
 
 KvpValue *
-KvpFrameImpl::get_slot (Path path) noexcept
+KvpFrameImpl::get_slot (Path const & path) noexcept
 {
-    auto key = path.back();
-    path.pop_back();
-    auto target = get_child_frame_or_nullptr (path);
-    if (!target)
+    KvpValue * value {};
+    auto frame = this;
+    for (auto const & key : path)
+    {
+        if (!frame)
+            return nullptr;
+        value = frame->find_value (key.c_str ());
+        if (!value)
+            return nullptr;
+        frame = value->get <KvpFrame *> ();
+    }
+    return value;
+}
+
+KvpValue *
+KvpFrameImpl::get_key_slot (KeyPath const & keys) noexcept
+{
+    KvpValue * value {};
+    auto frame = this;
+    for (auto const & key : keys)
+    {
+        if (!frame)
+            return nullptr;
+        value = frame->find_key (key);
+        if (!value)
+            return nullptr;
+        frame = value->get <KvpFrame *> ();
+    }
+    return value;
+}
+
+KvpValue *
+KvpFrameImpl::set_key_path (KeyPath const & path, KvpValue* value) noexcept
+{
+    if (path.empty ())
         return nullptr;
-    auto spot = target->m_valuemap.find (key.c_str ());
-    if (spot != target->m_valuemap.end ())
-        return spot->second;
-    return nullptr;
+    auto frame = this;
+    for (auto key = path.begin (); key + 1 != path.end (); ++key)
+    {
+        auto child = frame->find_key (*key);
+        if (!child || child->get_type () != KvpValue::Type::FRAME)
+        {
+            child = new KvpValue {new KvpFrame};
+            delete frame->set_impl (key->name (), child);
+        }
+        frame = child->get <KvpFrame *> ();
+    }
+    return frame->set_impl (path.back ().name (), value);
 }
 
 std::string
@@ -162,11 +510,11 @@ KvpFrameImpl::to_string() const noexcept
 std::string
 KvpFrameImpl::to_string(std::string const & prefix) const noexcept
 {
-    if (!m_valuemap.size())
+    if (empty())
         return prefix;
     std::ostringstream ret;
-    std::for_each(m_valuemap.begin(), m_valuemap.end(),
-        [&ret,&prefix](const map_type::value_type &a)
+    std::for_each(begin(), end(),
+        [&ret,&prefix](const value_type &a)
         {
             std::string new_prefix {prefix};
             if (a.first)
@@ -187,9 +535,9 @@ std::vector<std::string>
 KvpFrameImpl::get_keys() const noexcept
 {
     std::vector<std::string> ret;
-    ret.reserve (m_valuemap.size());
-    std::for_each(m_valuemap.begin(), m_valuemap.end(),
-        [&ret](const KvpFrameImpl::map_type::value_type &a)
+    ret.reserve (size());
+    std::for_each(begin(), end(),
+        [&ret](const KvpFrameImpl::value_type &a)
         {
             ret.push_back(a.first);
         }
@@ -214,20 +562,20 @@ int compare(const KvpFrameImpl * one, const KvpFrameImpl * two) noexcept
  */
 int compare(const KvpFrameImpl & one, const KvpFrameImpl & two) noexcept
 {
-    for (const auto & a : one.m_valuemap)
+    for (const auto & a : one)
     {
-        auto otherspot = two.m_valuemap.find(a.first);
-        if (otherspot == two.m_valuemap.end())
+        auto otherspot = two.find_value(a.first);
+        if (!otherspot)
         {
             return 1;
         }
-        auto comparison = compare(a.second,otherspot->second);
+        auto comparison = compare(a.second,otherspot);
 
         if (comparison != 0)
             return comparison;
     }
 
-    if (one.m_valuemap.size() < two.m_valuemap.size())
+    if (one.size() < two.size())
         return -1;
     return 0;
 }
@@ -323,7 +671,7 @@ kvp_value_from_gvalue (const GValue *gval)
 void
 KvpFrame::flatten_kvp_impl(std::vector <std::string> path, std::vector <KvpEntry> & entries) const noexcept
 {
-    for (auto const & entry : m_valuemap)
+    for (auto const & entry : *this)
     {
         std::vector<std::string> new_path {path};
         new_path.push_back("/");
@@ -100,6 +100,13 @@ struct KvpValueImpl
      */
     ~KvpValueImpl() noexcept;
 
+    /**
+     * Values come from the current KvpFrameArena if there is one, otherwise
+     * from the free store.
+     */
+    static void* operator new (size_t size);
+    static void operator delete (void* value) noexcept;
+
     /**
      * Adds another value to this KvpValueImpl.
      *
@@ -56,7 +56,7 @@
  * some additional API might work. The compile/free/run_query functions were
  * implemented for the DBI backend but never put into use; the rest were never
  * implemented. They're here as something to consider if we ever decide to
- * implement them.
+ * implement them. A much simpler run_query() is now declared below.
  *
  * The compile_query() method compiles a QOF query object into
  *    a backend-specific data structure and returns the compiled
@@ -210,6 +210,18 @@ public:
  *    better to wait for the query).
  */
     virtual void load (QofBook*, QofBackendLoadType) = 0;
+/**
+ *    Called by qof_query_run() before it searches a book, so that a backend
+ *    which didn't return everything from load() can fetch the objects the
+ *    query might match. Backends that load all of their data ignore it.
+ */
+    virtual void run_query(QofQuery*) {}
+/**
+ *    Called before the engine reads an account's splits posted on or after
+ *    a date, so that a backend which didn't return every transaction from
+ *    load() can fetch them. Backends that load all of their data ignore it.
+ */
+    virtual void fetch_account_splits(QofInstance*, time64) {}
 /**
  *    Called when the engine is about to make a change to a data structure. It
  *    could provide an advisory lock on data, but no backend does this.
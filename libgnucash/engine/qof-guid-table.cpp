@@ -0,0 +1,147 @@
+/********************************************************************\
+ * qof-guid-table.cpp -- GUID to QofInstance hash table             *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <cstdint>
+#include <cstring>
+
+#include "qof-guid-table.hpp"
+
+/* Keep the table at most three quarters full. */
+static constexpr size_t max_load_num = 3;
+static constexpr size_t max_load_den = 4;
+static constexpr size_t min_capacity = 16;
+
+static inline bool
+guid_eq (const GncGUID& a, const GncGUID& b) noexcept
+{
+    return std::memcmp (a.reserved, b.reserved, GUID_DATA_SIZE) == 0;
+}
+
+size_t
+QofGuidTable::home (const GncGUID& guid) const noexcept
+{
+    /* GUIDs are mostly random already, but fold and mix both halves anyway
+     * so that ones made by hand, like in tests, still spread out. */
+    uint64_t lo, hi;
+    std::memcpy (&lo, guid.reserved, sizeof lo);
+    std::memcpy (&hi, guid.reserved + sizeof lo, sizeof hi);
+    uint64_t hash = (lo ^ (hi * UINT64_C(0x9E3779B97F4A7C15))) *
+        UINT64_C(0xC2B2AE3D27D4EB4F);
+    hash ^= hash >> 32;
+    return static_cast<size_t> (hash) & (m_slots.size () - 1);
+}
+
+QofInstance*
+QofGuidTable::lookup (const GncGUID& guid) const noexcept
+{
+    if (!m_size)
+        return nullptr;
+    auto mask = m_slots.size () - 1;
+    for (auto index = home (guid); ; index = (index + 1) & mask)
+    {
+        auto const& slot = m_slots[index];
+        if (!slot.inst)
+            return nullptr;
+        if (guid_eq (slot.guid, guid))
+            return slot.inst;
+    }
+}
+
+void
+QofGuidTable::insert (const GncGUID& guid, QofInstance* inst)
+{
+    if (!inst)
+        return;
+    if ((m_size + 1) * max_load_den > m_slots.size () * max_load_num)
+        rehash (m_slots.empty () ? min_capacity : m_slots.size () * 2);
+    auto mask = m_slots.size () - 1;
+    for (auto index = home (guid); ; index = (index + 1) & mask)
+    {
+        auto& slot = m_slots[index];
+        if (!slot.inst)
+        {
+            slot.guid = guid;
+            slot.inst = inst;
+            ++m_size;
+            return;
+        }
+        if (guid_eq (slot.guid, guid))
+        {
+            slot.inst = inst;
+            return;
+        }
+    }
+}
+
+bool
+QofGuidTable::remove (const GncGUID& guid) noexcept
+{
+    if (!m_size)
+        return false;
+    auto mask = m_slots.size () - 1;
+    auto hole = home (guid);
+    for (; ; hole = (hole + 1) & mask)
+    {
+        if (!m_slots[hole].inst)
+            return false;
+        if (guid_eq (m_slots[hole].guid, guid))
+            break;
+    }
+    /* Shift back any following entry whose probe sequence passes through
+     * the hole, so that lookups never stop short at it. */
+    for (auto next = (hole + 1) & mask; m_slots[next].inst;
+         next = (next + 1) & mask)
+    {
+        auto want = home (m_slots[next].guid);
+        bool stays = hole <= next ? (hole < want && want <= next) :
+            (hole < want || want <= next);
+        if (stays)
+            continue;
+        m_slots[hole] = m_slots[next];
+        hole = next;
+    }
+    m_slots[hole].inst = nullptr;
+    --m_size;
+    return true;
+}
+
+void
+QofGuidTable::reserve (size_t count)
+{
+    auto capacity = m_slots.empty () ? min_capacity : m_slots.size ();
+    while (count * max_load_den > capacity * max_load_num)
+        capacity *= 2;
+    if (capacity > m_slots.size ())
+        rehash (capacity);
+}
+
+void
+QofGuidTable::rehash (size_t capacity)
+{
+    std::vector<Slot> old_slots (capacity, Slot {{}, nullptr});
+    old_slots.swap (m_slots);
+    m_size = 0;
+    for (auto const& slot : old_slots)
+        if (slot.inst)
+            insert (slot.guid, slot.inst);
+}
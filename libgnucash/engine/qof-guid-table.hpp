@@ -0,0 +1,97 @@
+/********************************************************************\
+ * qof-guid-table.hpp -- GUID to QofInstance hash table             *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Entity
+    @{ */
+/** @file qof-guid-table.hpp
+    @brief The table a QofCollection keeps its instances in.
+*/
+
+#ifndef QOF_GUID_TABLE_HPP
+#define QOF_GUID_TABLE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "guid.h"
+#include "qofinstance.h"
+
+/** An open-addressing hash table mapping GUIDs to instances.
+ *
+ * The GUIDs are copied into the table's slots rather than pointed to, so a
+ * lookup probes one contiguous array and never dereferences an instance to
+ * compare keys. Collisions are resolved by linear probing and removal shifts
+ * the following entries back, so there are no tombstones to skip. A slot is
+ * empty when its instance is nullptr, so nullptr can't be stored.
+ */
+class QofGuidTable
+{
+public:
+    QofGuidTable() noexcept = default;
+    QofGuidTable(const QofGuidTable&) = delete;
+    QofGuidTable& operator=(const QofGuidTable&) = delete;
+
+    /** @return The instance with guid or nullptr if there isn't one. */
+    QofInstance* lookup(const GncGUID& guid) const noexcept;
+
+    /** Map guid to inst, replacing whatever it was mapped to before. */
+    void insert(const GncGUID& guid, QofInstance* inst);
+
+    /** Remove guid from the table.
+     * @return false if it wasn't there.
+     */
+    bool remove(const GncGUID& guid) noexcept;
+
+    /** Make room for count entries so that adding that many doesn't
+     * rehash. Loaders call this with the number of objects they're about to
+     * create.
+     */
+    void reserve(size_t count);
+
+    size_t size() const noexcept { return m_size; }
+
+    /** Call func(QofInstance*) for each instance, in no particular order.
+     * func must not change the table.
+     */
+    template <typename func_type>
+    void for_each(func_type const& func) const
+    {
+        for (auto const& slot : m_slots)
+            if (slot.inst)
+                func(slot.inst);
+    }
+
+private:
+    struct Slot
+    {
+        GncGUID guid;
+        QofInstance* inst;
+    };
+
+    size_t home(const GncGUID& guid) const noexcept;
+    void rehash(size_t capacity);
+
+    std::vector<Slot> m_slots;
+    size_t m_size = 0;
+};
+
+#endif /* QOF_GUID_TABLE_HPP */
+/** @} */
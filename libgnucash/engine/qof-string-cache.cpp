@@ -41,10 +41,12 @@ static QofLogModule log_module = QOF_MOD_UTIL;
 /* The QOF string cache                                                */
 /*                                                                     */
 /* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* and a ref count is the value. Both share one allocation, the count  */
+/* first and the string after it, which the value owns.                */
 /* =================================================================== */
 
 static GHashTable* qof_string_cache = NULL;
+static guint qof_string_cache_gen = 1;
 
 static GHashTable*
 qof_get_string_cache(void)
@@ -54,7 +56,7 @@ qof_get_string_cache(void)
         qof_string_cache = g_hash_table_new_full(
                                g_str_hash,               /* hash_func          */
                                g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
+                               nullptr,                  /* key_destroy_func   */
                                g_free);                  /* value_destroy_func */
     }
     return qof_string_cache;
@@ -72,10 +74,17 @@ qof_string_cache_destroy (void)
     if (qof_string_cache)
     {
         g_hash_table_destroy(qof_string_cache);
+        ++qof_string_cache_gen;
     }
     qof_string_cache = NULL;
 }
 
+guint
+qof_string_cache_generation (void)
+{
+    return qof_string_cache_gen;
+}
+
 /* If the key exists in the cache, check the refcount.  If 1, just
  * remove the key.  Otherwise, decrement the refcount */
 void
@@ -124,16 +133,35 @@ qof_string_cache_insert(const char * key)
         }
         else
         {
-            gpointer new_key = g_strdup(static_cast<const char*>(key));
-            guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
+            auto len = strlen(key) + 1;
+            guint* refcount = static_cast<guint*>(g_malloc(sizeof(guint) + len));
             *refcount = 1;
+            char* new_key = reinterpret_cast<char*>(refcount + 1);
+            memcpy(new_key, key, len);
             g_hash_table_insert(cache, new_key, refcount);
-            return static_cast <char *> (new_key);
+            return new_key;
         }
     }
     return NULL;
 }
 
+/* Return the cached copy of key without taking a reference, or NULL if
+ * nothing holds one. */
+const char *
+qof_string_cache_lookup(const char * key)
+{
+    if (!key)
+        return NULL;
+    if (key[0] == 0)
+        return "";
+    gpointer value;
+    gpointer cache_key;
+    if (g_hash_table_lookup_extended(qof_get_string_cache(), key,
+                                     &cache_key, &value))
+        return static_cast <char *> (cache_key);
+    return NULL;
+}
+
 const char *
 qof_string_cache_replace(char const * dst, char const * src)
 {
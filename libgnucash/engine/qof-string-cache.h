@@ -66,6 +66,11 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
+ * While a string is cached its address identifies it: two cached strings
+ * are equal exactly when they are the same pointer. Use
+ * qof_string_cache_lookup to get that symbol for a string without adding a
+ * reference, e.g. to find a KVP slot by comparing keys' addresses.
+ *
  * The string cache is demand-created on first use.
  *
  **/
@@ -86,6 +91,17 @@ void qof_string_cache_remove(const char * key);
 */
 const char * qof_string_cache_insert(const char * key);
 
+/** Find the cached copy of key without adding a reference to it.
+   @return The cached string, or NULL if key isn't in the cache. The empty
+   string is never cached and is returned as a static "".
+*/
+const char * qof_string_cache_lookup(const char * key);
+
+/** Return a number that changes whenever the cache is destroyed, so that
+   anyone holding a cached string can tell that it's gone.
+*/
+guint qof_string_cache_generation(void);
+
 /** Same as CACHE_REPLACE below, but safe to call from C++.
  */
 const char * qof_string_cache_replace(const char * dst, const char * src);
@@ -102,6 +102,9 @@ typedef enum
                                     for internal use by GnuCash */
     ERR_FILEIO_FILE_UPGRADE,   /**< file will be upgraded and not be able to be
                                     read by prior versions - warn users*/
+    ERR_FILEIO_JOURNAL_REJECTED, /**< the journal of incremental saves doesn't
+                                      match the file and was set aside - warn
+                                      users */
 
     /* network errors */
     ERR_NETIO_SHORT_READ = 2000,  /**< not enough bytes received */
@@ -363,8 +363,12 @@ qof_book_destroy (QofBook *book)
      * been destroyed.
      */
     cols = book->hash_of_collections;
+    auto arena = static_cast<KvpFrameArena*>(book->kvp_arena);
     g_object_unref (book);
     g_hash_table_destroy (cols);
+    /* Frames that outlive this are returned to the arena as they're freed
+     * and the last one frees it. */
+    kvp_frame_arena_release (arena);
 
     LEAVE ("book=%p", book);
 }
@@ -450,6 +454,37 @@ qof_book_shutting_down (const QofBook *book)
     return book->shutting_down;
 }
 
+void
+qof_book_begin_bulk_load (QofBook *book)
+{
+    if (!book) return;
+    if (!book->kvp_arena)
+        book->kvp_arena = kvp_frame_arena_new ();
+    auto previous = kvp_frame_arena_set_current (static_cast<KvpFrameArena*>(book->kvp_arena));
+    if (!book->kvp_bulk_depth++)
+        book->kvp_prev_arena = previous;
+}
+
+void
+qof_book_end_bulk_load (QofBook *book)
+{
+    if (!book || !book->kvp_bulk_depth) return;
+    if (--book->kvp_bulk_depth)
+        return;
+    kvp_frame_arena_set_current (static_cast<KvpFrameArena*>(book->kvp_prev_arena));
+    book->kvp_prev_arena = nullptr;
+    auto arena = static_cast<KvpFrameArena*>(book->kvp_arena);
+    size_t allocated, live, bytes;
+    kvp_frame_arena_get_stats (arena, allocated, live, bytes);
+    PINFO ("book=%p: %" G_GSIZE_FORMAT " KVP frames allocated from a %"
+           G_GSIZE_FORMAT " byte slab, %" G_GSIZE_FORMAT " still live",
+           book, allocated, bytes, live);
+    kvp_frame_arena_get_value_stats (arena, allocated, live, bytes);
+    PINFO ("book=%p: %" G_GSIZE_FORMAT " KVP values allocated from a %"
+           G_GSIZE_FORMAT " byte slab, %" G_GSIZE_FORMAT " still live",
+           book, allocated, bytes, live);
+}
+
 /* ====================================================================== */
 /* setters */
 
@@ -1274,7 +1309,7 @@ FeatureSet
 qof_book_get_unknown_features (QofBook *book, const FeaturesTable& features)
 {
     FeatureSet rv;
-    auto test_feature = [&](const KvpFrameImpl::map_type::value_type& feature)
+    auto test_feature = [&](const KvpFrameImpl::value_type& feature)
     {
         if (features.find (feature.first) == features.end ())
             rv.emplace_back (feature.first, feature.second->get<const char*>());
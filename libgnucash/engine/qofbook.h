@@ -165,6 +165,15 @@ struct _QofBook
     gint cached_num_days_autoreadonly;
     /* Whether the above cached value is valid. */
     gboolean cached_num_days_autoreadonly_isvalid;
+
+    /* The KvpFrameArena that the KVP frames of bulk-loaded objects are
+     * allocated from, or NULL if nothing has been bulk loaded. It is
+     * released only after all of the book's objects are destroyed. */
+    gpointer kvp_arena;
+    /* The arena that was current when the outermost bulk load of this
+     * book began, and how deeply the bulk loads are nested. */
+    gpointer kvp_prev_arena;
+    gint kvp_bulk_depth;
 };
 
 struct _QofBookClass
@@ -317,6 +326,17 @@ gboolean qof_book_use_split_action_for_num_field (const QofBook *book);
 /** Is the book shutting down? */
 gboolean qof_book_shutting_down (const QofBook *book);
 
+/** Allocate the KVP frames and values of objects created from now until
+ *  qof_book_end_bulk_load from a slab belonging to the book instead of
+ *  one at a time. qof_session_load brackets backend loads with these. */
+void qof_book_begin_bulk_load (QofBook *book);
+
+/** Go back to allocating KVP frames and values the way they were
+ *  allocated before the matching qof_book_begin_bulk_load and log how much
+ *  of the book's slab is in use. Bulk loads may be nested, also across
+ *  books. */
+void qof_book_end_bulk_load (QofBook *book);
+
 /** qof_book_not_saved() returns the value of the session_dirty flag,
  * set when changes to any object in the book are committed
  * (qof_backend->commit_edit has been called) and the backend hasn't
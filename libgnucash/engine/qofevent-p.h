@@ -31,6 +31,7 @@
 typedef struct
 {
     QofEventHandler handler;
+    QofEventBatchHandler batch_handler;
     gpointer user_data;
 
     gint handler_id;
@@ -39,4 +40,7 @@ typedef struct
 /* generates an event even when events are suspended! */
 void qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data);
 
+/* drops the changes collected for an instance that is going away */
+void qof_event_forget_instance (QofInstance *entity);
+
 #endif
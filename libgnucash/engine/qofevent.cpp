@@ -28,13 +28,24 @@
 #include "qof.h"
 #include "qofevent-p.h"
 
+#include <unordered_map>
+#include <vector>
+
 /* Static Variables ************************************************/
 static guint   suspend_counter   = 0;
 static gint    next_handler_id   = 1;
 static guint   handler_run_level = 0;
 static guint   pending_deletes   = 0;
+static guint   dropped_events    = 0;
+static guint   batch_level       = 0;
+static guint   batch_handlers    = 0;
 static GList   *handlers  =   NULL;
 
+/* The events collected during a batch: the event bits seen for each
+ * entity, and the entities in the order they first showed up. */
+static std::unordered_map<QofInstance*, QofEventId> pending_events;
+static std::vector<QofInstance*> pending_order;
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -69,10 +80,32 @@ find_next_handler_id(void)
     return handler_id;
 }
 
+static gint
+register_handler_internal (QofEventHandler handler,
+                           QofEventBatchHandler batch_handler,
+                           gpointer user_data)
+{
+    HandlerInfo *hi;
+    gint handler_id;
+
+    /* look for a free handler id */
+    handler_id = find_next_handler_id();
+
+    /* Found one, add the handler */
+    hi = g_new0 (HandlerInfo, 1);
+
+    hi->handler = handler;
+    hi->batch_handler = batch_handler;
+    hi->user_data = user_data;
+    hi->handler_id = handler_id;
+
+    handlers = g_list_prepend (handlers, hi);
+    return handler_id;
+}
+
 gint
 qof_event_register_handler (QofEventHandler handler, gpointer user_data)
 {
-    HandlerInfo *hi;
     gint handler_id;
 
     ENTER ("(handler=%p, data=%p)", handler, user_data);
@@ -84,17 +117,27 @@ qof_event_register_handler (QofEventHandler handler, gpointer user_data)
         return 0;
     }
 
-    /* look for a free handler id */
-    handler_id = find_next_handler_id();
+    handler_id = register_handler_internal (handler, nullptr, user_data);
+    LEAVE ("(handler=%p, data=%p) handler_id=%d", handler, user_data, handler_id);
+    return handler_id;
+}
 
-    /* Found one, add the handler */
-    hi = g_new0 (HandlerInfo, 1);
+gint
+qof_event_register_batch_handler (QofEventBatchHandler handler,
+                                  gpointer user_data)
+{
+    gint handler_id;
 
-    hi->handler = handler;
-    hi->user_data = user_data;
-    hi->handler_id = handler_id;
+    ENTER ("(handler=%p, data=%p)", handler, user_data);
 
-    handlers = g_list_prepend (handlers, hi);
+    if (!handler)
+    {
+        PERR ("no handler specified");
+        return 0;
+    }
+
+    handler_id = register_handler_internal (nullptr, handler, user_data);
+    batch_handlers++;
     LEAVE ("(handler=%p, data=%p) handler_id=%d", handler, user_data, handler_id);
     return handler_id;
 }
@@ -120,9 +163,16 @@ qof_event_unregister_handler (gint handler_id)
         if (hi->handler)
             LEAVE ("(handler_id=%d) handler=%p data=%p", handler_id,
                    hi->handler, hi->user_data);
+        if (hi->batch_handler)
+        {
+            LEAVE ("(handler_id=%d) batch_handler=%p data=%p", handler_id,
+                   hi->batch_handler, hi->user_data);
+            batch_handlers--;
+        }
 
         /* safety -- clear the handler in case we're running events now */
         hi->handler = NULL;
+        hi->batch_handler = NULL;
 
         if (handler_run_level == 0)
         {
@@ -164,12 +214,73 @@ qof_event_resume (void)
     suspend_counter--;
 }
 
+static void
+purge_deleted_handlers (void)
+{
+    GList *node;
+    GList *next_node = NULL;
+
+    /* If we're the outermost event runner and we have pending deletes
+     * then go delete the handlers now.
+     */
+    if (handler_run_level != 0 || !pending_deletes)
+        return;
+
+    for (node = handlers; node; node = next_node)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        next_node = node->next;
+        if (hi->handler == NULL && hi->batch_handler == NULL)
+        {
+            /* remove this node from the list, then free this node */
+            handlers = g_list_remove_link (handlers, node);
+            g_list_free_1 (node);
+            g_free (hi);
+        }
+    }
+    pending_deletes = 0;
+}
+
+static void
+record_change (QofInstance *entity, QofEventId event_id)
+{
+    auto result = pending_events.emplace (entity, 0);
+    if (result.second)
+        pending_order.push_back (entity);
+    result.first->second |= event_id;
+}
+
+static void
+deliver_changes (const QofEventChange *changes, guint n_changes)
+{
+    GList *node;
+    GList *next_node = NULL;
+
+    handler_run_level++;
+    for (node = handlers; node; node = next_node)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+
+        next_node = node->next;
+        if (hi->batch_handler)
+        {
+            PINFO("id=%d hi=%p batch_han=%p changes=%u", hi->handler_id, hi,
+                  hi->batch_handler, n_changes);
+            hi->batch_handler (changes, n_changes, hi->user_data);
+        }
+    }
+    handler_run_level--;
+
+    purge_deleted_handlers ();
+}
+
 static void
 qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
                              gpointer event_data)
 {
     GList *node;
     GList *next_node = NULL;
+    gboolean batched;
 
     g_return_if_fail(entity);
 
@@ -182,6 +293,13 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
     }
     }
 
+    /* A destroyed entity can't wait for the end of the batch. */
+    batched = batch_level && batch_handlers && !(event_id & QOF_EVENT_DESTROY);
+    if (batched)
+        record_change (entity, event_id);
+    else if (event_id & QOF_EVENT_DESTROY)
+        qof_event_forget_instance (entity);
+
     handler_run_level++;
     for (node = handlers; node; node = next_node)
     {
@@ -194,28 +312,17 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
                   hi->handler, event_data);
             hi->handler (entity, event_id, hi->user_data, event_data);
         }
-    }
-    handler_run_level--;
-
-    /* If we're the outermost event runner and we have pending deletes
-     * then go delete the handlers now.
-     */
-    if (handler_run_level == 0 && pending_deletes)
-    {
-        for (node = handlers; node; node = next_node)
+        else if (hi->batch_handler && !batched)
         {
-            HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
-            next_node = node->next;
-            if (hi->handler == NULL)
-            {
-                /* remove this node from the list, then free this node */
-                handlers = g_list_remove_link (handlers, node);
-                g_list_free_1 (node);
-                g_free (hi);
-            }
+            QofEventChange change = { entity, event_id };
+            PINFO("id=%d hi=%p batch_han=%p", hi->handler_id, hi,
+                  hi->batch_handler);
+            hi->batch_handler (&change, 1, hi->user_data);
         }
-        pending_deletes = 0;
     }
+    handler_run_level--;
+
+    purge_deleted_handlers ();
 }
 
 void
@@ -234,9 +341,75 @@ qof_event_gen (QofInstance *entity, QofEventId event_id, gpointer event_data)
         return;
 
     if (suspend_counter)
+    {
+        dropped_events++;
+        if (event_id & QOF_EVENT_DESTROY)
+            qof_event_forget_instance (entity);
         return;
+    }
 
     qof_event_generate_internal (entity, event_id, event_data);
 }
 
+guint
+qof_event_get_dropped_count (void)
+{
+    return dropped_events;
+}
+
+void
+qof_event_forget_instance (QofInstance *entity)
+{
+    if (!pending_events.empty ())
+        pending_events.erase (entity);
+}
+
+void
+qof_event_begin_batch (void)
+{
+    batch_level++;
+
+    if (batch_level == 0)
+    {
+        PERR ("batch level overflow");
+    }
+}
+
+void
+qof_event_end_batch (void)
+{
+    std::vector<QofEventChange> changes;
+
+    if (batch_level == 0)
+    {
+        PERR ("batch level underflow");
+        return;
+    }
+
+    batch_level--;
+    if (batch_level || pending_order.empty ())
+        return;
+
+    /* An entity that went away and was replaced by a new one at the same
+     * address shows up twice in pending_order; erasing it on the first
+     * visit delivers its events once. */
+    for (auto entity : pending_order)
+    {
+        auto iter = pending_events.find (entity);
+        if (iter == pending_events.end ())
+            continue;
+
+        /* one change per event bit, lowest first */
+        for (guint mask = iter->second; mask; mask &= mask - 1)
+            changes.push_back ({ entity,
+                                 static_cast<QofEventId>(mask & (~mask + 1)) });
+        pending_events.erase (iter);
+    }
+    pending_order.clear ();
+    pending_events.clear ();
+
+    if (!changes.empty ())
+        deliver_changes (changes.data (), changes.size ());
+}
+
 /* =========================== END OF FILE ======================= */
@@ -89,6 +89,28 @@ for future libqof1 or libqof2 usage.
 typedef void (*QofEventHandler) (QofInstance *ent,  QofEventId event_type,
                                  gpointer handler_data, gpointer event_data);
 
+/** One entry of the change set passed to a QofEventBatchHandler. */
+typedef struct
+{
+    QofInstance *entity;
+    QofEventId event_type;
+} QofEventChange;
+
+/** \brief Handler invoked with a set of coalesced events.
+ *
+ * Each entity appears at most once per event type, in the order in which
+ * the entities first generated an event. An event id made of several
+ * event bits is split into one change per bit. The event data of the
+ * individual events is not kept.
+ *
+ * @param changes:   the changes, valid only for the duration of the call
+ * @param n_changes: the number of changes
+ * @param handler_data: data supplied when handler was registered.
+ */
+typedef void (*QofEventBatchHandler) (const QofEventChange *changes,
+                                      guint n_changes,
+                                      gpointer handler_data);
+
 /** \brief Register a handler for events.
  *
  * @param handler:   handler to register
@@ -98,6 +120,25 @@ typedef void (*QofEventHandler) (QofInstance *ent,  QofEventId event_type,
  */
 gint qof_event_register_handler (QofEventHandler handler, gpointer handler_data);
 
+/** \brief Register a handler for coalesced events.
+ *
+ * Outside of a batch the handler is invoked for each event with a change
+ * set of one. Between qof_event_begin_batch() and the matching
+ * qof_event_end_batch() the events are collected instead and delivered
+ * once when the outermost batch ends. QOF_EVENT_DESTROY events are always
+ * delivered at once, while the entity still exists, and the changes
+ * collected earlier for that entity are dropped.
+ *
+ * The handler is unregistered with qof_event_unregister_handler().
+ *
+ * @param handler:   handler to register
+ * @param handler_data: data provided when handler is invoked
+ *
+ * @return id identifying handler
+ */
+gint qof_event_register_batch_handler (QofEventBatchHandler handler,
+                                       gpointer handler_data);
+
 /** \brief Unregister an event handler.
  *
  * @param handler_id: the id of the handler to unregister
@@ -139,6 +180,25 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** The number of events qof_event_gen() has dropped because events were
+ *  suspended. A handler that keeps track of what changed can compare it
+ *  with an earlier value to find out whether it missed anything.
+ */
+guint qof_event_get_dropped_count (void);
+
+/** \brief Start collecting events for the batch handlers.
+ *
+ *    Handlers registered with qof_event_register_handler() still see
+ *   every event as it is generated. Batches nest; the collected changes
+ *   are delivered by the qof_event_end_batch() call matching the
+ *   outermost qof_event_begin_batch(). Suspending events with
+ *   qof_event_suspend() drops events for both kinds of handler.
+ */
+void qof_event_begin_batch (void);
+
+/** End a batch, delivering the collected changes if it is the outermost. */
+void qof_event_end_batch (void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,10 @@
 #include "qof.h"
 #include "qofid-p.h"
 #include "qofinstance-p.h"
+#include "qof-guid-table.hpp"
+
+#include <algorithm>
+#include <vector>
 
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -38,7 +42,7 @@ struct QofCollection_s
     QofIdType    e_type;
     gboolean     is_dirty;
 
-    GHashTable * hash_of_entities;
+    QofGuidTable * hash_of_entities;
     gpointer     data;       /* place where object class can hang arbitrary data */
 };
 
@@ -50,7 +54,7 @@ qof_collection_new (QofIdType type)
     QofCollection *col;
     col = g_new0(QofCollection, 1);
     col->e_type = static_cast<QofIdType>(CACHE_INSERT (type));
-    col->hash_of_entities = guid_hash_table_new();
+    col->hash_of_entities = new QofGuidTable;
     col->data = NULL;
     return col;
 }
@@ -59,7 +63,7 @@ void
 qof_collection_destroy (QofCollection *col)
 {
     CACHE_REMOVE (col->e_type);
-    g_hash_table_destroy(col->hash_of_entities);
+    delete col->hash_of_entities;
     col->e_type = NULL;
     col->hash_of_entities = NULL;
     col->data = NULL;   /** XXX there should be a destroy notifier for this */
@@ -87,7 +91,7 @@ qof_collection_remove_entity (QofInstance *ent)
     col = qof_instance_get_collection(ent);
     if (!col) return;
     guid = qof_instance_get_guid(ent);
-    g_hash_table_remove (col->hash_of_entities, guid);
+    col->hash_of_entities->remove (*guid);
     qof_instance_set_collection(ent, NULL);
 }
 
@@ -101,7 +105,7 @@ qof_collection_insert_entity (QofCollection *col, QofInstance *ent)
     if (guid_equal(guid, guid_null())) return;
     g_return_if_fail (col->e_type == ent->e_type);
     qof_collection_remove_entity (ent);
-    g_hash_table_insert (col->hash_of_entities, (gpointer)guid, ent);
+    col->hash_of_entities->insert (*guid, ent);
     qof_instance_set_collection(ent, col);
 }
 
@@ -127,7 +131,7 @@ qof_collection_add_entity (QofCollection *coll, QofInstance *ent)
     {
         return FALSE;
     }
-    g_hash_table_insert (coll->hash_of_entities, (gpointer)guid, ent);
+    coll->hash_of_entities->insert (*guid, ent);
     return TRUE;
 }
 
@@ -214,8 +218,7 @@ qof_collection_lookup_entity (const QofCollection *col, const GncGUID * guid)
     QofInstance *ent;
     g_return_val_if_fail (col, NULL);
     if (guid == NULL) return NULL;
-    ent = static_cast<QofInstance*>(g_hash_table_lookup (col->hash_of_entities,
-							 guid));
+    ent = col->hash_of_entities->lookup (*guid);
     if (ent != NULL && qof_instance_get_destroying(ent)) return NULL;	
     return ent;
 }
@@ -245,10 +248,17 @@ qof_collection_count (const QofCollection *col)
 {
     guint c;
 
-    c = g_hash_table_size(col->hash_of_entities);
+    c = col->hash_of_entities->size();
     return c;
 }
 
+void
+qof_collection_reserve (QofCollection *col, guint count)
+{
+    g_return_if_fail (col);
+    col->hash_of_entities->reserve (count);
+}
+
 /* =============================================================== */
 
 gboolean
@@ -306,20 +316,26 @@ void
 qof_collection_foreach_sorted (const QofCollection *col, QofInstanceForeachCB cb_func,
                                gpointer user_data, GCompareFunc sort_fn)
 {
-    GList *entries;
-
     g_return_if_fail (col);
     g_return_if_fail (cb_func);
 
-    PINFO("Hash Table size of %s before is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s before is %" G_GSIZE_FORMAT, col->e_type,
+          col->hash_of_entities->size());
 
-    entries = g_hash_table_get_values (col->hash_of_entities);
+    /* The callback may add or remove entities, so work from a copy. */
+    std::vector<QofInstance*> entries;
+    entries.reserve (col->hash_of_entities->size());
+    col->hash_of_entities->for_each ([&entries](QofInstance* ent)
+                                     { entries.push_back (ent); });
     if (sort_fn)
-        entries = g_list_sort (entries, sort_fn);
-    g_list_foreach (entries, (GFunc)cb_func, user_data);
-    g_list_free (entries);
-
-    PINFO("Hash Table size of %s after is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+        std::stable_sort (entries.begin(), entries.end(),
+                          [sort_fn](QofInstance* a, QofInstance* b)
+                          { return sort_fn (a, b) < 0; });
+    for (auto ent : entries)
+        cb_func (ent, user_data);
+
+    PINFO("Hash Table size of %s after is %" G_GSIZE_FORMAT, col->e_type,
+          col->hash_of_entities->size());
 }
 
 void
@@ -118,7 +118,7 @@ print error message if its bad  */
 
 @param e_type QofIdType
 @param is_dirty gboolean
-@param hash_of_entities GHashTable
+@param hash_of_entities QofGuidTable
 @param data gpointer, place where object class can hang arbitrary data
 
 */
@@ -132,6 +132,11 @@ QofCollection * qof_collection_new (QofIdType type);
 /** return the number of entities in the collection. */
 guint qof_collection_count (const QofCollection *col);
 
+/** Make room for count entities in the collection so that adding them
+ *  doesn't have to grow its table along the way. Loaders that know how many
+ *  objects they're about to create should call this first. */
+void qof_collection_reserve (QofCollection *col, guint count);
+
 /** destroy the collection */
 void qof_collection_destroy (QofCollection *col);
 
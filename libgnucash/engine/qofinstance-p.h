@@ -165,6 +165,14 @@ void qof_instance_get_path_kvp (QofInstance *, GValue *, std::vector<std::string
 
 void qof_instance_set_path_kvp (QofInstance *, GValue const *, std::vector<std::string> const &);
 
+/** Like qof_instance_get_path_kvp, but the KvpKeys in the path are found by
+ *  address. */
+void qof_instance_get_key_kvp (QofInstance *, GValue *, KeyPath const &);
+
+/** Like qof_instance_set_path_kvp, but the KvpKeys in the path are found by
+ *  address. */
+void qof_instance_set_key_kvp (QofInstance *, GValue const *, KeyPath const &);
+
 bool qof_instance_has_path_slot (QofInstance const *, std::vector<std::string> const &);
 
 void qof_instance_slot_path_delete (QofInstance const *, std::vector<std::string> const &);
@@ -37,6 +37,7 @@
 #include "qof.h"
 #include "qofbook-p.h"
 #include "qofid-p.h"
+#include "qofevent-p.h"
 #include "kvp-frame.hpp"
 #include "qofinstance-p.h"
 #include "qof-backend.hpp"
@@ -318,6 +319,7 @@ qof_instance_dispose (GObject *instp)
     priv = GET_PRIVATE(instp);
     if (priv->collection)
         qof_collection_remove_entity(inst);
+    qof_event_forget_instance (inst);
 
     CACHE_REMOVE(inst->e_type);
     inst->e_type = nullptr;
@@ -1068,6 +1070,16 @@ void qof_instance_get_path_kvp (QofInstance * inst, GValue * value, std::vector<
     gvalue_from_kvp_value (inst->kvp_data->get_slot (path), value);
 }
 
+void qof_instance_set_key_kvp (QofInstance * inst, GValue const * value, KeyPath const & path)
+{
+    delete inst->kvp_data->set_key_path (path, kvp_value_from_gvalue (value));
+}
+
+void qof_instance_get_key_kvp (QofInstance * inst, GValue * value, KeyPath const & path)
+{
+    gvalue_from_kvp_value (inst->kvp_data->get_key_slot (path), value);
+}
+
 void
 qof_instance_get_kvp (QofInstance * inst, GValue * value, unsigned count, ...)
 {
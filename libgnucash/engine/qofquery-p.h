@@ -71,6 +71,23 @@ QofQueryParamList * qof_query_sort_get_param_path (const QofQuerySort *querysort
 gint qof_query_sort_get_sort_options (const QofQuerySort *querysort);
 gboolean qof_query_sort_get_increasing (const QofQuerySort *querysort);
 
+/* Query planning */
+
+/* An index function calls cb on each object in book that query might
+ * match, exactly once, and returns TRUE. The query still checks every
+ * object it's handed, so the index only has to narrow the search. If it
+ * can't narrow it, it returns FALSE without calling cb and the query scans
+ * the whole collection instead.
+ */
+typedef gboolean (*QofQueryIndexFunc) (QofBook *book, const QofQuery *query,
+                                       QofInstanceForeachCB cb,
+                                       gpointer user_data);
+
+/* Register an index for queries searching for obj_type. Registering
+ * another replaces it, and NULL removes it.
+ */
+void qof_query_register_index (QofIdTypeConst obj_type, QofQueryIndexFunc func);
+
 #ifdef __cplusplus
 }
 #endif
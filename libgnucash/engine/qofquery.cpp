@@ -29,6 +29,12 @@
 #include <regex.h>
 #include <string.h>
 
+#include <algorithm>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "qof.h"
 #include "qof-backend.hpp"
 #include "qofbook-p.h"
@@ -70,6 +76,57 @@ struct _QofQuerySort
     QofCompareFunc      comp_fcn;       /* When you are comparing core types */
 };
 
+/* A query term compiled for evaluation, see compile_plan(). */
+struct QofCompiledTerm
+{
+    /* The getters leading from the searched-for object to the parameter,
+     * which is the last one. */
+    std::vector<QofParam*>  params;
+    QofQueryPredicateFunc   pred_fcn;
+    QofQueryPredData *      pdata;
+    gboolean                invert;
+
+    /* The estimated cost of testing the term and how often it's been
+     * tested and has rejected an object, to order the AND terms by. */
+    guint                   cost;
+    guint64                 tested;
+    guint64                 rejected;
+};
+
+struct QofCompiledAndTerms
+{
+    std::vector<QofCompiledTerm> terms;
+    guint                        until_reorder;
+};
+
+/* Orders objects the way qof_query_run_internal() sorts a query's
+ * results. If the query isn't sorted they are all equal, so that a new
+ * one goes at the end. */
+struct QofQueryResultLess
+{
+    QofQuery *query;
+    bool operator() (gpointer a, gpointer b) const;
+};
+
+using QofQueryResults = std::multiset<gpointer, QofQueryResultLess>;
+
+/* The terms of a query, compiled for evaluation. */
+struct QofQueryPlan
+{
+    explicit QofQueryPlan (QofQuery *q) : results {QofQueryResultLess {q}} {}
+
+    std::vector<QofCompiledAndTerms> or_terms;
+
+    /* The results of the last run in order, with where each of them is,
+     * so that qof_query_update_results() can move one in logarithmic
+     * time, and whether it can keep them up to date. The query's result
+     * list is rebuilt from them when it's next asked for. */
+    QofQueryResults                  results;
+    std::unordered_map<gpointer, QofQueryResults::iterator> result_nodes;
+    bool                             results_updatable = false;
+    bool                             results_list_stale = false;
+};
+
 /* The QUERY structure */
 struct _QofQuery
 {
@@ -96,6 +153,9 @@ struct _QofQuery
     /* a map of book to backend-compiled queries */
     GHashTable*       be_compiled;
 
+    /* the terms compiled for checking objects against, see compile_plan() */
+    QofQueryPlan *    plan;
+
     /* cache the results so we don't have to run the whole search
      * again until it's really necessary */
     gint              changed;
@@ -110,6 +170,9 @@ typedef struct _QofQueryCB
     gint              count;
 } QofQueryCB;
 
+/* The index functions registered by object type */
+static std::unordered_map<std::string, QofQueryIndexFunc> query_indexes;
+
 /* Query Print functions for use with qof_log_set_level, static prototypes */
 static GList *qof_query_printSearchFor (QofQuery * query, GList * output);
 static GList *qof_query_printTerms (QofQuery * query, GList * output);
@@ -158,6 +221,8 @@ static void query_init (QofQuery *q, QofQueryTerm *initial_term)
     g_slist_free (q->secondary_sort.param_fcns);
     g_slist_free (q->tertiary_sort.param_fcns);
 
+    delete q->plan;
+
     ht = q->be_compiled;
     memset (q, 0, sizeof (*q));
     q->be_compiled = ht;
@@ -290,6 +355,9 @@ static void free_members (QofQuery *q)
 
     g_list_free(q->results);
     q->results = nullptr;
+
+    delete q->plan;
+    q->plan = nullptr;
 }
 
 static int cmp_func (const QofQuerySort *sort, QofSortFunc default_sort,
@@ -372,53 +440,72 @@ sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
     }
 }
 
+static bool
+query_is_sorted (const QofQuery *q)
+{
+    return q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+        (q->primary_sort.use_default && q->defaultSort);
+}
+
+bool
+QofQueryResultLess::operator() (gpointer a, gpointer b) const
+{
+    return query_is_sorted (query) && sort_func (a, b, query) < 0;
+}
+
 /* ==================================================================== */
 /* This is the main workhorse for performing the query.  For each
  * object, it walks over all of the query terms to see if the
  * object passes the seive.
  */
 
-static int
-check_object (const QofQuery *q, gpointer object)
-{
-    const GList     * and_ptr;
-    const GList     * or_ptr;
-    const QofQueryTerm * qt;
-    int       and_terms_ok = 1;
+/* How many objects an AND term is tested on between reorderings. */
+static constexpr guint reorder_interval = 256;
 
-    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+/* Order the AND terms so that the ones that are cheapest for how often
+ * they reject an object come first. */
+static void
+reorder_terms (QofCompiledAndTerms& and_terms)
+{
+    auto rank = [](const QofCompiledTerm& term)
     {
-        and_terms_ok = 1;
-        for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
-	     and_ptr = static_cast<GList*>(and_ptr->next))
-        {
-            qt = (QofQueryTerm *)(and_ptr->data);
-            if (qt->param_fcns && qt->pred_fcn)
-            {
-                const GSList *node;
-                QofParam *param = nullptr;
-                gpointer conv_obj = object;
+        return term.cost * (term.tested + 2.0) / (term.rejected + 1.0);
+    };
+    std::stable_sort (and_terms.terms.begin(), and_terms.terms.end(),
+                      [rank](const QofCompiledTerm& a, const QofCompiledTerm& b)
+                      { return rank (a) < rank (b); });
+    and_terms.until_reorder = reorder_interval;
+}
 
-                /* iterate through the conversions */
-                for (node = qt->param_fcns; node; node = node->next)
-                {
-                    param = static_cast<QofParam*>(node->data);
+static inline gboolean
+check_term (const QofCompiledTerm& term, gpointer object)
+{
+    auto last = term.params.size () - 1;
 
-                    /* The last term is the actual parameter getter */
-                    if (!node->next) break;
+    /* iterate through the conversions */
+    for (size_t i = 0; i < last; ++i)
+        object = term.params[i]->param_getfcn (object, term.params[i]);
 
-                    conv_obj = param->param_getfcn (conv_obj, param);
-                }
+    return ((term.pred_fcn)(object, term.params[last], term.pdata)) != term.invert;
+}
 
-                if (((qt->pred_fcn)(conv_obj, param, qt->pdata)) == qt->invert)
-                {
-                    and_terms_ok = 0;
-                    break;
-                }
-            }
-            else
+static int
+check_object (QofQuery *q, gpointer object)
+{
+    for (auto& and_terms : q->plan->or_terms)
+    {
+        if (!--and_terms.until_reorder)
+            reorder_terms (and_terms);
+
+        int and_terms_ok = 1;
+        for (auto& term : and_terms.terms)
+        {
+            ++term.tested;
+            if (!check_term (term, object))
             {
-                /* XXX: Don't know how to do this conversion -- do we care? */
+                ++term.rejected;
+                and_terms_ok = 0;
+                break;
             }
         }
         if (and_terms_ok)
@@ -524,6 +611,59 @@ compile_sort (QofQuerySort *sort, QofIdType obj)
     LEAVE ("sort=%p id=%s", sort, obj);
 }
 
+/* Estimate how much testing a term costs relative to the others. */
+static guint
+term_cost (const QofCompiledTerm& term)
+{
+    /* Each getter is a call that probably chases a pointer. */
+    guint cost = term.params.size ();
+    auto pdata = term.pdata;
+
+    if (!g_strcmp0 (pdata->type_name, QOF_TYPE_STRING))
+    {
+        auto sdata = reinterpret_cast<query_string_t>(pdata);
+        if (sdata->is_regex)
+            cost += 32;
+        else if (sdata->options == QOF_STRING_MATCH_CASEINSENSITIVE)
+            cost += 16;
+        else
+            cost += 4;
+    }
+    else if (!g_strcmp0 (pdata->type_name, QOF_TYPE_GUID))
+        cost += g_list_length (reinterpret_cast<query_guid_t>(pdata)->guids);
+    else
+        cost += 1;
+    return cost;
+}
+
+/* Flatten the compiled terms into the query's plan, so that checking an
+ * object walks vectors instead of lists. Terms whose parameters couldn't
+ * be resolved don't reject anything and are left out. */
+static void compile_plan (QofQuery *q)
+{
+    delete q->plan;
+    q->plan = new QofQueryPlan {q};
+    for (auto or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        QofCompiledAndTerms and_terms {{}, reorder_interval};
+        for (auto and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
+             and_ptr = and_ptr->next)
+        {
+            auto qt = static_cast<QofQueryTerm*>(and_ptr->data);
+            if (!qt->param_fcns || !qt->pred_fcn)
+                continue;
+
+            QofCompiledTerm term {{}, qt->pred_fcn, qt->pdata, qt->invert, 0, 0, 0};
+            for (auto node = qt->param_fcns; node; node = node->next)
+                term.params.push_back (static_cast<QofParam*>(node->data));
+            term.cost = term_cost (term);
+            and_terms.terms.push_back (std::move (term));
+        }
+        reorder_terms (and_terms);
+        q->plan->or_terms.push_back (std::move (and_terms));
+    }
+}
+
 static void compile_terms (QofQuery *q)
 {
     GList *or_ptr, *and_ptr;
@@ -558,6 +698,8 @@ static void compile_terms (QofQuery *q)
         }
     }
 
+    compile_plan (q);
+
     /* Update the sort functions */
     compile_sort (&(q->primary_sort), q->search_for);
     compile_sort (&(q->secondary_sort), q->search_for);
@@ -723,6 +865,7 @@ void qof_query_purge_terms (QofQuery *q, QofQueryParamList *param_list)
                     q->terms = g_list_remove_link (static_cast<GList*>(q->terms), _or_);
                     g_list_free_1 (_or_);
                     _or_ = q->terms;
+                    q->changed = 1;
                     break;
                 }
                 else
@@ -790,8 +933,7 @@ static GList * qof_query_run_internal (QofQuery *q,
     matching_objects = g_list_reverse(matching_objects);
 
     /* Now sort the matching objects based on the search criteria */
-    if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
-            (q->primary_sort.use_default && q->defaultSort))
+    if (query_is_sorted (q))
     {
         matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
     }
@@ -827,6 +969,20 @@ static GList * qof_query_run_internal (QofQuery *q,
     g_list_free(q->results);
     q->results = matching_objects;
 
+    if (q->plan)
+    {
+        auto plan = q->plan;
+        plan->results.clear ();
+        plan->result_nodes.clear ();
+        plan->result_nodes.reserve (object_count);
+        for (auto node = matching_objects; node; node = node->next)
+            plan->result_nodes[node->data] =
+                plan->results.emplace_hint (plan->results.end (), node->data);
+        plan->results_updatable = q->max_results < 0 ||
+            object_count <= q->max_results;
+        plan->results_list_stale = false;
+    }
+
     LEAVE (" q=%p", q);
     return matching_objects;
 }
@@ -856,7 +1012,17 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 #endif
-        /* And then iterate over all the objects */
+        /* Let a backend that loads lazily fetch what the query may match */
+        if (book->backend)
+            book->backend->run_query (qcb->query);
+
+        /* And then iterate over the objects the index says may match,
+         * or all of them if there's no index that can narrow it down */
+        auto index = query_indexes.find (qcb->query->search_for);
+        if (index != query_indexes.end () &&
+            (index->second) (book, qcb->query,
+                             (QofInstanceForeachCB) check_item_cb, qcb))
+            continue;
         qof_object_foreach (qcb->query->search_for, book,
                             (QofInstanceForeachCB) check_item_cb, qcb);
     }
@@ -889,8 +1055,93 @@ qof_query_run_subquery (QofQuery *subq, const QofQuery* primaryq)
                          nullptr);
 
     /* Perform the subquery */
-    return qof_query_run_internal(subq, qof_query_run_subq_cb,
-                                  (gpointer)primaryq);
+    auto results = qof_query_run_internal(subq, qof_query_run_subq_cb,
+                                          (gpointer)primaryq);
+
+    /* Changed objects can't be checked against the primary query's results */
+    if (subq->plan)
+        subq->plan->results_updatable = false;
+    return results;
+}
+
+static void
+remove_result (QofQueryPlan *plan, gpointer object)
+{
+    auto node = plan->result_nodes.find (object);
+    if (node == plan->result_nodes.end ())
+        return;
+
+    plan->results.erase (node->second);
+    plan->result_nodes.erase (node);
+    plan->results_list_stale = true;
+}
+
+gboolean
+qof_query_update_results (QofQuery *q, GList *changed)
+{
+    g_return_val_if_fail (q, FALSE);
+    if (q->changed || !q->plan || !q->plan->results_updatable)
+        return FALSE;
+
+    ENTER (" q=%p", q);
+    auto plan = q->plan;
+    for (auto node = changed; node; node = node->next)
+    {
+        auto object = node->data;
+
+        /* Take it out and put it back wherever it belongs now */
+        remove_result (plan, object);
+        auto inst = QOF_INSTANCE (object);
+        if (g_strcmp0 (inst->e_type, q->search_for) ||
+            !g_list_find (q->books, qof_instance_get_book (inst)) ||
+            !check_object (q, object))
+            continue;
+
+        plan->result_nodes[object] = plan->results.insert (object);
+        plan->results_list_stale = true;
+    }
+
+    /* Crop the results the way qof_query_run_internal() does. */
+    auto& results = plan->results;
+    if (q->max_results > -1 && results.size () > (size_t) q->max_results)
+    {
+        auto excess = results.size () - q->max_results;
+        for (size_t i = 0; i < excess; ++i)
+        {
+            plan->result_nodes.erase (*results.begin ());
+            results.erase (results.begin ());
+        }
+        plan->results_updatable = false;
+    }
+
+    LEAVE (" q=%p", q);
+    return TRUE;
+}
+
+/* Bring the query's result list up to date with the results
+ * qof_query_update_results() has changed. */
+static void
+query_sync_results (QofQuery *q)
+{
+    if (!q->plan || !q->plan->results_list_stale)
+        return;
+
+    g_list_free (q->results);
+    q->results = nullptr;
+    auto& results = q->plan->results;
+    for (auto it = results.rbegin (); it != results.rend (); ++it)
+        q->results = g_list_prepend (q->results, *it);
+    q->plan->results_list_stale = false;
+}
+
+/* The results are no longer in the order, or of the number, that the
+ * query would give, so only running it again can update them. */
+static void
+query_results_outdated (QofQuery *q)
+{
+    query_sync_results (q);
+    if (q->plan)
+        q->plan->results_updatable = false;
 }
 
 GList *
@@ -899,6 +1150,7 @@ qof_query_last_run (QofQuery *query)
     if (!query)
         return nullptr;
 
+    query_sync_results (query);
     return query->results;
 }
 
@@ -1025,9 +1277,11 @@ QofQuery * qof_query_copy (QofQuery *q)
     ht = copy->be_compiled;
     free_members (copy);
 
+    query_sync_results (q);
     *copy = *q;
 
     copy->be_compiled = ht;
+    copy->plan = nullptr;
     copy->terms = copy_or_terms (q->terms);
     copy->books = g_list_copy (q->books);
     copy->results = g_list_copy (q->results);
@@ -1275,6 +1529,7 @@ void qof_query_set_sort_options (QofQuery *q, gint prim_op, gint sec_op,
     q->primary_sort.options = prim_op;
     q->secondary_sort.options = sec_op;
     q->tertiary_sort.options = tert_op;
+    query_results_outdated (q);
 }
 
 void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
@@ -1284,12 +1539,14 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
     q->primary_sort.increasing = prim_inc;
     q->secondary_sort.increasing = sec_inc;
     q->tertiary_sort.increasing = tert_inc;
+    query_results_outdated (q);
 }
 
 void qof_query_set_max_results (QofQuery *q, int n)
 {
     if (!q) return;
     q->max_results = n;
+    query_results_outdated (q);
 }
 
 void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
@@ -1367,10 +1624,20 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    query_indexes.clear ();
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
 
+void qof_query_register_index (QofIdTypeConst obj_type, QofQueryIndexFunc func)
+{
+    g_return_if_fail (obj_type);
+    if (func)
+        query_indexes[obj_type] = func;
+    else
+        query_indexes.erase (obj_type);
+}
+
 int qof_query_get_max_results (const QofQuery *q)
 {
     if (!q) return 0;
@@ -226,6 +226,21 @@ GList * qof_query_run (QofQuery *query);
  */
 GList * qof_query_last_run (QofQuery *query);
 
+/** Bring the results of the last run of query up to date after some
+ *  objects changed, instead of running it again.
+ *
+ *  Each object in changed is checked again and inserted into, moved within
+ *  or taken out of the results. Every other object must still match, or
+ *  not, as it did when the query ran and keep its place in the sort order,
+ *  and none of the results may have been freed.
+ *
+ *  @return FALSE, leaving the results alone, if query has changed since it
+ *  last ran, its results were cut short by its max_results, or it was last
+ *  run as a subquery. It has to be run again then. Otherwise TRUE, and
+ *  qof_query_last_run() returns the updated results.
+ */
+gboolean qof_query_update_results (QofQuery *query, GList *changed);
+
 /** Perform a subquery, return the results.
  *  Instead of running over a book, the subquery runs over the results
  *  of the primary query.
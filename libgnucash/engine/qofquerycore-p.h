@@ -69,6 +69,7 @@ typedef struct
     gboolean		is_regex;
     gchar *		matchstring;
     regex_t		compiled;
+    gchar *		matchstring_folded; /* casefolded, for CONTAINS nocase */
 } query_string_def, *query_string_t;
 
 typedef struct
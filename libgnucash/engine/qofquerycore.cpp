@@ -125,6 +125,51 @@ static GHashTable *predEqualTable = nullptr;
 
 /* QOF_TYPE_STRING */
 
+/* Casefold and normalize a string the way qof_utf8_substr_nocase does. */
+static gchar *
+fold_string (const char *str)
+{
+    auto casefold = g_utf8_casefold (str, -1);
+    auto folded = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFC);
+    g_free (casefold);
+    return folded;
+}
+
+/* Whether the casefolded haystack contains folded_needle. ASCII folds to
+ * ASCII byte for byte and is already normalized, so an ASCII haystack is
+ * searched in place rather than copied and folded. */
+static gboolean
+substr_nocase_folded (const char *haystack, const char *folded_needle)
+{
+    auto is_ascii = [](const char *str)
+    {
+        for (; *str; ++str)
+            if (static_cast<unsigned char>(*str) >= 0x80)
+                return false;
+        return true;
+    };
+
+    if (!is_ascii (haystack))
+    {
+        auto folded = fold_string (haystack);
+        gboolean found = strstr (folded, folded_needle) != nullptr;
+        g_free (folded);
+        return found;
+    }
+
+    for (; ; ++haystack)
+    {
+        size_t i = 0;
+        while (folded_needle[i] &&
+               g_ascii_tolower (haystack[i]) == folded_needle[i])
+            ++i;
+        if (!folded_needle[i])
+            return TRUE;
+        if (!*haystack)
+            return FALSE;
+    }
+}
+
 static int
 string_match_predicate (gpointer object,
                         QofParam *getter,
@@ -152,7 +197,7 @@ string_match_predicate (gpointer object,
         {
             if (pd->how == QOF_COMPARE_CONTAINS || pd->how == QOF_COMPARE_NCONTAINS)
             {
-                if (qof_utf8_substr_nocase (s, pdata->matchstring)) //uses strstr
+                if (substr_nocase_folded (s, pdata->matchstring_folded))
                     ret = 1;
             }
             else
@@ -249,6 +294,7 @@ string_free_pdata (QofQueryPredData *pd)
         regfree (&pdata->compiled);
 
     g_free (pdata->matchstring);
+    g_free (pdata->matchstring_folded);
     g_free (pdata);
 }
 
@@ -292,6 +338,8 @@ qof_query_string_predicate (QofQueryCompare how,
     pdata->pd.how = how;
     pdata->options = options;
     pdata->matchstring = g_strdup (str);
+    if (options == QOF_STRING_MATCH_CASEINSENSITIVE && !is_regex)
+        pdata->matchstring_folded = fold_string (str);
 
     if (is_regex)
     {
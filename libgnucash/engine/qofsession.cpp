@@ -223,7 +223,9 @@ QofSessionImpl::load (QofPercentageFunc percentage_func) noexcept
     if (m_backend)
     {
         m_backend->set_percentage(percentage_func);
+        qof_book_begin_bulk_load (m_book);
         m_backend->load (m_book, LOAD_TYPE_INITIAL_LOAD);
+        qof_book_end_bulk_load (m_book);
         push_error (m_backend->get_error(), {});
     }
 
@@ -232,6 +234,7 @@ QofSessionImpl::load (QofPercentageFunc percentage_func) noexcept
         (err != ERR_FILEIO_FILE_TOO_OLD) &&
         (err != ERR_FILEIO_NO_ENCODING) &&
         (err != ERR_FILEIO_FILE_UPGRADE) &&
+        (err != ERR_FILEIO_JOURNAL_REJECTED) &&
         (err != ERR_SQL_DB_TOO_OLD) &&
         (err != ERR_SQL_DB_TOO_NEW))
     {
@@ -608,6 +608,62 @@ TEST(gnc_datetime_functions, test_date)
     EXPECT_EQ(ymd.month, 11);
     EXPECT_EQ(ymd.day - (12 + atime.offset() / 3600) / 24, 13);
 }
+
+static ::testing::AssertionResult
+same_local_conversions(time64 time, const char* zone)
+{
+    GncDateTime gdt{time};
+    auto expected = static_cast<struct tm>(gdt);
+    auto tm = GncDateTime::local_tm(time);
+    if (tm.tm_year != expected.tm_year || tm.tm_mon != expected.tm_mon ||
+        tm.tm_mday != expected.tm_mday || tm.tm_hour != expected.tm_hour ||
+        tm.tm_min != expected.tm_min || tm.tm_sec != expected.tm_sec ||
+        tm.tm_wday != expected.tm_wday || tm.tm_yday != expected.tm_yday ||
+        tm.tm_isdst != expected.tm_isdst)
+        return ::testing::AssertionFailure() << zone << ": local_tm differs at "
+                                             << gdt.format("%D %T %z");
+    /* Include the times skipped and repeated by DST changes. */
+    tm.tm_min = (tm.tm_min + 37) % 60;
+    if (GncDateTime::local_time64(tm) != static_cast<time64>(GncDateTime(tm)))
+        return ::testing::AssertionFailure() << zone << ": local_time64 differs at "
+                                             << gdt.format("%D %T %z");
+    auto date = gdt.date();
+    for (auto part : {DayPart::start, DayPart::neutral, DayPart::end})
+        if (GncDateTime::date_time64(date, part) !=
+            static_cast<time64>(GncDateTime(date, part)))
+            return ::testing::AssertionFailure() << zone << ": date_time64 differs at "
+                                                 << gdt.format("%D %T %z");
+    return ::testing::AssertionSuccess();
+}
+
+TEST(gnc_datetime_functions, test_local_conversions)
+{
+#ifdef __MINGW32__
+    TimeZoneProvider tzp_can{"A.U.S Eastern Standard Time"};
+    TimeZoneProvider tzp_la{"Pacific Standard Time"};
+    TimeZoneProvider tzp_lon{"GMT Standard Time"};
+#else
+    TimeZoneProvider tzp_can("Australia/Canberra");
+    TimeZoneProvider tzp_la("America/Los_Angeles");
+    TimeZoneProvider tzp_lon("Europe/London");
+#endif
+    const time64 start = 1546300800; //2019-01-01 00:00:00 Z
+    const time64 end = 1609459200; //2021-01-01 00:00:00 Z
+    for (auto tzp : {std::make_pair(&tzp_la, "Los Angeles"),
+                     std::make_pair(&tzp_can, "Canberra"),
+                     std::make_pair(&tzp_lon, "London")})
+    {
+        _set_tzp(*tzp.first);
+        for (auto time = start; time < end; time += 3 * 3600 + 7 * 60 + 11)
+            EXPECT_TRUE(same_local_conversions(time, tzp.second));
+        for (auto transition : {1583657940, 1601737140, 1604217540, 1586008740})
+            for (auto time = transition - 4 * 3600; time < transition + 28 * 3600;
+                 time += 60)
+                EXPECT_TRUE(same_local_conversions(time, tzp.second));
+        _reset_tzp();
+    }
+}
+
 /* This test works only in the America/LosAngeles time zone and
  * there's no straightforward way to make it more flexible. It ensures
  * that DST in that timezone transitions correctly for each day of the
@@ -24,6 +24,9 @@
 #include <gtest/gtest.h>
 #include "../gnc-int128.hpp"
 
+#include <random>
+#include <vector>
+
 TEST(GncInt128_constructors, test_default_constructor)
 {
     GncInt128 value {};
@@ -616,3 +619,60 @@ TEST(GncInt128_functions, shift)
     EXPECT_EQ(GncInt128(UINT64_C(0x1e89fe89fe89fe89), UINT64_C(0), 1), b << 64);
     EXPECT_EQ(GncInt128(UINT64_C(0), UINT64_C(0xabcdabcd), 1), b >> 64);
 }
+
+static std::vector<GncInt128>
+random_values (size_t count, unsigned int max_bits)
+{
+    std::mt19937_64 gen {42};
+    std::vector<GncInt128> values;
+    values.reserve (count);
+    while (values.size () < count)
+    {
+        auto bits = static_cast<unsigned int>(gen () % max_bits) + 1;
+        GncInt128 value (gen () & ((UINT64_C(1) << (bits > 64 ? bits - 64 : 0)) - 1),
+                         bits >= 64 ? gen () : gen () & ((UINT64_C(1) << bits) - 1),
+                         gen () & 1 ? GncInt128::neg : GncInt128::pos);
+        if (!value.isZero ())
+            values.push_back (value);
+    }
+    return values;
+}
+
+TEST(GncInt128_functions, random_arithmetic)
+{
+    auto values = random_values (20000, GncInt128::maxbits);
+    auto small = random_values (20000, 62);
+    for (size_t i = 0; i + 1 < values.size (); ++i)
+    {
+        auto n = values[i], d = values[i + 1];
+        if (i % 2)
+            d = small[i];
+        GncInt128 q, r;
+        n.div (d, q, r);
+        EXPECT_LT (r.abs (), d.abs ());
+        if (!r.isZero ())
+        {
+            EXPECT_EQ (n.isNeg (), r.isNeg ());
+        }
+        EXPECT_EQ (n, q * d + r);
+
+        auto g = n.gcd (d);
+        EXPECT_FALSE (g.isNeg ());
+        EXPECT_TRUE ((n % g).isZero ());
+        EXPECT_TRUE ((d % g).isZero ());
+        EXPECT_EQ (GncInt128 (1), (n / g).gcd (d / g));
+
+        auto p = small[i] * small[i + 1];
+        EXPECT_FALSE (p.isOverflow ());
+        EXPECT_EQ (small[i], p / small[i + 1]);
+        EXPECT_EQ (small[i].isNeg () != small[i + 1].isNeg (), p.isNeg ());
+        auto big = n * d;
+        EXPECT_EQ (n.bits () + d.bits () > GncInt128::maxbits + 1 ||
+                   (n.bits () + d.bits () > GncInt128::maxbits &&
+                    big.isOverflow ()), big.isOverflow ());
+        if (!big.isOverflow ())
+        {
+            EXPECT_EQ (n, big / d);
+        }
+    }
+}
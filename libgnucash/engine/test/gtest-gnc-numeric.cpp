@@ -24,6 +24,8 @@
 #include "../gnc-numeric.hpp"
 #include "../gnc-rational.hpp"
 
+#include <vector>
+
 TEST(gncnumeric_constructors, test_default_constructor)
 {
     GncNumeric value;
@@ -592,6 +594,39 @@ TEST(gncnumeric_functions, test_convert)
     EXPECT_EQ(100, c.denom());
 }
 
+TEST(gncnumeric_functions, test_try_convert)
+{
+    GncNumeric a(12345678, 456), b(-12345678, 456), c(7, 3);
+    EXPECT_EQ(GNC_ERROR_OK, a.try_convert<RoundType::never>(456, c));
+    EXPECT_EQ(12345678, c.num());
+    EXPECT_EQ(456, c.denom());
+    EXPECT_EQ(GNC_ERROR_REMAINDER, a.try_convert<RoundType::never>(128, c));
+    EXPECT_EQ(12345678, c.num());
+    EXPECT_EQ(456, c.denom());
+    EXPECT_EQ(GNC_ERROR_OK, b.try_convert<RoundType::floor>(128, c));
+    EXPECT_EQ(-3465454, c.num());
+    EXPECT_EQ(128, c.denom());
+    EXPECT_EQ(GNC_ERROR_OK, a.try_convert<RoundType::bankers>(GNC_DENOM_AUTO, c));
+    EXPECT_EQ(12345678, c.num());
+    EXPECT_EQ(456, c.denom());
+    GncNumeric big(INT64_C(4611686018427387904), 3);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, big.try_convert<RoundType::half_up>(100, c));
+    EXPECT_EQ(GNC_ERROR_OK, a.try_convert_sigfigs<RoundType::half_up>(3, c));
+    EXPECT_EQ(27074, c.num());
+    EXPECT_EQ(1, c.denom());
+    EXPECT_EQ(GNC_ERROR_REMAINDER, a.try_convert_sigfigs<RoundType::never>(3, c));
+
+    /* The C API reports the same errors without throwing. */
+    auto r = gnc_numeric_convert(gnc_numeric{12345678, 456}, 128, GNC_HOW_RND_NEVER);
+    EXPECT_EQ(GNC_ERROR_REMAINDER, gnc_numeric_check(r));
+    r = gnc_numeric_convert(gnc_numeric{INT64_C(4611686018427387904), 3}, 100,
+                            GNC_HOW_RND_ROUND_HALF_UP);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, gnc_numeric_check(r));
+    r = gnc_numeric_convert(gnc_numeric{12345678, 456}, 128, GNC_HOW_RND_FLOOR);
+    EXPECT_EQ(3465453, r.num);
+    EXPECT_EQ(128, r.denom);
+}
+
 TEST(gnc_numeric_functions, test_is_decimal)
 {
     EXPECT_TRUE(GncNumeric(123, 1).is_decimal());
@@ -626,3 +661,136 @@ TEST(gnc_numeric_functions, test_conversion_to_decimal)
     EXPECT_EQ(100, r.num());
     EXPECT_EQ(1, r.denom());
 }
+
+TEST(gnc_numeric_functions, test_same_denom_arithmetic)
+{
+    const int fixed = GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER;
+    gnc_numeric a{12345, 100}, b{-678, 100}, r;
+    r = gnc_numeric_add(a, b, GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(11667, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_sub(a, b, 100, GNC_HOW_RND_ROUND_HALF_UP);
+    EXPECT_EQ(13023, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_add(a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    EXPECT_EQ(11667, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_mul(a, gnc_numeric{3, 1}, GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(37035, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_mul(gnc_numeric{-2, 1}, a, 100, GNC_HOW_RND_ROUND);
+    EXPECT_EQ(-24690, r.num);
+    EXPECT_EQ(100, r.denom);
+
+    /* Reducing still reduces. */
+    r = gnc_numeric_add(a, gnc_numeric{55, 100}, GNC_DENOM_AUTO,
+                        GNC_HOW_DENOM_REDUCE | GNC_HOW_RND_NEVER);
+    EXPECT_EQ(124, r.num);
+    EXPECT_EQ(1, r.denom);
+    /* A different denominator rounds. */
+    r = gnc_numeric_add(a, gnc_numeric{6, 100}, 10, GNC_HOW_RND_ROUND_HALF_UP);
+    EXPECT_EQ(1235, r.num);
+    EXPECT_EQ(10, r.denom);
+    /* Overflowing 64 bits doesn't wrap around. */
+    r = gnc_numeric_add(gnc_numeric{INT64_MAX, 100}, gnc_numeric{1, 100},
+                        GNC_DENOM_AUTO, fixed);
+    EXPECT_NE(INT64_MIN, r.num);
+    /* Nor does a result of exactly INT64_MIN come back as is. */
+    const gnc_numeric half_min{INT64_MIN / 2, 100};
+    r = gnc_numeric_add(half_min, half_min, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, gnc_numeric_check(r));
+    r = gnc_numeric_sub(half_min, gnc_numeric{-(INT64_MIN / 2), 100},
+                        GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, gnc_numeric_check(r));
+    r = gnc_numeric_mul(half_min, gnc_numeric{2, 1}, GNC_DENOM_AUTO,
+                        GNC_HOW_DENOM_LCD);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, gnc_numeric_check(r));
+    r = gnc_numeric_add(half_min, half_min, GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(INT64_MIN / 4, r.num);
+    EXPECT_EQ(25, r.denom);
+    r = gnc_numeric_mul(gnc_numeric{INT64_MAX / 2, 100}, gnc_numeric{3, 1},
+                        GNC_DENOM_AUTO, fixed);
+    EXPECT_FALSE(r.num < 0 && r.denom == 100);
+}
+
+TEST(gnc_numeric_functions, test_sum)
+{
+    const int fixed = GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER;
+    EXPECT_TRUE(gnc_numeric_zero_p(gnc_numeric_sum(nullptr, 0, GNC_DENOM_AUTO,
+                                                   fixed)));
+
+    std::vector<gnc_numeric> values{{1050, 100}, {-25, 100}, {99999, 100},
+                                    {1, 3}, {700, 100}, {7, 10}};
+    for (size_t count = 1; count <= values.size(); ++count)
+    {
+        auto expected = values[0];
+        for (size_t i = 1; i < count; ++i)
+            expected = gnc_numeric_add(expected, values[i], GNC_DENOM_AUTO,
+                                       GNC_HOW_DENOM_LCD);
+        auto sum = gnc_numeric_sum(values.data(), count, GNC_DENOM_AUTO,
+                                   GNC_HOW_DENOM_LCD);
+        EXPECT_EQ(expected.num, sum.num);
+        EXPECT_EQ(expected.denom, sum.denom);
+    }
+
+    std::vector<gnc_numeric> big{{INT64_MAX - 5, 100}, {10, 100}, {1, 100}};
+    auto sum = gnc_numeric_sum(big.data(), big.size(), GNC_DENOM_AUTO, fixed);
+    auto expected = gnc_numeric_add(gnc_numeric_add(big[0], big[1],
+                                                    GNC_DENOM_AUTO, fixed),
+                                    big[2], GNC_DENOM_AUTO, fixed);
+    EXPECT_EQ(gnc_numeric_check(expected), gnc_numeric_check(sum));
+    if (!gnc_numeric_check(expected))
+    {
+        EXPECT_TRUE(gnc_numeric_equal(expected, sum));
+    }
+
+    std::vector<gnc_numeric> bad{{1, 100}, gnc_numeric_error(GNC_ERROR_ARG)};
+    EXPECT_EQ(GNC_ERROR_ARG, gnc_numeric_check(gnc_numeric_sum(bad.data(),
+                                                               bad.size(),
+                                                               GNC_DENOM_AUTO,
+                                                               fixed)));
+}
+
+TEST(gnc_numeric_functions, test_to_common_denom)
+{
+    gint64 denom{};
+    EXPECT_EQ(GNC_ERROR_OK, gnc_numeric_to_common_denom(nullptr, 0, &denom));
+    EXPECT_EQ(1, denom);
+
+    std::vector<gnc_numeric> values{{1050, 100}, {-1, 3}, {7, 10}, {5, 1},
+                                    {-25, 100}};
+    auto original = values;
+    EXPECT_EQ(GNC_ERROR_OK, gnc_numeric_to_common_denom(values.data(),
+                                                        values.size(), &denom));
+    EXPECT_EQ(300, denom);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        EXPECT_EQ(300, values[i].denom);
+        EXPECT_TRUE(gnc_numeric_equal(original[i], values[i]));
+    }
+
+    std::vector<gnc_numeric> same{{1, 100}, {2, 100}};
+    EXPECT_EQ(GNC_ERROR_OK, gnc_numeric_to_common_denom(same.data(),
+                                                        same.size(), nullptr));
+    EXPECT_EQ(1, same[0].num);
+    EXPECT_EQ(2, same[1].num);
+
+    std::vector<gnc_numeric> big{{INT64_MAX / 2, 100}, {1, 300}};
+    original = big;
+    EXPECT_EQ(GNC_ERROR_OVERFLOW,
+              gnc_numeric_to_common_denom(big.data(), big.size(), &denom));
+    EXPECT_EQ(original[0].num, big[0].num);
+    EXPECT_EQ(original[0].denom, big[0].denom);
+    std::vector<gnc_numeric> coprime{{1, INT64_C(4294967311)},
+                                     {1, INT64_C(4294967357)}};
+    EXPECT_EQ(GNC_ERROR_OVERFLOW,
+              gnc_numeric_to_common_denom(coprime.data(), coprime.size(),
+                                          &denom));
+
+    std::vector<gnc_numeric> bad{{1, 100}, {3, -10}};
+    EXPECT_EQ(GNC_ERROR_ARG,
+              gnc_numeric_to_common_denom(bad.data(), bad.size(), &denom));
+    bad[1] = gnc_numeric_error(GNC_ERROR_OVERFLOW);
+    EXPECT_EQ(GNC_ERROR_ARG,
+              gnc_numeric_to_common_denom(bad.data(), bad.size(), &denom));
+}
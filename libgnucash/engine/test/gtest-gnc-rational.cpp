@@ -177,3 +177,21 @@ TEST(gncrational_functions, test_round_to_numeric)
 
     }
 }
+
+TEST(gncrational_functions, test_try_convert)
+{
+    GncRational a(12345678, 456), c(7, 3);
+    EXPECT_EQ(GNC_ERROR_OK, a.try_convert<RoundType::never>(456, c));
+    EXPECT_EQ(12345678, c.num());
+    EXPECT_EQ(456, c.denom());
+    EXPECT_EQ(GNC_ERROR_REMAINDER, a.try_convert<RoundType::never>(128, c));
+    EXPECT_EQ(12345678, c.num());
+    EXPECT_EQ(GNC_ERROR_OK, a.try_convert<RoundType::ceiling>(128, c));
+    EXPECT_EQ(3465454, c.num());
+    EXPECT_EQ(128, c.denom());
+    GncRational big(GncInt128(INT64_C(0x0fffffffffffffff), UINT64_C(0)), 3);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, big.try_convert<RoundType::half_up>(1000, c));
+    EXPECT_EQ(GNC_ERROR_OK, a.try_convert_sigfigs<RoundType::half_up>(3, c));
+    EXPECT_EQ(27074, c.num());
+    EXPECT_EQ(1, c.denom());
+}
@@ -0,0 +1,123 @@
+/********************************************************************
+ * gtest-qof-guid-table.cpp -- unit tests for QofGuidTable          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#include <gtest/gtest.h>
+#include "../qof-guid-table.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/* The table never dereferences its values, so any non-null pointer will do. */
+static QofInstance*
+fake_instance (size_t i)
+{
+    return reinterpret_cast<QofInstance*> (static_cast<uintptr_t> (i + 1) * 8);
+}
+
+static std::vector<GncGUID>
+random_guids (size_t count)
+{
+    std::mt19937_64 gen {42};
+    std::vector<GncGUID> guids (count);
+    for (auto& guid : guids)
+    {
+        uint64_t halves[2] {gen (), gen ()};
+        std::memcpy (guid.reserved, halves, sizeof halves);
+    }
+    return guids;
+}
+
+/* GUIDs that differ only in their last bytes, to make the probe sequences
+ * collide and overlap. */
+static std::vector<GncGUID>
+sequential_guids (size_t count)
+{
+    std::vector<GncGUID> guids (count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::memset (guids[i].reserved, 0, GUID_DATA_SIZE);
+        uint32_t n = static_cast<uint32_t> (i + 1);
+        std::memcpy (guids[i].reserved + GUID_DATA_SIZE - sizeof n, &n, sizeof n);
+    }
+    return guids;
+}
+
+static void
+check_insert_lookup_remove (const std::vector<GncGUID>& guids)
+{
+    QofGuidTable table;
+    for (size_t i = 0; i < guids.size (); ++i)
+        table.insert (guids[i], fake_instance (i));
+    EXPECT_EQ (guids.size (), table.size ());
+    for (size_t i = 0; i < guids.size (); ++i)
+        EXPECT_EQ (fake_instance (i), table.lookup (guids[i]));
+
+    for (size_t i = 0; i < guids.size (); i += 3)
+        EXPECT_TRUE (table.remove (guids[i]));
+    EXPECT_FALSE (table.remove (guids[0]));
+    for (size_t i = 0; i < guids.size (); ++i)
+        EXPECT_EQ (i % 3 ? fake_instance (i) : nullptr, table.lookup (guids[i]));
+
+    size_t count {};
+    table.for_each ([&count](QofInstance*) { ++count; });
+    EXPECT_EQ (table.size (), count);
+}
+
+TEST (QofGuidTable, insert_lookup_remove_random)
+{
+    check_insert_lookup_remove (random_guids (10000));
+}
+
+TEST (QofGuidTable, insert_lookup_remove_sequential)
+{
+    check_insert_lookup_remove (sequential_guids (10000));
+}
+
+TEST (QofGuidTable, replace)
+{
+    auto guids = random_guids (2);
+    QofGuidTable table;
+    EXPECT_EQ (nullptr, table.lookup (guids[0]));
+    EXPECT_FALSE (table.remove (guids[0]));
+    table.insert (guids[0], fake_instance (0));
+    table.insert (guids[0], fake_instance (1));
+    EXPECT_EQ (1u, table.size ());
+    EXPECT_EQ (fake_instance (1), table.lookup (guids[0]));
+    EXPECT_EQ (nullptr, table.lookup (guids[1]));
+}
+
+TEST (QofGuidTable, reserve)
+{
+    auto guids = random_guids (1000);
+    QofGuidTable table;
+    for (size_t i = 0; i < 10; ++i)
+        table.insert (guids[i], fake_instance (i));
+    table.reserve (guids.size ());
+    for (size_t i = 10; i < guids.size (); ++i)
+        table.insert (guids[i], fake_instance (i));
+    for (size_t i = 0; i < guids.size (); ++i)
+        EXPECT_EQ (fake_instance (i), table.lookup (guids[i]));
+    table.reserve (1);
+    EXPECT_EQ (guids.size (), table.size ());
+}
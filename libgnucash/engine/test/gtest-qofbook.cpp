@@ -0,0 +1,73 @@
+/********************************************************************\
+ * gtest-qofbook.cpp -- Unit tests for qofbook.cpp                  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ \ *********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include "../qofbook.h"
+#include "../kvp-frame.hpp"
+#include <gtest/gtest.h>
+
+/* The arena KVP frames are allocated from right now. */
+static KvpFrameArena*
+current_arena ()
+{
+    auto arena = kvp_frame_arena_set_current (nullptr);
+    kvp_frame_arena_set_current (arena);
+    return arena;
+}
+
+TEST (qofbook, bulk_load_restores_arena)
+{
+    auto book = qof_book_new ();
+    auto other = qof_book_new ();
+    ASSERT_EQ (nullptr, current_arena ());
+
+    qof_book_begin_bulk_load (book);
+    auto book_arena = current_arena ();
+    EXPECT_NE (nullptr, book_arena);
+    EXPECT_EQ (book->kvp_arena, book_arena);
+
+    /* A nested load of the same book keeps its arena until the outer
+     * one ends. */
+    qof_book_begin_bulk_load (book);
+    qof_book_end_bulk_load (book);
+    EXPECT_EQ (book_arena, current_arena ());
+
+    /* Another book's load goes back to the first book's arena. */
+    qof_book_begin_bulk_load (other);
+    EXPECT_EQ (other->kvp_arena, current_arena ());
+    EXPECT_NE (book_arena, current_arena ());
+    qof_book_end_bulk_load (other);
+    EXPECT_EQ (book_arena, current_arena ());
+
+    qof_book_end_bulk_load (book);
+    EXPECT_EQ (nullptr, current_arena ());
+
+    /* An unmatched end changes nothing. */
+    kvp_frame_arena_set_current (static_cast<KvpFrameArena*>(other->kvp_arena));
+    qof_book_end_bulk_load (book);
+    EXPECT_EQ (other->kvp_arena, current_arena ());
+    kvp_frame_arena_set_current (nullptr);
+
+    qof_book_destroy (other);
+    qof_book_destroy (book);
+}
@@ -28,6 +28,7 @@
 #include "../qofevent.h"
 #include "../qofevent-p.h"
 #include <gtest/gtest.h>
+#include <vector>
 
 static void
 easy_handler (QofInstance *ent,  QofEventId event_type,
@@ -134,3 +135,81 @@ TEST (qofevent, compound_events)
     qof_event_unregister_handler (id5);
 }
 
+
+static void
+batch_handler (const QofEventChange *changes, guint n_changes,
+               gpointer handler_data)
+{
+    auto received = static_cast<std::vector<QofEventChange>*>(handler_data);
+    received->insert (received->end(), changes, changes + n_changes);
+}
+
+TEST (qofevent, batch_events)
+{
+    QofInstance entity1, entity2;
+    std::vector<QofEventChange> received;
+    int data = 0;
+
+    int id_legacy = qof_event_register_handler (easy_handler, &data);
+    int id_batch = qof_event_register_batch_handler (batch_handler, &received);
+    EXPECT_NE (id_batch, 0);
+    EXPECT_EQ (qof_event_register_batch_handler (NULL, NULL), 0);
+
+    // outside a batch, every event is delivered at once.
+    qof_event_gen (&entity1, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    EXPECT_EQ (data, 1);
+    ASSERT_EQ (received.size(), 1u);
+    EXPECT_EQ (received[0].entity, &entity1);
+    EXPECT_EQ (received[0].event_type, QOF_EVENT_MODIFY);
+    received.clear();
+
+    // in a batch, legacy handlers still see every event, while the
+    // batch handler gets each (entity, event type) once at the end of
+    // the outermost batch.
+    qof_event_begin_batch ();
+    qof_event_gen (&entity1, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    qof_event_begin_batch ();
+    qof_event_gen (&entity2, QOF_EVENT_CREATE, GINT_TO_POINTER(1));
+    qof_event_gen (&entity1, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    qof_event_gen (&entity2, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    qof_event_gen (&entity2, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    qof_event_end_batch ();
+    EXPECT_EQ (data, 6);
+    EXPECT_TRUE (received.empty());
+    qof_event_end_batch ();
+    ASSERT_EQ (received.size(), 3u);
+    EXPECT_EQ (received[0].entity, &entity1);
+    EXPECT_EQ (received[0].event_type, QOF_EVENT_MODIFY);
+    EXPECT_EQ (received[1].entity, &entity2);
+    EXPECT_EQ (received[1].event_type, QOF_EVENT_CREATE);
+    EXPECT_EQ (received[2].entity, &entity2);
+    EXPECT_EQ (received[2].event_type, QOF_EVENT_MODIFY);
+    received.clear();
+
+    // a destroy is delivered at once and drops the entity's earlier changes.
+    qof_event_begin_batch ();
+    qof_event_gen (&entity1, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    qof_event_gen (&entity2, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    qof_event_gen (&entity1, QOF_EVENT_DESTROY, GINT_TO_POINTER(1));
+    ASSERT_EQ (received.size(), 1u);
+    EXPECT_EQ (received[0].entity, &entity1);
+    EXPECT_EQ (received[0].event_type, QOF_EVENT_DESTROY);
+    received.clear();
+    qof_event_end_batch ();
+    ASSERT_EQ (received.size(), 1u);
+    EXPECT_EQ (received[0].entity, &entity2);
+    received.clear();
+
+    // suspended events are dropped for batch handlers too.
+    qof_event_begin_batch ();
+    qof_event_suspend ();
+    qof_event_gen (&entity1, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    qof_event_resume ();
+    qof_event_end_batch ();
+    EXPECT_TRUE (received.empty());
+
+    qof_event_unregister_handler (id_batch);
+    qof_event_gen (&entity1, QOF_EVENT_MODIFY, GINT_TO_POINTER(1));
+    EXPECT_TRUE (received.empty());
+    qof_event_unregister_handler (id_legacy);
+}
@@ -214,3 +214,58 @@ TEST_F(QofQueryCoreTest, numeric_predicate_get_date)
     EXPECT_FALSE (qof_query_date_predicate_get_date(pdata, &date));
     qof_query_core_predicate_free (pdata);
 }
+
+/* The tested "object" is the string itself. */
+static const char*
+object_string (gpointer object, const QofParam*)
+{
+    return static_cast<const char*>(object);
+}
+
+static QofParam string_param {"string", QOF_TYPE_STRING,
+                              (QofAccessFunc)object_string,
+                              nullptr, nullptr, nullptr};
+
+static bool
+string_matches (const char *haystack, QofQueryCompare how, const char *needle,
+                QofStringMatch options)
+{
+    auto pdata = qof_query_string_predicate (how, needle, options, FALSE);
+    auto pred = qof_query_core_get_predicate (QOF_TYPE_STRING);
+    bool match = pred (const_cast<char*>(haystack), &string_param, pdata);
+    qof_query_core_predicate_free (pdata);
+    return match;
+}
+
+TEST_F(QofQueryCoreTest, string_predicate_contains_nocase)
+{
+    auto nocase = QOF_STRING_MATCH_CASEINSENSITIVE;
+    EXPECT_TRUE (string_matches ("Grocery Store", QOF_COMPARE_CONTAINS, "STORE", nocase));
+    EXPECT_TRUE (string_matches ("Grocery Store", QOF_COMPARE_CONTAINS, "gro", nocase));
+    EXPECT_TRUE (string_matches ("Grocery Store", QOF_COMPARE_CONTAINS, "", nocase));
+    EXPECT_TRUE (string_matches ("", QOF_COMPARE_CONTAINS, "", nocase));
+    EXPECT_FALSE (string_matches ("Grocery Store", QOF_COMPARE_CONTAINS, "stores", nocase));
+    EXPECT_FALSE (string_matches ("Sto", QOF_COMPARE_CONTAINS, "store", nocase));
+    EXPECT_TRUE (string_matches ("Grocery Store", QOF_COMPARE_NCONTAINS, "bakery", nocase));
+    EXPECT_FALSE (string_matches ("Grocery Store", QOF_COMPARE_NCONTAINS, "sToRe", nocase));
+    /* Folding can change the length of a string or make it ASCII. */
+    EXPECT_TRUE (string_matches ("Straße", QOF_COMPARE_CONTAINS, "STRASSE", nocase));
+    EXPECT_TRUE (string_matches ("5 km", QOF_COMPARE_CONTAINS, "5 \u212Am", nocase));
+    EXPECT_TRUE (string_matches ("Café Été", QOF_COMPARE_CONTAINS, "CAFÉ É", nocase));
+    EXPECT_FALSE (string_matches ("Cafe", QOF_COMPARE_CONTAINS, "café", nocase));
+    EXPECT_FALSE (string_matches ("Grocery Store", QOF_COMPARE_CONTAINS, "STORE",
+                                  QOF_STRING_MATCH_NORMAL));
+}
+
+TEST_F(QofQueryCoreTest, string_predicate_copy_nocase)
+{
+    auto pdata = qof_query_string_predicate (QOF_COMPARE_CONTAINS, "ÉTÉ",
+                                             QOF_STRING_MATCH_CASEINSENSITIVE,
+                                             FALSE);
+    auto pdata2 = qof_query_core_predicate_copy (pdata);
+    auto pred = qof_query_core_get_predicate (QOF_TYPE_STRING);
+    EXPECT_TRUE (pred (const_cast<char*>("en été"), &string_param, pdata2));
+    EXPECT_TRUE (qof_query_core_predicate_equal (pdata, pdata2));
+    qof_query_core_predicate_free (pdata);
+    qof_query_core_predicate_free (pdata2);
+}
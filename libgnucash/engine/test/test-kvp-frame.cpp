@@ -189,6 +189,121 @@ TEST_F (KvpFrameTest, Empty)
     EXPECT_FALSE(f2.empty());
 }
 
+TEST_F (KvpFrameTest, GetSlotUncachedAndEmptyKeys)
+{
+    EXPECT_EQ (nullptr, t_root.get_slot ({"a key nothing has cached"}));
+    EXPECT_EQ (nullptr, t_root.get_slot ({"top", "a key nothing has cached"}));
+    EXPECT_EQ (nullptr, t_root.get_slot ({}));
+    auto v1 = new KvpValueImpl {15.0};
+    EXPECT_EQ (nullptr, t_root.set_path ({"top", ""}, v1));
+    EXPECT_EQ (v1, t_root.get_slot ({"top", ""}));
+    EXPECT_EQ (t_int_val, t_root.get_slot ({"top", "first"}));
+}
+
+static std::string
+numbered_key (int i)
+{
+    return "key-" + std::to_string ((i * 37) % 101);
+}
+
+TEST_F (KvpFrameTest, KeySlotAndPath)
+{
+    static const KvpKey top {"top"};
+    static const KvpKey first {"first"};
+    static const KvpKey fresh {"a key nothing else uses"};
+    EXPECT_EQ (t_int_val, t_root.get_key_slot ({top, first}));
+    EXPECT_EQ (t_str_val, t_root.get_key_slot ({top, "third"}));
+    EXPECT_EQ (nullptr, t_root.get_key_slot ({top, fresh}));
+    EXPECT_EQ (nullptr, t_root.get_key_slot ({top, first, first}));
+
+    auto v1 = new KvpValueImpl {15.0};
+    EXPECT_EQ (nullptr, t_root.set_key_path ({fresh, top, "leaf"}, v1));
+    EXPECT_EQ (v1, t_root.get_slot ({"a key nothing else uses", "top", "leaf"}));
+    EXPECT_EQ (v1, t_root.get_key_slot ({fresh, top, "leaf"}));
+
+    /* A frame that has moved its slots into the map. */
+    auto f1 = t_root.get_key_slot ({fresh, top})->get<KvpFrame*> ();
+    for (int i = 0; i < 101; ++i)
+        f1->set ({numbered_key (i)}, new KvpValue {int64_t{i}});
+    auto v2 = new KvpValueImpl {INT64_C(52)};
+    EXPECT_EQ (nullptr, t_root.set_key_path ({fresh, top, first}, v2));
+    EXPECT_EQ (v2, t_root.get_key_slot ({fresh, top, first}));
+    EXPECT_EQ (v1, t_root.get_key_slot ({fresh, top, "leaf"}));
+    EXPECT_EQ (v2, t_root.set_key_path ({fresh, top, first}, nullptr));
+    delete v2;
+    EXPECT_EQ (nullptr, t_root.get_key_slot ({fresh, top, first}));
+}
+
+/* Fill a frame past KvpFrameImpl::max_flat_size so that its slots move from
+ * the sorted vector into the map, checking that nothing gets lost on the way.
+ */
+TEST_F (KvpFrameTest, GrowPastFlatSize)
+{
+    KvpFrameImpl f1;
+    const int count = 101;
+    static_assert (static_cast<size_t>(count) > KvpFrameImpl::max_flat_size, "frame must outgrow the flat slots");
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_EQ (nullptr, f1.set ({numbered_key (i)}, new KvpValue {int64_t{i}}));
+        EXPECT_EQ (static_cast<size_t>(i + 1), f1.size ());
+        for (int j = 0; j <= i; ++j)
+            EXPECT_EQ (j, f1.get_slot ({numbered_key (j)})->get<int64_t> ());
+    }
+    auto keys = f1.get_keys ();
+    EXPECT_EQ (static_cast<size_t>(count), keys.size ());
+    EXPECT_TRUE (std::is_sorted (keys.begin (), keys.end ()));
+
+    auto old = f1.set ({numbered_key (5)}, new KvpValue {INT64_C(500)});
+    EXPECT_EQ (5, old->get<int64_t> ());
+    delete old;
+    EXPECT_EQ (500, f1.get_slot ({numbered_key (5)})->get<int64_t> ());
+
+    for (int i = 0; i < count; i += 2)
+        delete f1.set ({numbered_key (i)}, nullptr);
+    EXPECT_EQ (static_cast<size_t>(count / 2), f1.size ());
+    EXPECT_EQ (nullptr, f1.get_slot ({numbered_key (0)}));
+    EXPECT_EQ (1, f1.get_slot ({numbered_key (1)})->get<int64_t> ());
+}
+
+TEST_F (KvpFrameTest, CopyAndCompare)
+{
+    for (int count : {3, 101})
+    {
+        KvpFrameImpl f1;
+        for (int i = 0; i < count; ++i)
+            f1.set ({numbered_key (i)}, new KvpValue {int64_t{i}});
+        f1.set_path ({"nested", "frame"}, new KvpValue {g_strdup ("a value")});
+        KvpFrameImpl f2 {f1};
+        EXPECT_EQ (0, compare (f1, f2));
+        EXPECT_EQ (f1.to_string (), f2.to_string ());
+        EXPECT_EQ (f1.flatten_kvp ().size (), f2.flatten_kvp ().size ());
+        delete f2.set ({numbered_key (1)}, new KvpValue {INT64_C(-1)});
+        EXPECT_NE (0, compare (f1, f2));
+        delete f2.set ({numbered_key (1)}, nullptr);
+        EXPECT_EQ (1, compare (f1, f2));
+        EXPECT_EQ (-1, compare (f2, f1));
+    }
+}
+
+TEST (KvpFrameTestForEachPrefix, for_each_prefix_large)
+{
+    KvpFrame fr;
+    for (int i = 0; i < 101; ++i)
+        fr.set ({numbered_key (i)}, new KvpValue {int64_t{i}});
+    fr.set ({"kez"}, new KvpValue {15.0});
+    unsigned count {};
+    auto counter = [] (char const *, KvpValue*, unsigned & count) { ++count; };
+    fr.for_each_slot_prefix ("key-1", counter, count);
+    /* key-1, key-10 ... key-19 and key-100 */
+    EXPECT_EQ (count, UINT32_C(12));
+    count = 0;
+    fr.for_each_slot_prefix ("key-", counter, count);
+    EXPECT_EQ (count, UINT32_C(101));
+    count = 0;
+    fr.for_each_slot_prefix ("kez", counter, count);
+    EXPECT_EQ (count, UINT32_C(1));
+}
+
 TEST (KvpFrameTestForEachPrefix, for_each_prefix_1)
 {
     KvpFrame fr;
@@ -226,3 +341,62 @@ TEST (KvpFrameTestForEachPrefix, for_each_prefix_2)
             EXPECT_EQ(value->get_type(), KvpValue::Type::INT64);
         }, count);
 }
+
+TEST (KvpFrameArena, AllocateFromArena)
+{
+    auto arena = kvp_frame_arena_new ();
+    size_t allocated, live, bytes;
+    kvp_frame_arena_get_stats (arena, allocated, live, bytes);
+    EXPECT_EQ (0u, allocated);
+    EXPECT_EQ (0u, bytes);
+
+    EXPECT_EQ (nullptr, kvp_frame_arena_set_current (arena));
+    std::vector<KvpFrame*> frames;
+    for (int i = 0; i < 2000; ++i)
+    {
+        frames.push_back (new KvpFrame);
+        frames.back ()->set ({"value"}, new KvpValue {int64_t{i}});
+    }
+    EXPECT_EQ (arena, kvp_frame_arena_set_current (nullptr));
+    auto outside = new KvpFrame;
+
+    kvp_frame_arena_get_stats (arena, allocated, live, bytes);
+    EXPECT_EQ (2000u, allocated);
+    EXPECT_EQ (2000u, live);
+    EXPECT_GE (bytes, 2000 * sizeof (KvpFrame));
+    kvp_frame_arena_get_value_stats (arena, allocated, live, bytes);
+    EXPECT_EQ (2000u, allocated);
+    EXPECT_EQ (2000u, live);
+    EXPECT_GE (bytes, 2000 * sizeof (KvpValue));
+
+    for (int i = 0; i < 2000; i += 2)
+        delete frames[i];
+    kvp_frame_arena_get_value_stats (arena, allocated, live, bytes);
+    EXPECT_EQ (1000u, live);
+    kvp_frame_arena_get_stats (arena, allocated, live, bytes);
+    EXPECT_EQ (1000u, live);
+
+    /* Freed frames are reused before the arena grows. */
+    auto old_bytes = bytes;
+    kvp_frame_arena_set_current (arena);
+    for (int i = 0; i < 2000; i += 2)
+        frames[i] = new KvpFrame;
+    kvp_frame_arena_set_current (nullptr);
+    kvp_frame_arena_get_stats (arena, allocated, live, bytes);
+    EXPECT_EQ (3000u, allocated);
+    EXPECT_EQ (2000u, live);
+    EXPECT_EQ (old_bytes, bytes);
+    EXPECT_EQ (1, frames[1]->get_slot ({"value"})->get<int64_t> ());
+
+    /* A value made outside the arena can be set in a frame from it. */
+    frames[0]->set ({"outside"}, new KvpValue {int64_t{7}});
+    kvp_frame_arena_get_value_stats (arena, allocated, live, bytes);
+    EXPECT_EQ (2000u, allocated);
+    EXPECT_EQ (1000u, live);
+
+    /* The frames and values outlive their owner's reference to the arena. */
+    kvp_frame_arena_release (arena);
+    for (auto frame : frames)
+        delete frame;
+    delete outside;
+}
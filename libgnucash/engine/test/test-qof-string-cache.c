@@ -77,8 +77,27 @@ test_qof_string_cache( void )
     g_assert_true(str1_1 != str1_4);
 }
 
+static void
+test_qof_string_cache_lookup( void )
+{
+    /* Looking a string up finds the cached copy without holding on to it. */
+    gchar str[100];
+    const gchar* str3;
+
+    strncpy(str, "str3", sizeof(str));
+    g_assert_null(qof_string_cache_lookup(str));
+    str3 = qof_string_cache_insert(str);        /* Refcount = 1 */
+    g_assert_true(qof_string_cache_lookup(str) == str3);
+    g_assert_true(qof_string_cache_lookup(str) == str3);
+    qof_string_cache_remove(str3);              /* Refcount = 0 */
+    g_assert_null(qof_string_cache_lookup(str));
+    g_assert_cmpstr(qof_string_cache_lookup(""), ==, "");
+    g_assert_null(qof_string_cache_lookup(NULL));
+}
+
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache lookup", test_qof_string_cache_lookup);
 }
@@ -26,11 +26,16 @@
 #include "qof.h"
 #include "cashobjects.h"
 #include "Transaction.h"
+#include "Account.hpp"
+#include "Query.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
 #include "test-engine-stuff.h"
 #include "test-stuff.h"
 
+#include <algorithm>
+#include <vector>
+
 static int
 test_trans_query (Transaction *trans, gpointer data)
 {
@@ -64,6 +69,299 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+struct SplitFilter
+{
+    std::vector<Account*> accounts;
+    time64 start;
+    time64 end;
+    std::vector<Split*> matches;
+};
+
+static void
+filter_split (QofInstance *inst, gpointer data)
+{
+    auto filter = static_cast<SplitFilter*>(data);
+    auto split = GNC_SPLIT (inst);
+    auto date = xaccTransGetDate (xaccSplitGetParent (split));
+    auto& accounts = filter->accounts;
+
+    if (date >= filter->start && date <= filter->end &&
+        std::find (accounts.begin(), accounts.end(),
+                   xaccSplitGetAccount (split)) != accounts.end())
+        filter->matches.push_back (split);
+}
+
+/* Check that a query for the splits in some accounts within a date range,
+ * which runs off the accounts' split lists, finds the same splits as
+ * testing every split in the book. */
+static void
+test_account_date_query (QofBook *book, SplitFilter& filter)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    for (auto acc : filter.accounts)
+    {
+        QofQuery *acc_q = qof_query_create_for (GNC_ID_SPLIT);
+        xaccQueryAddSingleAccountMatch (acc_q, acc, QOF_QUERY_AND);
+        xaccQueryAddDateMatchTT (acc_q, TRUE, filter.start, TRUE, filter.end,
+                                 QOF_QUERY_AND);
+        qof_query_merge_in_place (q, acc_q, QOF_QUERY_OR);
+        qof_query_destroy (acc_q);
+    }
+
+    std::vector<Split*> found;
+    for (GList *node = qof_query_run (q); node; node = node->next)
+        found.push_back (GNC_SPLIT (node->data));
+    qof_query_destroy (q);
+
+    filter.matches.clear ();
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            filter_split, &filter);
+
+    std::sort (found.begin(), found.end());
+    std::sort (filter.matches.begin(), filter.matches.end());
+    if (found != filter.matches)
+    {
+        failure_args ("account and date query", __FILE__, __LINE__,
+                      "query found %zu splits, %zu match",
+                      found.size(), filter.matches.size());
+        return;
+    }
+    success ("account and date query found the right splits");
+}
+
+static void
+test_account_date_queries (QofBook *book)
+{
+    GList *accounts = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    std::vector<time64> dates;
+    for (GList *node = accounts; node; node = node->next)
+        for (auto split : xaccAccountGetSplits (GNC_ACCOUNT (node->data)))
+            dates.push_back (xaccTransGetDate (xaccSplitGetParent (split)));
+    std::sort (dates.begin(), dates.end());
+
+    for (GList *node = accounts; node; node = node->next)
+    {
+        SplitFilter filter;
+        filter.accounts.push_back (GNC_ACCOUNT (node->data));
+        if (node->next)
+            filter.accounts.push_back (GNC_ACCOUNT (node->next->data));
+        filter.start = dates.empty() ? 0 : dates[rand() % dates.size()];
+        filter.end = dates.empty() ? 0 : dates[rand() % dates.size()];
+        if (filter.start > filter.end)
+            std::swap (filter.start, filter.end);
+        test_account_date_query (book, filter);
+    }
+    g_list_free (accounts);
+}
+
+/* Check that a query finds a split that moved into an account and date
+ * range in a transaction that is still open, before the account's split
+ * list knows about it. */
+static void
+test_open_transaction_query (QofBook *book)
+{
+    GList *accounts = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    Split *split = NULL;
+    Account *acc = NULL;
+    for (GList *node = accounts; node && node->next && !split; node = node->next)
+    {
+        auto splits = xaccAccountGetSplits (GNC_ACCOUNT (node->next->data));
+        if (!splits.empty ())
+        {
+            acc = GNC_ACCOUNT (node->data);
+            split = splits.front ();
+        }
+    }
+    g_list_free (accounts);
+    if (!split)
+        return;
+
+    Transaction *trans = xaccSplitGetParent (split);
+    SplitFilter filter;
+    filter.accounts.push_back (acc);
+    filter.start = 1000000000;
+    filter.end = filter.start + 86400;
+
+    xaccTransBeginEdit (trans);
+    xaccSplitSetAccount (split, acc);
+    xaccTransSetDatePostedSecs (trans, filter.start + 3600);
+    test_account_date_query (book, filter);
+    if (std::find (filter.matches.begin(), filter.matches.end(), split) ==
+        filter.matches.end())
+        failure ("the moved split doesn't match the query");
+    xaccTransRollbackEdit (trans);
+}
+
+static gboolean
+results_sorted (GList *results)
+{
+    for (GList *node = results; node && node->next; node = node->next)
+        if (xaccSplitOrder (GNC_SPLIT (node->data), GNC_SPLIT (node->next->data)) > 0)
+            return FALSE;
+    return TRUE;
+}
+
+/* Check that updating a query's results for the splits that changed gives
+ * the same splits, in order, as running it again. */
+static void
+test_update_results (QofBook *book)
+{
+    GList *accounts = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    if (!accounts || !accounts->next)
+    {
+        g_list_free (accounts);
+        return;
+    }
+    Account *acc = GNC_ACCOUNT (accounts->data);
+    Account *other = GNC_ACCOUNT (accounts->next->data);
+    g_list_free (accounts);
+
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+    qof_query_run (q);
+
+    /* Move some splits into the account and some transactions to other
+     * dates. */
+    GList *changed = NULL;
+    int i = 0;
+    for (auto split : xaccAccountGetSplits (other))
+    {
+        if (i++ % 2)
+            continue;
+        xaccSplitSetAccount (split, acc);
+        changed = g_list_prepend (changed, split);
+    }
+    for (auto split : xaccAccountGetSplits (acc))
+    {
+        if (i++ % 3)
+            continue;
+        Transaction *trans = xaccSplitGetParent (split);
+        xaccTransBeginEdit (trans);
+        xaccTransSetDatePostedSecs (trans, xaccTransGetDate (trans) + (rand() % 200 - 100) * 86400);
+        xaccTransCommitEdit (trans);
+        for (GList *node = xaccTransGetSplitList (trans); node; node = node->next)
+            changed = g_list_prepend (changed, node->data);
+    }
+
+    if (!qof_query_update_results (q, changed))
+    {
+        failure ("query results weren't updated");
+    }
+    else
+    {
+        std::vector<gpointer> updated, rerun;
+        for (GList *node = qof_query_last_run (q); node; node = node->next)
+            updated.push_back (node->data);
+        QofQuery *q2 = qof_query_copy (q);
+        GList *results = qof_query_run (q2);
+        for (GList *node = results; node; node = node->next)
+            rerun.push_back (node->data);
+        gboolean sorted = results_sorted (qof_query_last_run (q));
+        qof_query_destroy (q2);
+
+        std::sort (updated.begin(), updated.end());
+        std::sort (rerun.begin(), rerun.end());
+        if (updated != rerun || !sorted)
+            failure_args ("query results update", __FILE__, __LINE__,
+                          "updated results have %zu splits%s, running the "
+                          "query finds %zu", updated.size(),
+                          sorted ? "" : " out of order", rerun.size());
+        else
+            success ("updated query results match running the query");
+    }
+    g_list_free (changed);
+    qof_query_destroy (q);
+}
+
+static std::vector<gpointer>
+sorted_results (QofQuery *q)
+{
+    std::vector<gpointer> results;
+    for (GList *node = qof_query_run (q); node; node = node->next)
+        results.push_back (node->data);
+    std::sort (results.begin(), results.end());
+    return results;
+}
+
+static void
+collect_instance (QofInstance *inst, gpointer data)
+{
+    static_cast<std::vector<gpointer>*>(data)->push_back (inst);
+}
+
+static void
+filter_plan_split (QofInstance *inst, gpointer data)
+{
+    auto matches = static_cast<std::vector<gpointer>*>(data);
+    auto split = GNC_SPLIT (inst);
+
+    if (gnc_numeric_positive_p (xaccSplitGetValue (split)) &&
+        qof_utf8_substr_nocase (xaccSplitGetMemo (split), "e"))
+        matches->push_back (split);
+}
+
+/* Check that a term whose parameter doesn't resolve is left out of the
+ * query's plan rather than rejecting objects, and that reordering the
+ * plan's terms as the query runs doesn't change what it finds. */
+static void
+test_query_plan (void)
+{
+    QofSession *session = get_random_session ();
+    QofBook *book = qof_session_get_book (session);
+    QofCollection *splits = qof_book_get_collection (book, GNC_ID_SPLIT);
+
+    /* The terms are reordered every 256 objects. */
+    while (qof_collection_count (splits) < 4 * 256)
+        add_random_transactions_to_book (book, 20);
+
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    qof_query_add_term (q, qof_query_build_param_list ("no-such-param", NULL),
+                        qof_query_string_predicate (QOF_COMPARE_EQUAL, "x",
+                                                    QOF_STRING_MATCH_NORMAL,
+                                                    FALSE),
+                        QOF_QUERY_AND);
+
+    std::vector<gpointer> all;
+    qof_collection_foreach (splits, collect_instance, &all);
+    std::sort (all.begin(), all.end());
+    if (sorted_results (q) != all)
+        failure ("a term that doesn't resolve rejected objects");
+    else
+        success ("a term that doesn't resolve is left out of the plan");
+
+    /* The value term is cheap but rarely rejects, the memo term is
+     * dearer but rejects most splits, so the plan swaps them. */
+    qof_query_add_term (q, qof_query_build_param_list (SPLIT_VALUE, NULL),
+                        qof_query_numeric_predicate (QOF_COMPARE_GT,
+                                                     QOF_NUMERIC_MATCH_ANY,
+                                                     gnc_numeric_zero ()),
+                        QOF_QUERY_AND);
+    qof_query_add_term (q, qof_query_build_param_list (SPLIT_MEMO, NULL),
+                        qof_query_string_predicate (QOF_COMPARE_CONTAINS, "e",
+                                                    QOF_STRING_MATCH_CASEINSENSITIVE,
+                                                    FALSE),
+                        QOF_QUERY_AND);
+
+    std::vector<gpointer> expected;
+    qof_collection_foreach (splits, filter_plan_split, &expected);
+    std::sort (expected.begin(), expected.end());
+
+    auto first = sorted_results (q);
+    auto second = sorted_results (q);
+    if (first != expected || second != expected)
+        failure_args ("query plan", __FILE__, __LINE__,
+                      "runs found %zu and %zu splits, %zu match",
+                      first.size(), second.size(), expected.size());
+    else
+        success ("reordering the plan's terms keeps the results");
+
+    qof_query_destroy (q);
+    qof_session_destroy (session);
+}
+
 static void
 run_test (void)
 {
@@ -78,6 +376,9 @@ run_test (void)
     add_random_transactions_to_book (book, 20);
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
+    test_account_date_queries (book);
+    test_open_transaction_query (book);
+    test_update_results (book);
 
     qof_session_destroy (session);
 }
@@ -105,6 +406,7 @@ main (int argc, char **argv)
     {
         run_test ();
     }
+    test_query_plan ();
     success("queries seem to work");
 
 cleanup:
@@ -19,6 +19,7 @@
  * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
  * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
  ********************************************************************/
+#include <algorithm>
 #include <cstddef>
 #include <glib.h>
 
@@ -30,8 +31,10 @@
 /* Add specific headers for this class */
 #include "gnc-glib-utils.h"
 #include "../Account.h"
+#include "../Account.hpp"
 #include "../AccountP.hpp"
 #include "../Split.h"
+#include "../SplitP.hpp"
 #include "../Transaction.h"
 #include "../gnc-lot.h"
 
@@ -1483,9 +1486,74 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 /* xaccAccountSortSplits
 void
 xaccAccountSortSplits (Account *acc, gboolean force)// C: 4 in 2
-Make static?
-Passthrough, no test.
 */
+static Split*
+dated_split (Account *acct, time64 date)
+{
+    auto book = gnc_account_get_book (acct);
+    auto txn = xaccMallocTransaction (book);
+    auto split = xaccMallocSplit (book);
+    xaccTransBeginEdit (txn);
+    xaccTransSetDatePostedSecs (txn, date);
+    xaccSplitSetParent (split, txn);
+    xaccSplitSetAccount (split, acct);
+    return split;
+}
+
+static void
+check_splits_sorted (AccountPrivate *priv)
+{
+    const auto& splits = priv->splits;
+    for (size_t i = 1; i < splits.size (); ++i)
+        g_assert_cmpint (xaccSplitOrder (splits[i - 1], splits[i]), <, 0);
+}
+
+static void
+test_xaccAccountSortSplits (Fixture *fixture, gconstpointer pData)
+{
+    auto acct = fixture->acct;
+    AccountPrivate *priv = fixture->func->get_private (acct);
+    const time64 base = 1500000000;
+    /* Dates out of order and with repeats, so that some splits are only
+     * told apart by the rest of xaccSplitOrder. */
+    for (int i = 0; i < 40; ++i)
+    {
+        g_assert_true (gnc_account_insert_split (acct, dated_split (acct, base + (i * 7919) % 13 * 86400)));
+        g_assert_true (!priv->sort_dirty);
+    }
+    check_splits_sorted (priv);
+
+    gnc_account_set_defer_sort (acct, TRUE);
+    for (int i = 0; i < 20; ++i)
+        g_assert_true (gnc_account_insert_split (acct, dated_split (acct, base + (i * 104729) % 17 * 86400)));
+    g_assert_cmpuint (priv->splits.size (), ==, 60);
+    g_assert_true (priv->sort_dirty);
+    priv->balance_dirty = TRUE;
+    xaccAccountRecomputeBalance (acct);
+    g_assert_true (priv->balance_dirty);
+
+    /* Readers can't bisect the splits while they're unsorted. */
+    auto until = base + 8 * 86400;
+    auto expected = std::count_if (priv->splits.begin (), priv->splits.end (),
+                                   [until](Split *s)
+                                   { return xaccTransGetDate (xaccSplitGetParent (s)) <= until; });
+    int count = 0;
+    gnc_account_foreach_split_until_date (acct, until, [&count](Split*) { ++count; });
+    g_assert_cmpint (count, ==, expected);
+    gnc_account_set_defer_sort (acct, FALSE);
+    g_assert_true (!priv->sort_dirty);
+    check_splits_sorted (priv);
+
+    /* Move the first split's transaction after all of the others. */
+    auto first = priv->splits.front ();
+    xaccTransSetDatePostedSecs (xaccSplitGetParent (first), base + 20 * 86400);
+    gnc_account_set_sort_dirty (acct);
+    xaccAccountSortSplits (acct, TRUE);
+    g_assert_true (priv->splits.back () == first);
+    check_splits_sorted (priv);
+    xaccAccountRecomputeBalance (acct);
+    g_assert_true (!priv->balance_dirty);
+}
 /* xaccAccountBringUpToDate
 static void
 xaccAccountBringUpToDate (Account *acc)// 3
@@ -1630,6 +1698,95 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     g_assert_true (!priv->balance_dirty);
 }
 
+/* Changing a split must recompute only the running balances from it on; the
+ * first split's balance is scribbled on to show that it isn't touched, so the
+ * cost is proportional to the length of the changed suffix. */
+static void
+test_xaccAccountRecomputeBalance_incremental (Fixture *fixture, gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    auto one = gnc_numeric_create (1, 1);
+    auto scribble = gnc_numeric_create (424242, 100);
+
+    priv->balance_dirty = TRUE;
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert_cmpint (priv->splits.size (), >, 1);
+    auto bal = priv->balance;
+    auto first = priv->splits.front ();
+    auto last = priv->splits.back ();
+    first->balance = scribble;
+
+    auto txn = xaccSplitGetParent (last);
+    xaccTransBeginEdit (txn);
+    xaccSplitSetAmount (last, gnc_numeric_add_fixed (xaccSplitGetAmount (last), one));
+    qof_commit_edit (QOF_INSTANCE (txn));
+    g_assert_true (priv->balance_dirty);
+    g_assert_cmpint (priv->balance_dirty_from, ==, priv->splits.size () - 1);
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert_true (!priv->balance_dirty);
+    g_assert_true (gnc_numeric_equal (priv->balance, gnc_numeric_add_fixed (bal, one)));
+    g_assert_true (gnc_numeric_equal (xaccSplitGetBalance (last), priv->balance));
+    g_assert_true (gnc_numeric_equal (first->balance, scribble));
+
+    /* A change that isn't tied to a split recomputes everything. */
+    gnc_account_set_start_balance (fixture->acct, gnc_numeric_zero ());
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert_true (gnc_numeric_equal (first->balance, xaccSplitGetAmount (first)));
+}
+
+static void
+check_split_records (AccountPrivate *priv)
+{
+    g_assert_cmpint (priv->split_records.size (), ==, priv->splits.size ());
+    for (size_t i = 0; i < priv->splits.size (); ++i)
+    {
+        auto split = priv->splits[i];
+        const auto& rec = priv->split_records[i];
+        g_assert_cmpint (rec.date_posted, ==,
+                         xaccTransGetDate (xaccSplitGetParent (split)));
+        g_assert_true (gnc_numeric_equal (rec.amount, xaccSplitGetAmount (split)));
+        g_assert_true (gnc_numeric_equal (rec.value, xaccSplitGetValue (split)));
+        g_assert_true (gnc_numeric_equal (rec.balance, xaccSplitGetBalance (split)));
+        g_assert_true (gnc_numeric_equal (rec.cleared_balance,
+                                          xaccSplitGetClearedBalance (split)));
+        g_assert_true (gnc_numeric_equal (rec.reconciled_balance,
+                                          xaccSplitGetReconciledBalance (split)));
+        g_assert_cmpint (rec.reconciled, ==, xaccSplitGetReconcile (split));
+    }
+}
+
+/* The split records follow the splits through recomputation, and the scans
+ * that read them agree with the splits themselves. */
+static void
+test_xaccAccountRecomputeBalance_split_records (Fixture *fixture, gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    auto one = gnc_numeric_create (1, 1);
+
+    priv->balance_dirty = TRUE;
+    xaccAccountRecomputeBalance (fixture->acct);
+    check_split_records (priv);
+
+    auto last = priv->splits.back ();
+    auto txn = xaccSplitGetParent (last);
+    xaccTransBeginEdit (txn);
+    xaccSplitSetAmount (last, gnc_numeric_add_fixed (xaccSplitGetAmount (last), one));
+    xaccSplitSetReconcile (last, CREC);
+    qof_commit_edit (QOF_INSTANCE (txn));
+    xaccAccountRecomputeBalance (fixture->acct);
+    check_split_records (priv);
+
+    auto first_date = priv->split_records.front ().date_posted;
+    auto last_date = priv->split_records.back ().date_posted;
+    g_assert_true (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (fixture->acct, last_date + 1),
+                                      xaccAccountGetBalance (fixture->acct)));
+    g_assert_true (gnc_numeric_zero_p (xaccAccountGetBalanceAsOfDate (fixture->acct, first_date)));
+    size_t count = 0;
+    gnc_account_foreach_split_until_date (fixture->acct, last_date,
+                                          [&count](Split*) { ++count; });
+    g_assert_cmpint (count, ==, priv->splits.size ());
+}
+
 /* xaccAccountOrder
 int
 xaccAccountOrder (const Account *aa, const Account *ab)// C: 11 in 3 */
@@ -2256,6 +2413,11 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
                                          (gnc_time (NULL) - offset));
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
+    /* Before the first split and after the last one */
+    val = xaccAccountGetBalanceAsOfDate (fixture->acct, 0);
+    g_assert_true (gnc_numeric_zero_p (val));
+    val = xaccAccountGetBalanceAsOfDate (fixture->acct, G_MAXINT64);
+    g_assert_true (gnc_numeric_equal (val, xaccAccountGetBalance (fixture->acct)));
 }
 /* xaccAccountGetPresentBalance
 gnc_numeric
@@ -2864,8 +3026,11 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account kvp getters & setters", Fixture, NULL, setup, test_gnc_account_kvp_setters_getters,  teardown );
     GNC_TEST_ADD (suitename, "test_gnc_account_get_map_entry", Fixture, NULL, setup, test_gnc_account_get_map_entry,  teardown );
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountSortSplits", Fixture, NULL, setup, test_xaccAccountSortSplits,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance incremental", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance_incremental,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance split records", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance_split_records,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
     GNC_TEST_ADD (suitename, "qofAccountSetParent", Fixture, &some_data, setup, test_qofAccountSetParent,  teardown );
     GNC_TEST_ADD (suitename, "gnc account append/remove child", Fixture, NULL, setup, test_gnc_account_append_remove_child,  teardown );
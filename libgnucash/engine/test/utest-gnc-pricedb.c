@@ -1214,6 +1214,43 @@ test_gnc_pricedb_lookup_nearest_before_t64 (PriceDBFixture *fixture, gconstpoint
     g_assert_cmpstr(GET_CUR_NAME(price), ==, "USD");
 
 }
+
+/* The lookups binary search a time-sorted series that must track removals
+ * and date changes. */
+static void
+test_gnc_pricedb_lookup_after_edit (PriceDBFixture *fixture, gconstpointer pData)
+{
+    time64 t1 = gnc_dmy2time64(16, 11, 2012);
+    time64 t2 = gnc_dmy2time64(17, 11, 2012);
+    time64 t3 = gnc_dmy2time64(18, 11, 2012);
+    gnc_numeric result;
+    GNCPrice *price =
+        gnc_pricedb_lookup_nearest_before_t64(fixture->pricedb,
+                                             fixture->com->usd,
+                                             fixture->com->aud, t2);
+    g_assert_cmpint(gnc_price_get_value (price).num, ==, 103415);
+    gnc_pricedb_remove_price (fixture->pricedb, price);
+    gnc_price_unref (price);
+
+    price = gnc_pricedb_lookup_nearest_before_t64(fixture->pricedb,
+                                                 fixture->com->usd,
+                                                 fixture->com->aud, t2);
+    result = gnc_price_get_value (price);
+    g_assert_cmpint(result.num, ==, 106480);
+    g_assert_cmpint(result.denom, ==, 100000);
+
+    gnc_price_set_time64 (price, t3);
+    gnc_price_unref (price);
+    price = gnc_pricedb_lookup_nearest_in_time64(fixture->pricedb,
+                                                fixture->com->usd,
+                                                fixture->com->aud, t3);
+    g_assert_cmpint(gnc_price_get_value (price).num, ==, 106480);
+    g_assert_cmpint(gnc_price_get_time64 (price), ==, t3);
+    gnc_price_unref (price);
+    price = gnc_pricedb_lookup_day_t64(fixture->pricedb, fixture->com->usd,
+                                       fixture->com->aud, t1);
+    g_assert (price == NULL);
+}
 /* direct_balance_conversion
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,// Local: 2:0:0
@@ -1769,6 +1806,7 @@ GNC_TEST_ADD (suitename, "gnc price list equal", PriceDBFixture, NULL, setup, te
 // GNC_TEST_ADD (suitename, "lookup nearest in time", Fixture, NULL, setup, test_lookup_nearest_in_time, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_in_time64, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest before in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_before_t64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup after edit", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_after_edit, teardown);
 // GNC_TEST_ADD (suitename, "direct balance conversion", Fixture, NULL, setup, test_direct_balance_conversion, teardown);
 // GNC_TEST_ADD (suitename, "extract common prices", Fixture, NULL, setup, test_extract_common_prices, teardown);
 // GNC_TEST_ADD (suitename, "convert balance", Fixture, NULL, setup, test_convert_balance, teardown);